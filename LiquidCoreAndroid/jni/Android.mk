@@ -59,7 +59,9 @@ LOCAL_SRC_FILES := common.cpp \
                    node/NodeInstance.cpp \
                    node/nodedroid_file.cc \
                    node/process_wrap.cc \
+                   ../../deps/node-sqlite3/src/blob.cc \
                    ../../deps/node-sqlite3/src/database.cc \
+                   ../../deps/node-sqlite3/src/kv.cc \
                    ../../deps/node-sqlite3/src/node_sqlite3.cc \
                    ../../deps/node-sqlite3/src/statement.cc \
                    JSC/JSC_JSValue.cpp \
@@ -84,6 +84,62 @@ NATIVE(JSContextGroup,jlong,create) (PARAMS) {
     return reinterpret_cast<long>(group);
 }
 
+NATIVE(JSContextGroup,jlong,createWithHeapLimit) (PARAMS, jint maxHeapMB) {
+    ContextGroup *group = new ContextGroup((size_t) maxHeapMB);
+    return reinterpret_cast<long>(group);
+}
+
+NATIVE(JSContextGroup,jdoubleArray,getGCStatistics) (PARAMS, jlong grp) {
+    ContextGroup *group = reinterpret_cast<ContextGroup*>(grp);
+    ContextGroup::GCStatistics stats = group->GetGCStatistics();
+
+    // Same order as the fields of JSContextGroup.GCStatistics
+    jdouble values[] = {
+        (jdouble) stats.scavenges,
+        (jdouble) stats.mark_sweeps,
+        stats.total_pause_ms,
+        stats.max_pause_ms,
+        (jdouble) stats.idle_notifications,
+        stats.idle_time_ms,
+        (jdouble) stats.used_heap_size,
+        (jdouble) stats.total_heap_size,
+        (jdouble) stats.heap_size_limit
+    };
+    jdoubleArray out = env->NewDoubleArray(sizeof values / sizeof values[0]);
+    env->SetDoubleArrayRegion(out, 0, sizeof values / sizeof values[0], values);
+    return out;
+}
+
+NATIVE(JSContextGroup,jlongArray,getAllocatorStatistics) (PARAMS, jlong grp) {
+    ContextGroup *group = reinterpret_cast<ContextGroup*>(grp);
+    ContextGroup::AllocatorStatistics stats = group->GetAllocatorStatistics();
+
+    // Same order as the fields of JSContextGroup.AllocatorStatistics
+    jlong values[] = {
+        (jlong) stats.allocations,
+        (jlong) stats.pool_hits,
+        (jlong) stats.recycled,
+        (jlong) stats.freed,
+        (jlong) stats.pool_committed_bytes,
+        (jlong) stats.pool_free_bytes
+    };
+    jlongArray out = env->NewLongArray(sizeof values / sizeof values[0]);
+    env->SetLongArrayRegion(out, 0, sizeof values / sizeof values[0], values);
+    return out;
+}
+
+NATIVE(JSContextGroup,jlongArray,notifyMemoryPressureNative) (PARAMS, jint level, jint timeoutMs) {
+    MemoryPressureLevel pressure =
+        level >= 2 ? MemoryPressureLevel::kCritical :
+        level == 1 ? MemoryPressureLevel::kModerate : MemoryPressureLevel::kNone;
+    std::vector<ssize_t> reclaimed = ContextGroup::NotifyMemoryPressure(pressure, timeoutMs);
+
+    std::vector<jlong> values(reclaimed.begin(), reclaimed.end());
+    jlongArray out = env->NewLongArray((jsize) values.size());
+    env->SetLongArrayRegion(out, 0, (jsize) values.size(), values.data());
+    return out;
+}
+
 NATIVE(JSContextGroup,void,release) (PARAMS,jlong group) {
     ContextGroup *isolate = (ContextGroup*) group;
 #ifdef DEBUG_RETAINER
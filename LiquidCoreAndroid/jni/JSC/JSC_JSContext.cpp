@@ -94,8 +94,9 @@ void OpaqueJSContext::GCCallback(GCType type, GCCallbackFlags flags)
 void OpaqueJSContext::ForceGC()
 {
     V8_ISOLATE(Context()->Group(), isolate)
-        while(!isolate->IdleNotificationDeadline(
-            group_->Platform()->MonotonicallyIncreasingTime() + 1.0)) {};
+        // Full, blocking collections until nothing more can be freed.  Spinning on idle
+        // notifications instead can take a long time on a busy heap.
+        isolate->LowMemoryNotification();
     V8_UNLOCK()
 }
 
@@ -38,6 +38,7 @@
 #include <android/log.h>
 #include <exception>
 #include <condition_variable>
+#include <sys/mman.h>
 
 /**
  * class Retainer
@@ -141,6 +142,139 @@ ContextGroup* JSContext::Group() {
     return m_isolate;
 }
 
+/**
+ * class ArrayBufferPool
+ **/
+
+// Small blocks come in size classes of kPoolMinSize << n, up to kPoolMaxSize.  The region is
+// only reserved up front; it is committed a chunk at a time, each chunk serving a single
+// size class.  Committed chunks are never given back, so the region caps what the pool
+// can hold on to.
+static const size_t kPoolRegionSize = 32 * 1024 * 1024;
+static const size_t kPoolChunkSize = 64 * 1024;
+static const size_t kPoolMinSize = 16;
+static const size_t kPoolMaxSize = 4096;
+static const int kPoolClasses = 9;
+
+struct PoolClass {
+    std::mutex mutex;
+    void *free_list = nullptr;
+};
+
+static PoolClass s_pool_classes[kPoolClasses];
+static std::mutex s_pool_region_mutex;
+static std::atomic<char *> s_pool_region(nullptr);
+static std::atomic<bool> s_pool_region_failed(false);
+static std::atomic<size_t> s_pool_committed(0);
+static std::atomic<size_t> s_pool_free(0);
+static uint8_t s_pool_chunk_class[kPoolRegionSize / kPoolChunkSize];
+
+static int PoolSizeClass(size_t length) {
+    int size_class = 0;
+    for (size_t size = kPoolMinSize; size < length; size <<= 1) {
+        size_class++;
+    }
+    return size_class;
+}
+
+// Commits a new chunk for 'size_class' and puts all of its blocks but the first on the
+// free list.  Returns the first one, or nullptr if the region is used up.
+static void* PoolRefill(int size_class) {
+    const size_t block_size = kPoolMinSize << size_class;
+    char *chunk;
+    {
+        std::lock_guard<std::mutex> lock(s_pool_region_mutex);
+        if (!s_pool_region.load() && !s_pool_region_failed) {
+            void *region = mmap(nullptr, kPoolRegionSize, PROT_NONE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (region == MAP_FAILED) {
+                s_pool_region_failed = true;
+            } else {
+                s_pool_region = (char *) region;
+            }
+        }
+        size_t committed = s_pool_committed.load();
+        if (!s_pool_region.load() || committed + kPoolChunkSize > kPoolRegionSize) {
+            return nullptr;
+        }
+        chunk = s_pool_region.load() + committed;
+        if (mprotect(chunk, kPoolChunkSize, PROT_READ | PROT_WRITE)) {
+            return nullptr;
+        }
+        s_pool_chunk_class[committed / kPoolChunkSize] = (uint8_t) size_class;
+        s_pool_committed = committed + kPoolChunkSize;
+    }
+
+    PoolClass& pool = s_pool_classes[size_class];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (char *block = chunk + kPoolChunkSize - block_size; block != chunk;
+         block -= block_size) {
+        *(void **) block = pool.free_list;
+        pool.free_list = block;
+    }
+    s_pool_free += kPoolChunkSize - block_size;
+    return chunk;
+}
+
+void* ArrayBufferPool::Allocate(size_t length, bool zero_fill, Counters *counters) {
+    counters->allocations++;
+
+    if (length <= kPoolMaxSize && !s_pool_region_failed) {
+        int size_class = PoolSizeClass(length);
+        PoolClass& pool = s_pool_classes[size_class];
+        void *block = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.free_list) {
+                block = pool.free_list;
+                pool.free_list = *(void **) block;
+                s_pool_free -= kPoolMinSize << size_class;
+            }
+        }
+        if (block) {
+            counters->pool_hits++;
+            if (zero_fill) {
+                memset(block, 0, length);
+            }
+            return block;
+        }
+        // Fresh pages are already zeroed
+        block = PoolRefill(size_class);
+        if (block) {
+            return block;
+        }
+    }
+
+    // calloc() gets large blocks straight from mmap(), zeroed, rather than clearing them
+    return zero_fill ? calloc(length, 1) : malloc(length);
+}
+
+void ArrayBufferPool::Free(void *data, size_t length, Counters *counters) {
+    char *region = s_pool_region.load();
+    if (region && data >= region && (char *) data < region + kPoolRegionSize) {
+        int size_class = s_pool_chunk_class[((char *) data - region) / kPoolChunkSize];
+        PoolClass& pool = s_pool_classes[size_class];
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            *(void **) data = pool.free_list;
+            pool.free_list = data;
+        }
+        s_pool_free += kPoolMinSize << size_class;
+        counters->recycled++;
+    } else {
+        free(data);
+        counters->freed++;
+    }
+}
+
+size_t ArrayBufferPool::CommittedBytes() {
+    return s_pool_committed.load();
+}
+
+size_t ArrayBufferPool::FreeBytes() {
+    return s_pool_free.load();
+}
+
 /**
  * class ContextGroup
  **/
@@ -148,6 +282,7 @@ ContextGroup* JSContext::Group() {
 Platform *ContextGroup::s_platform = NULL;
 int ContextGroup::s_init_count = 0;
 std::mutex ContextGroup::s_mutex;
+std::mutex ContextGroup::s_isolate_map_mutex;
 std::map<Isolate *, ContextGroup *> ContextGroup::s_isolate_map;
 
 void ContextGroup::init_v8() {
@@ -179,32 +314,95 @@ void ContextGroup::dispose_v8() {
     s_mutex.unlock();
 }
 
-GenericAllocator ContextGroup::s_allocator;
+ContextGroup::ContextGroup() : ContextGroup(new GenericAllocator(), 0) {
+}
 
-ContextGroup::ContextGroup() {
-    init_v8();
-    m_create_params.array_buffer_allocator = &s_allocator;
-    m_isolate = Isolate::New(m_create_params);
-    m_manage_isolate = true;
-    m_uv_loop = nullptr;
-    m_thread_id = std::this_thread::get_id();
-    m_async_handle = nullptr;
+ContextGroup::ContextGroup(size_t max_heap_mb) : ContextGroup(new GenericAllocator(), max_heap_mb) {
+    Isolate *isolate = m_isolate;
+    SetNearHeapLimitHandler([isolate]() {
+        __android_log_print(ANDROID_LOG_WARN, "ContextGroup",
+            "Heap limit nearly reached, terminating execution");
+        isolate->TerminateExecution();
+    });
+}
+
+ContextGroup::ContextGroup(Isolate *isolate, uv_loop_t *uv_loop,
+                           std::shared_ptr<ArrayBufferPool::Counters> counters)
+    : ContextGroup(isolate, nullptr, counters, uv_loop) {
+}
 
-    s_isolate_map[m_isolate] = this;
-    m_gc_callbacks.clear();
-    //m_isolate->AddGCPrologueCallback(StaticGCPrologueCallback);
+ContextGroup::ContextGroup(GenericAllocator *allocator, size_t max_heap_mb)
+    : ContextGroup(NewIsolate(allocator, max_heap_mb), allocator, allocator->Counters(), nullptr) {
 }
 
-ContextGroup::ContextGroup(Isolate *isolate, uv_loop_t *uv_loop) {
+ContextGroup::ContextGroup(Isolate *isolate, GenericAllocator *allocator,
+                           std::shared_ptr<ArrayBufferPool::Counters> counters,
+                           uv_loop_t *uv_loop) {
     m_isolate = isolate;
-    m_manage_isolate = false;
+    m_allocator = allocator;
+    m_allocator_counters = counters;
+    // Only groups that create their isolate have an allocator of their own
+    m_manage_isolate = allocator != nullptr;
     m_uv_loop = uv_loop;
     m_thread_id = std::this_thread::get_id();
     m_async_handle = nullptr;
+    m_near_heap_limit = false;
+    m_gc_start = 0;
+    memset(&m_gc_stats, 0, sizeof m_gc_stats);
+
+    m_memory_pressure_handle = nullptr;
+    if (uv_loop) {
+        m_memory_pressure_handle = new uv_async_t();
+        m_memory_pressure_handle->data = this;
+        uv_async_init(uv_loop, m_memory_pressure_handle, MemoryPressureCallback);
+        uv_unref(reinterpret_cast<uv_handle_t*>(m_memory_pressure_handle));
+    }
 
-    s_isolate_map[m_isolate] = this;
-    m_gc_callbacks.clear();
-    //m_isolate->AddGCPrologueCallback(StaticGCPrologueCallback);
+    AddToIsolateMap();
+}
+
+Isolate * ContextGroup::NewIsolate(GenericAllocator *allocator, size_t max_heap_mb) {
+    init_v8();
+    Isolate::CreateParams create_params;
+    create_params.array_buffer_allocator = allocator;
+    if (max_heap_mb) {
+        create_params.constraints.set_max_old_space_size((int) max_heap_mb);
+    }
+    return Isolate::New(create_params);
+}
+
+void ContextGroup::AddToIsolateMap() {
+    {
+        std::lock_guard<std::mutex> lock(s_isolate_map_mutex);
+        s_isolate_map[m_isolate] = this;
+    }
+
+    // The callbacks are never removed: the isolate of a group may be gone by the time the
+    // group is, and they do nothing for isolates that are no longer in the map.
+    m_isolate->AddGCPrologueCallback(StaticGCPrologueCallback);
+    m_isolate->AddGCEpilogueCallback(StaticGCEpilogueCallback);
+}
+
+ContextGroup* ContextGroup::FromIsolate(Isolate *isolate) {
+    std::lock_guard<std::mutex> lock(s_isolate_map_mutex);
+    auto it = s_isolate_map.find(isolate);
+    return it == s_isolate_map.end() ? nullptr : it->second;
+}
+
+void ContextGroup::StaticGCPrologueCallback(Isolate *isolate, GCType type,
+                                            GCCallbackFlags flags) {
+    ContextGroup *group = FromIsolate(isolate);
+    if (group) {
+        group->GCPrologueCallback(type, flags);
+    }
+}
+
+void ContextGroup::StaticGCEpilogueCallback(Isolate *isolate, GCType type,
+                                            GCCallbackFlags flags) {
+    ContextGroup *group = FromIsolate(isolate);
+    if (group) {
+        group->GCEpilogueCallback(type, flags);
+    }
 }
 
 void ContextGroup::callback(uv_async_t* handle) {
@@ -293,6 +491,8 @@ void ContextGroup::UnregisterGCCallback(void (*cb)(GCType, GCCallbackFlags, void
 }
 
 void ContextGroup::GCPrologueCallback(GCType type, GCCallbackFlags flags) {
+    m_gc_start = Platform()->MonotonicallyIncreasingTime();
+
     auto it = m_gc_callbacks.begin();
 
     while (it != m_gc_callbacks.end()) {
@@ -302,13 +502,82 @@ void ContextGroup::GCPrologueCallback(GCType type, GCCallbackFlags flags) {
     }
 }
 
-ContextGroup::~ContextGroup() {
-    //Not really necessary at this point
-    //m_isolate->RemoveGCPrologueCallback(StaticGCPrologueCallback);
+void ContextGroup::GCEpilogueCallback(GCType type, GCCallbackFlags flags) {
+    double pause_ms = (Platform()->MonotonicallyIncreasingTime() - m_gc_start) * 1e3;
+
+    HeapStatistics heap;
+    m_isolate->GetHeapStatistics(&heap);
+
+    {
+        std::lock_guard<std::mutex> lock(m_gc_stats_mutex);
+        if (type == kGCTypeScavenge) {
+            m_gc_stats.scavenges++;
+        } else {
+            m_gc_stats.mark_sweeps++;
+        }
+        m_gc_stats.total_pause_ms += pause_ms;
+        m_gc_stats.max_pause_ms = std::max(m_gc_stats.max_pause_ms, pause_ms);
+        m_gc_stats.used_heap_size = heap.used_heap_size();
+        m_gc_stats.total_heap_size = heap.total_heap_size();
+        m_gc_stats.heap_size_limit = heap.heap_size_limit();
+    }
+
+    // Only a full GC tells whether the heap is really full.  Above 90% of the limit V8 is
+    // close to giving up with an out-of-memory crash, which would take the app with it.
+    if (m_near_heap_limit_handler && type == kGCTypeMarkSweepCompact) {
+        if (!m_near_heap_limit && heap.used_heap_size() > heap.heap_size_limit() / 10 * 9) {
+            m_near_heap_limit = true;
+            m_near_heap_limit_handler();
+        } else if (heap.used_heap_size() < heap.heap_size_limit() / 10 * 8) {
+            m_near_heap_limit = false;
+        }
+    }
+}
+
+void ContextGroup::SetNearHeapLimitHandler(std::function<void()> handler) {
+    m_near_heap_limit_handler = handler;
+}
+
+bool ContextGroup::IdleNotification(double budget_ms) {
+    double start = Platform()->MonotonicallyIncreasingTime();
+    bool done = m_isolate->IdleNotificationDeadline(start + budget_ms / 1e3);
+
+    std::lock_guard<std::mutex> lock(m_gc_stats_mutex);
+    m_gc_stats.idle_notifications++;
+    m_gc_stats.idle_time_ms += (Platform()->MonotonicallyIncreasingTime() - start) * 1e3;
+    return done;
+}
+
+ContextGroup::GCStatistics ContextGroup::GetGCStatistics() {
+    std::lock_guard<std::mutex> lock(m_gc_stats_mutex);
+    return m_gc_stats;
+}
+
+ContextGroup::AllocatorStatistics ContextGroup::GetAllocatorStatistics() {
+    AllocatorStatistics stats;
+    memset(&stats, 0, sizeof stats);
+    if (m_allocator_counters) {
+        stats.allocations = m_allocator_counters->allocations;
+        stats.pool_hits = m_allocator_counters->pool_hits;
+        stats.recycled = m_allocator_counters->recycled;
+        stats.freed = m_allocator_counters->freed;
+    }
+    stats.pool_committed_bytes = ArrayBufferPool::CommittedBytes();
+    stats.pool_free_bytes = ArrayBufferPool::FreeBytes();
+    return stats;
+}
 
-    s_isolate_map.erase(m_isolate);
+ContextGroup::~ContextGroup() {
+    {
+        // A detached group's isolate may be gone, and its address taken by a new one
+        std::lock_guard<std::mutex> lock(s_isolate_map_mutex);
+        auto it = s_isolate_map.find(m_isolate);
+        if (it != s_isolate_map.end() && it->second == this) {
+            s_isolate_map.erase(it);
+        }
+    }
     if (m_manage_isolate) {
-        auto dispose = [](Isolate *isolate) {
+        auto dispose = [](Isolate *isolate, GenericAllocator *allocator) {
             // This is a hack to deal with the following failure message from V8
             // when executed during the Java finalizer (sometimes):
             // #
@@ -321,7 +590,7 @@ ContextGroup::~ContextGroup() {
             // (see code for v8::Isolate::TearDown() in deps/v8/src/isolate.cc), but
             // I am confused as to why (2) is required.
             Isolate::CreateParams params;
-            params.array_buffer_allocator = &s_allocator;
+            params.array_buffer_allocator = allocator;
             Isolate *temp_isolate = Isolate::New(params);
             {
                 temp_isolate->Enter();
@@ -329,9 +598,11 @@ ContextGroup::~ContextGroup() {
                 temp_isolate->Exit();
             }
             temp_isolate->Dispose();
+            // Only now, Dispose() frees both isolates' last ArrayBuffers through it
+            delete allocator;
             dispose_v8();
         };
-        std::thread(dispose, m_isolate).detach();
+        std::thread(dispose, m_isolate, m_allocator).detach();
     } else {
         dispose_v8();
     }
@@ -343,20 +614,32 @@ void ContextGroup::sync(std::function<void()> runnable) {
         std::condition_variable cv;
         bool signaled = false;
 
-        struct Runnable *r = new struct Runnable;
-        r->thiz = nullptr;
-        r->runnable = nullptr;
-        r->jvm = nullptr;
-        r->c_runnable = [&]() {
+        async([&]() {
             runnable();
             {
                 std::lock_guard<std::mutex> lk(m_async_mutex);
                 signaled = true;
             }
             cv.notify_one();
-        };
+        });
 
         std::unique_lock<std::mutex> lk(m_async_mutex);
+        cv.wait(lk, [&]{return signaled;});
+        lk.unlock();
+    } else {
+        runnable();
+    }
+}
+
+void ContextGroup::async(std::function<void()> runnable) {
+    if (Loop() && std::this_thread::get_id() != Thread()) {
+        struct Runnable *r = new struct Runnable;
+        r->thiz = nullptr;
+        r->runnable = nullptr;
+        r->jvm = nullptr;
+        r->c_runnable = runnable;
+
+        std::lock_guard<std::mutex> lk(m_async_mutex);
         m_runnables.push_back(r);
 
         if (!m_async_handle) {
@@ -365,10 +648,152 @@ void ContextGroup::sync(std::function<void()> runnable) {
             uv_async_init(Loop(), m_async_handle, ContextGroup::callback);
             uv_async_send(m_async_handle);
         }
-
-        cv.wait(lk, [&]{return signaled;});
-        lk.unlock();
     } else {
         runnable();
     }
 }
+
+// Time given to V8 to make progress on a moderate memory pressure notification
+static const double kMemoryPressureIdleBudget = 20; // ms
+
+void ContextGroup::MemoryPressureCallback(uv_async_t* handle) {
+    ContextGroup *group = reinterpret_cast<ContextGroup*>(handle->data);
+
+    std::list<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lk(group->m_async_mutex);
+        tasks.swap(group->m_memory_pressure_tasks);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+bool ContextGroup::RetainIfAlive() {
+    // Only called under s_isolate_map_mutex, which the destructor takes before anything
+    // else, so the group is still there even if its count has dropped to 0
+    int count = m_count;
+    while (count > 0) {
+        if (m_count.compare_exchange_weak(count, count + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ContextGroup::Detach() {
+    {
+        std::lock_guard<std::mutex> lock(s_isolate_map_mutex);
+        s_isolate_map.erase(m_isolate);
+    }
+
+    if (m_memory_pressure_handle) {
+        // Whoever is still waiting for these gives up after its timeout
+        {
+            std::lock_guard<std::mutex> lk(m_async_mutex);
+            m_memory_pressure_tasks.clear();
+        }
+        uv_close(reinterpret_cast<uv_handle_t*>(m_memory_pressure_handle), [](uv_handle_t* h) {
+            delete reinterpret_cast<uv_async_t*>(h);
+        });
+        m_memory_pressure_handle = nullptr;
+        uv_run(m_uv_loop, UV_RUN_NOWAIT);
+    }
+}
+
+ssize_t ContextGroup::OnMemoryPressure(MemoryPressureLevel level) {
+    HeapStatistics before, after;
+    m_isolate->GetHeapStatistics(&before);
+
+    switch (level) {
+        case MemoryPressureLevel::kNone:
+            m_isolate->MemoryPressureNotification(level);
+            break;
+        case MemoryPressureLevel::kModerate:
+            m_isolate->MemoryPressureNotification(level);
+            IdleNotification(kMemoryPressureIdleBudget);
+            break;
+        case MemoryPressureLevel::kCritical:
+            // Without a v8::Locker, MemoryPressureNotification() only schedules the GC.  Do
+            // it here and now instead, so that the memory is back before we report it.
+            m_isolate->LowMemoryNotification();
+            break;
+    }
+
+    m_isolate->GetHeapStatistics(&after);
+    return after.used_heap_size() < before.used_heap_size() ?
+        (ssize_t)(before.used_heap_size() - after.used_heap_size()) : 0;
+}
+
+std::vector<ssize_t> ContextGroup::NotifyMemoryPressure(MemoryPressureLevel level,
+                                                        int timeout_ms) {
+    struct Pending {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<ssize_t> reclaimed;
+        size_t remaining;
+    };
+    auto pending = std::make_shared<Pending>();
+    std::vector<std::pair<ContextGroup*,size_t>> direct;
+
+    {
+        std::lock_guard<std::mutex> lock(s_isolate_map_mutex);
+        pending->reclaimed.assign(s_isolate_map.size(), -1);
+        pending->remaining = 0;
+
+        size_t index = 0;
+        for (auto it : s_isolate_map) {
+            ContextGroup *group = it.second;
+            if (group->m_memory_pressure_handle &&
+                    std::this_thread::get_id() != group->Thread()) {
+                // Node instances get it on their own thread.  Sending does not wait for the
+                // loop, so it is safe to do under the lock, which keeps Detach() from
+                // closing the handle in the meantime.
+                pending->remaining++;
+                {
+                    std::lock_guard<std::mutex> lk(group->m_async_mutex);
+                    group->m_memory_pressure_tasks.push_back([group, level, pending, index]() {
+                        ssize_t reclaimed = group->OnMemoryPressure(level);
+                        std::lock_guard<std::mutex> lk(pending->mutex);
+                        pending->reclaimed[index] = reclaimed;
+                        if (--pending->remaining == 0) {
+                            pending->cv.notify_one();
+                        }
+                    });
+                }
+                uv_async_send(group->m_memory_pressure_handle);
+            } else if (group->RetainIfAlive()) {
+                // Groups without a loop have no thread of their own.  They are handled here,
+                // holding their lock, once the map is unlocked: a GC calls back into it.
+                direct.push_back(std::make_pair(group, index));
+            }
+            index++;
+        }
+    }
+
+    for (auto it : direct) {
+        ContextGroup *group = it.first;
+        ssize_t reclaimed;
+        group->Lock();
+        {
+            Isolate::Scope isolate_scope(group->isolate());
+            reclaimed = group->OnMemoryPressure(level);
+        }
+        group->Unlock();
+        group->release();
+
+        std::lock_guard<std::mutex> lk(pending->mutex);
+        pending->reclaimed[it.second] = reclaimed;
+    }
+
+    if (level != MemoryPressureLevel::kNone) {
+        size_t freed = NodeInstance::TrimCaches(level == MemoryPressureLevel::kCritical);
+        __android_log_print(ANDROID_LOG_DEBUG, "ContextGroup",
+            "Memory pressure: %zu bytes of cached module code freed", freed);
+    }
+
+    std::unique_lock<std::mutex> lk(pending->mutex);
+    pending->cv.wait_for(lk, std::chrono::milliseconds(timeout_ms),
+        [&]{ return pending->remaining == 0; });
+    return pending->reclaimed;
+}
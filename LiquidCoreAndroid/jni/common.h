@@ -44,6 +44,9 @@
 #include <list>
 #include <functional>
 #include <map>
+#include <vector>
+#include <atomic>
+#include <memory>
 
 #include "v8.h"
 #include "libplatform/libplatform.h"
@@ -84,7 +87,7 @@ protected:
     }
 
 public:
-    int m_count;
+    std::atomic<int> m_count;
 
 public:
 #ifdef DEBUG_RETAINER
@@ -93,21 +96,46 @@ public:
 #endif
 };
 
+// Recycles the backing stores of small ArrayBuffers (Buffers, TypedArrays) across all
+// isolates in the process.  Small blocks are carved out of one reserved region, sorted by
+// size class and kept on a free list when released; anything larger is handed to calloc()
+// or malloc().  Blocks that did not come from the region, e.g. the ones node and
+// node-sqlite3 malloc() themselves and hand over to V8, are passed on to free().
+class ArrayBufferPool {
+public:
+    // Kept per allocator, i.e. per isolate
+    struct Counters {
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> pool_hits;        // served from the free lists
+        std::atomic<uint64_t> recycled;         // put back on the free lists
+        std::atomic<uint64_t> freed;            // passed on to free()
+        Counters() : allocations(0), pool_hits(0), recycled(0), freed(0) {}
+    };
+
+    static void* Allocate(size_t length, bool zero_fill, Counters *counters);
+    static void Free(void *data, size_t length, Counters *counters);
+    // Bytes of the region in use and on the free lists
+    static size_t CommittedBytes();
+    static size_t FreeBytes();
+};
+
 class GenericAllocator : public ArrayBuffer::Allocator {
 public:
-    GenericAllocator() {}
+    GenericAllocator() : m_counters(std::make_shared<ArrayBufferPool::Counters>()) {}
     virtual ~GenericAllocator() {}
     virtual void* Allocate(size_t length) {
-        unsigned char * mem =  (unsigned char *) malloc(length);
-        memset(mem, 0, length);
-        return (void*)mem;
+        return ArrayBufferPool::Allocate(length, true, m_counters.get());
     }
     virtual void* AllocateUninitialized(size_t length) {
-        return malloc(length);
+        return ArrayBufferPool::Allocate(length, false, m_counters.get());
     }
     virtual void Free(void* data, size_t length) {
-        free(data);
+        ArrayBufferPool::Free(data, length, m_counters.get());
     }
+    std::shared_ptr<ArrayBufferPool::Counters> Counters() { return m_counters; }
+
+private:
+    std::shared_ptr<ArrayBufferPool::Counters> m_counters;
 };
 
 struct Runnable {
@@ -121,7 +149,34 @@ class JSContext;
 class ContextGroup : public Retainer {
 public:
     ContextGroup();
-    ContextGroup(Isolate *isolate, uv_loop_t *uv_loop);
+    // Creates a group whose heap is limited to about 'max_heap_mb' megabytes.  Execution is
+    // terminated when the heap is nearly full, see SetNearHeapLimitHandler().
+    explicit ContextGroup(size_t max_heap_mb);
+    // 'counters' are those of the isolate's ArrayBuffer allocator, if it has pooled ones.
+    // Must be called on the thread that runs 'uv_loop'.
+    ContextGroup(Isolate *isolate, uv_loop_t *uv_loop,
+                 std::shared_ptr<ArrayBufferPool::Counters> counters = nullptr);
+
+    struct GCStatistics {
+        uint64_t scavenges;
+        uint64_t mark_sweeps;
+        double total_pause_ms;
+        double max_pause_ms;
+        uint64_t idle_notifications;
+        double idle_time_ms;
+        size_t used_heap_size;      // as of the last GC
+        size_t total_heap_size;
+        size_t heap_size_limit;
+    };
+
+    struct AllocatorStatistics {
+        uint64_t allocations;
+        uint64_t pool_hits;
+        uint64_t recycled;
+        uint64_t freed;
+        size_t pool_committed_bytes;    // process-wide
+        size_t pool_free_bytes;         // process-wide
+    };
 
     virtual Isolate* isolate() {
         return m_isolate;
@@ -144,32 +199,69 @@ public:
     }
 
     virtual void sync(std::function<void()> runnable);
+    // Like sync(), but returns without waiting for 'runnable' to run.
+    virtual void async(std::function<void()> runnable);
     virtual void RegisterGCCallback(void (*cb)(GCType type, GCCallbackFlags flags, void*), void *);
     virtual void UnregisterGCCallback(void (*cb)(GCType type, GCCallbackFlags flags,void*), void *);
 
+    // Called on the isolate's thread, from a GC callback, when a full GC leaves the heap
+    // nearly full.  It must not touch the heap; terminating execution and shedding work
+    // later is all it can do.  Called again only once the heap has shrunk back.
+    virtual void SetNearHeapLimitHandler(std::function<void()> handler);
+    // Lets V8 do pending GC work for up to 'budget_ms'.  Must be called on the isolate's
+    // thread.  Returns true if there is no GC work left.
+    virtual bool IdleNotification(double budget_ms);
+    virtual GCStatistics GetGCStatistics();
+    virtual AllocatorStatistics GetAllocatorStatistics();
+
+    // Called on the loop's thread once the loop has run down, before the isolate is
+    // disposed.  The group lives on for as long as it is retained, but is no longer told
+    // about memory pressure or GCs.
+    virtual void Detach();
+
+    // Passes memory pressure from the host on to every isolate in the process, each on the
+    // thread it runs on, and shrinks the caches kept for node instances.  Returns the number
+    // of bytes each isolate reclaimed, or -1 for isolates that did not get to it within
+    // 'timeout_ms' (e.g. parked node instances).
+    static std::vector<ssize_t> NotifyMemoryPressure(MemoryPressureLevel level,
+                                                     int timeout_ms);
+
     static void init_v8();
     static std::mutex *Mutex() { return &s_mutex; }
     static v8::Platform * Platform() { return s_platform; }
     static void callback(uv_async_t* handle);
-    static void StaticGCPrologueCallback(Isolate *isolate, GCType type, GCCallbackFlags flags) {
-        s_isolate_map[isolate]->GCPrologueCallback(type, flags);
-    }
+    static void StaticGCPrologueCallback(Isolate *isolate, GCType type, GCCallbackFlags flags);
+    static void StaticGCEpilogueCallback(Isolate *isolate, GCType type, GCCallbackFlags flags);
 
 protected:
     virtual ~ContextGroup();
     virtual void GCPrologueCallback(GCType type, GCCallbackFlags flags);
+    virtual void GCEpilogueCallback(GCType type, GCCallbackFlags flags);
 
 private:
+    // Creates the group's own isolate, whose ArrayBuffers 'allocator' allocates.  A
+    // 'max_heap_mb' of 0 leaves the heap size to V8.
+    ContextGroup(GenericAllocator *allocator, size_t max_heap_mb);
+    ContextGroup(Isolate *isolate, GenericAllocator *allocator,
+                 std::shared_ptr<ArrayBufferPool::Counters> counters, uv_loop_t *uv_loop);
+    static Isolate * NewIsolate(GenericAllocator *allocator, size_t max_heap_mb);
     static void dispose_v8();
+    static ContextGroup* FromIsolate(Isolate *isolate);
+    ssize_t OnMemoryPressure(MemoryPressureLevel level);
+    static void MemoryPressureCallback(uv_async_t* handle);
+    // Retains the group unless it is already on its way out
+    bool RetainIfAlive();
+    void AddToIsolateMap();
 
     static v8::Platform *s_platform;
     static int s_init_count;
     static std::mutex s_mutex;
+    static std::mutex s_isolate_map_mutex;
     static std::map<Isolate *, ContextGroup *> s_isolate_map;
 
     Isolate *m_isolate;
-    Isolate::CreateParams m_create_params;
-    static GenericAllocator s_allocator;
+    GenericAllocator *m_allocator;
+    std::shared_ptr<ArrayBufferPool::Counters> m_allocator_counters;
     bool m_manage_isolate;
     uv_loop_t *m_uv_loop;
     std::thread::id m_thread_id;
@@ -181,10 +273,21 @@ private:
     };
     std::list<struct GCCallback *> m_gc_callbacks;
 
+    std::function<void()> m_near_heap_limit_handler;
+    bool m_near_heap_limit;
+    double m_gc_start;
+    GCStatistics m_gc_stats;
+    std::mutex m_gc_stats_mutex;
+
 public:
     uv_async_t *m_async_handle;
     std::list<struct Runnable *> m_runnables;
     std::mutex m_async_mutex;
+
+private:
+    // Made on the loop's own thread, so that other threads only have to send it
+    uv_async_t *m_memory_pressure_handle;
+    std::list<std::function<void()>> m_memory_pressure_tasks;
 };
 
 template <typename T>
@@ -34,6 +34,8 @@
 #include "NodeInstance.h"
 
 #include "nodedroid_file.h"
+#include "node_code_cache.h"
+#include "handle_wrap.h"
 
 #if defined HAVE_PERFCTR
 #include "node_counters.h"
@@ -57,9 +59,37 @@
 
 #include "JSC/JSC.h"
 
-NodeInstance::NodeInstance(JNIEnv* env, jobject thiz) {
+// Idle-time GC: the loop must be about to wait for at least kIdleGCMinWait ms, and V8 gets
+// kIdleGCSlice ms at a time.
+static const int kIdleGCMinWait = 10;
+static const double kIdleGCSlice = 5;
+
+// node's allocator, with the backing stores coming from the ArrayBufferPool.  Keeps node's
+// handling of Buffer.allocUnsafe(), which skips zero filling.
+class PooledArrayBufferAllocator : public ArrayBufferAllocator {
+public:
+    PooledArrayBufferAllocator() : m_counters(std::make_shared<ArrayBufferPool::Counters>()) {}
+    virtual void* Allocate(size_t size) {
+        return ArrayBufferPool::Allocate(size, ZeroFill(), m_counters.get());
+    }
+    virtual void* AllocateUninitialized(size_t size) {
+        return ArrayBufferPool::Allocate(size, false, m_counters.get());
+    }
+    virtual void Free(void* data, size_t size) {
+        ArrayBufferPool::Free(data, size, m_counters.get());
+    }
+    std::shared_ptr<ArrayBufferPool::Counters> Counters() { return m_counters; }
+
+private:
+    std::shared_ptr<ArrayBufferPool::Counters> m_counters;
+};
+
+NodeInstance::NodeInstance(JNIEnv* env, jobject thiz, unsigned int threadpool_size,
+                           size_t max_heap_mb) {
     env->GetJavaVM(&m_jvm);
     m_JavaThis = env->NewGlobalRef(thiz);
+    this->threadpool_size = threadpool_size;
+    this->max_heap_mb = max_heap_mb;
 
     node_main_thread = new std::thread(node_main_task,reinterpret_cast<void*>(this));
 }
@@ -70,6 +100,13 @@ NodeInstance::NodeInstance() {
     node_main_thread = new std::thread(node_main_task,reinterpret_cast<void*>(this));
 }
 
+NodeInstance::NodeInstance(JavaVM* jvm) {
+    m_jvm = jvm;
+    m_JavaThis = nullptr;
+    parked = true;
+    node_main_thread = new std::thread(node_main_task,reinterpret_cast<void*>(this));
+}
+
 NodeInstance::~NodeInstance() {
     node_main_thread->join();
     delete node_main_thread;
@@ -100,40 +137,153 @@ void NodeInstance::spawnedThread()
 
     int ret = Start(argc, argv);
 
-    if (m_jvm) {
-        JNIEnv *env;
-        int getEnvStat = m_jvm->GetEnv((void**)&env, JNI_VERSION_1_6);
-        if (getEnvStat == JNI_EDETACHED) {
-            m_jvm->AttachCurrentThread(&env, NULL);
-        }
+    if (m_JavaThis) {
+        CallJava(m_jvm, m_JavaThis, "onNodeExit", "(J)V", (jlong)ret);
+        DeleteGlobalRef(m_jvm, m_JavaThis);
+    }
+}
 
-        jclass cls = env->GetObjectClass(m_JavaThis);
-        jmethodID mid;
-        do {
-            mid = env->GetMethodID(cls,"onNodeExit","(J)V");
-            if (!env->ExceptionCheck()) break;
-            env->ExceptionClear();
-            jclass super = env->GetSuperclass(cls);
-            env->DeleteLocalRef(cls);
-            if (super == NULL || env->ExceptionCheck()) {
-                if (super != NULL) env->DeleteLocalRef(super);
-                if (getEnvStat == JNI_EDETACHED) {
-                    m_jvm->DetachCurrentThread();
-                }
-                return;
-            }
-            cls = super;
-        } while (true);
+// Calls the void Java method 'method' of 'thiz' or of one of its superclasses.  Returns
+// false if there is no such method.
+bool NodeInstance::CallJava(JavaVM* jvm, jobject thiz, const char* method, const char* sig,
+                            ...) {
+    JNIEnv *env;
+    int getEnvStat = jvm->GetEnv((void**)&env, JNI_VERSION_1_6);
+    if (getEnvStat == JNI_EDETACHED) {
+        jvm->AttachCurrentThread(&env, NULL);
+    }
+
+    jclass cls = env->GetObjectClass(thiz);
+    jmethodID mid;
+    do {
+        mid = env->GetMethodID(cls,method,sig);
+        if (!env->ExceptionCheck()) break;
+        env->ExceptionClear();
+        jclass super = env->GetSuperclass(cls);
         env->DeleteLocalRef(cls);
+        if (super == NULL || env->ExceptionCheck()) {
+            if (super != NULL) env->DeleteLocalRef(super);
+            if (getEnvStat == JNI_EDETACHED) {
+                jvm->DetachCurrentThread();
+            }
+            return false;
+        }
+        cls = super;
+    } while (true);
+    env->DeleteLocalRef(cls);
+
+    va_list args;
+    va_start(args, sig);
+    env->CallVoidMethodV(thiz, mid, args);
+    va_end(args);
+
+    if (getEnvStat == JNI_EDETACHED) {
+        jvm->DetachCurrentThread();
+    }
+    return true;
+}
+
+void NodeInstance::DeleteGlobalRef(JavaVM* jvm, jobject ref) {
+    JNIEnv *env;
+    int getEnvStat = jvm->GetEnv((void**)&env, JNI_VERSION_1_6);
+    if (getEnvStat == JNI_EDETACHED) {
+        jvm->AttachCurrentThread(&env, NULL);
+    }
+    env->DeleteGlobalRef(ref);
+    if (getEnvStat == JNI_EDETACHED) {
+        jvm->DetachCurrentThread();
+    }
+}
+
+Mutex NodeInstance::pool_mutex;
+std::deque<NodeInstance*> NodeInstance::pool;
+size_t NodeInstance::pool_size = 0;
+
+NodeInstance* NodeInstance::Claim(JNIEnv* env, jobject thiz, unsigned int threadpool_size,
+                                  size_t max_heap_mb) {
+    NodeInstance *instance = nullptr;
+    // Parked instances share the process-wide thread pool and have no heap limit
+    if (threadpool_size == 0 && max_heap_mb == 0) {
+        Mutex::ScopedLock lock(pool_mutex);
+        if (!pool.empty()) {
+            instance = pool.front();
+            pool.pop_front();
+            instance->m_JavaThis = env->NewGlobalRef(thiz);
+            instance->park_cond.Signal(lock);
+        }
+    }
+    if (instance == nullptr) {
+        return new NodeInstance(env, thiz, threadpool_size, max_heap_mb);
+    }
+
+    JavaVM *jvm;
+    env->GetJavaVM(&jvm);
+    FillPool(jvm);
+    return instance;
+}
 
-        env->CallVoidMethod(m_JavaThis, mid, (jlong)ret);
+void NodeInstance::SetPoolSize(JNIEnv* env, size_t size) {
+    {
+        Mutex::ScopedLock lock(pool_mutex);
+        pool_size = size;
+    }
+    DrainPool(size);
+
+    JavaVM *jvm;
+    env->GetJavaVM(&jvm);
+    FillPool(jvm);
+}
 
-        env->DeleteGlobalRef(m_JavaThis);
+// Releases all parked instances.  The pool is filled up again on the next claim.
+void NodeInstance::TrimPool() {
+    DrainPool(0);
+}
+
+// Drops the module sources and resolution results cached for all instances, and the
+// compiled code cache as well if 'all'.  Returns the number of bytes freed.
+size_t NodeInstance::TrimCaches(bool all) {
+    nodedroid::TrimFs();
+    return code_cache::Trim(all);
+}
 
-        if (getEnvStat == JNI_EDETACHED) {
-            m_jvm->DetachCurrentThread();
+void NodeInstance::FillPool(JavaVM* jvm) {
+    Mutex::ScopedLock lock(pool_mutex);
+    while (pool.size() < pool_size) {
+        pool.push_back(new NodeInstance(jvm));
+    }
+}
+
+void NodeInstance::DrainPool(size_t size) {
+    std::vector<NodeInstance*> discarded;
+    {
+        Mutex::ScopedLock lock(pool_mutex);
+        while (pool.size() > size) {
+            NodeInstance *instance = pool.back();
+            pool.pop_back();
+            instance->discarded = true;
+            instance->park_cond.Signal(lock);
+            discarded.push_back(instance);
         }
     }
+    // Joins each node thread, outside of the lock and off the calling thread, so that
+    // resizing the pool from the UI thread does not wait for the instances to shut down
+    if (!discarded.empty()) {
+        std::thread([discarded]() {
+            for (NodeInstance *instance : discarded) {
+                delete instance;
+            }
+        }).detach();
+    }
+}
+
+// Called on the node thread of a pooled instance once it has bootstrapped.  Returns true
+// if a Process claimed the instance, false if it was discarded from the pool.
+bool NodeInstance::Park() {
+    Mutex::ScopedLock lock(pool_mutex);
+    while (m_JavaThis == nullptr && !discarded) {
+        park_cond.Wait(lock);
+    }
+    return m_JavaThis != nullptr;
 }
 
 void NodeInstance::node_main_task(void *inst) {
@@ -235,12 +385,31 @@ void NodeInstance::Chdir(const FunctionCallbackInfo<Value>& args) {
 }
 
 std::map<Environment*,NodeInstance*> NodeInstance::instance_map;
+std::map<Environment*,HostedProcess*> NodeInstance::hosted_map;
+std::map<JSContext*,HostedProcess*> NodeInstance::hosted_contexts;
+Mutex NodeInstance::hosts_mutex;
+std::set<NodeInstance*> NodeInstance::hosts;
 
 void NodeInstance::Exit(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   __android_log_print(ANDROID_LOG_DEBUG, "NodeInstance", "exit(%d) called", (int) args[0]->Int32Value());
 
+  HostedProcess *hosted = nullptr;
+  {
+    Mutex::ScopedLock lock(hosts_mutex);
+    auto it = hosted_map.find(env);
+    if (it != hosted_map.end()) hosted = it->second;
+  }
+  if (hosted) {
+    // Only this process goes away, the loop keeps running for its host and the others
+    if (!hosted->exiting) {
+      hosted->exit_code = (int) args[0]->Int32Value();
+      hosted->host->StopHosted(hosted);
+    }
+    return;
+  }
+
   NodeInstance *instance;
 
   ContextGroup::Mutex()->lock();
@@ -249,10 +418,7 @@ void NodeInstance::Exit(const FunctionCallbackInfo<Value>& args) {
 
   WaitForInspectorDisconnect(Environment::GetCurrent(args));
 
-  uv_walk(env->event_loop(), [](uv_handle_t* h, void* arg) {
-    uv_unref(h);
-  }, nullptr);
-  uv_stop(env->event_loop());
+  Stop(env);
 
   instance->didExit = true;
   instance->exit_code = (int) args[0]->Int32Value();
@@ -263,6 +429,20 @@ void NodeInstance::Abort(const FunctionCallbackInfo<Value>& args) {
 
   __android_log_print(ANDROID_LOG_DEBUG, "NodeInstance", "abort called");
 
+  HostedProcess *hosted = nullptr;
+  {
+    Mutex::ScopedLock lock(hosts_mutex);
+    auto it = hosted_map.find(env);
+    if (it != hosted_map.end()) hosted = it->second;
+  }
+  if (hosted) {
+    if (!hosted->exiting) {
+      hosted->exit_code = 1;
+      hosted->host->StopHosted(hosted);
+    }
+    return;
+  }
+
   NodeInstance *instance;
 
   ContextGroup::Mutex()->lock();
@@ -271,12 +451,17 @@ void NodeInstance::Abort(const FunctionCallbackInfo<Value>& args) {
 
   WaitForInspectorDisconnect(Environment::GetCurrent(args));
 
+  Stop(env);
+
+  instance->didExit = true;
+}
+
+// Lets the event loop run down: nothing it is waiting on keeps it alive anymore.
+void NodeInstance::Stop(Environment* env) {
   uv_walk(env->event_loop(), [](uv_handle_t* h, void* arg) {
     uv_unref(h);
   }, nullptr);
   uv_stop(env->event_loop());
-
-  instance->didExit = true;
 }
 
 // FIXME: Not sure if we should allow clients to do this
@@ -341,49 +526,36 @@ Environment* NodeInstance::CreateEnvironment(Isolate* isolate,
                            instance_data->exec_argv());
 }
 
+void NodeInstance::OverrideProcessMethods(Environment* env) {
+  Isolate* isolate = env->isolate();
+
+  // Override default chdir and cwd methods
+  Local<Object> process = env->process_object();
+  env->SetMethod(process, "chdir", Chdir);
+  env->SetMethod(process, "cwd", Cwd);
+
+  // Remove process.dlopen().  Nothing good can come of it in this environment.
+  process->Delete(env->context(), String::NewFromUtf8(isolate, "dlopen"));
+
+  // Override exit() and abort() so they don't nuke the app
+  env->SetMethod(process, "reallyExit", Exit);
+  env->SetMethod(process, "abort", Abort);
+  env->SetMethod(process, "_kill", Kill);
+}
+
 int NodeInstance::StartNodeInstance(void* arg) {
   NodeInstanceData* instance_data = static_cast<NodeInstanceData*>(arg);
+  uint64_t start_time = uv_hrtime();
   Isolate::CreateParams params;
-  ArrayBufferAllocator* array_buffer_allocator = new ArrayBufferAllocator();
+  PooledArrayBufferAllocator* array_buffer_allocator = new PooledArrayBufferAllocator();
   params.array_buffer_allocator = array_buffer_allocator;
+  if (max_heap_mb > 0) {
+    params.constraints.set_max_old_space_size((int) max_heap_mb);
+  }
   Isolate* isolate = Isolate::New(params);
   int exit_code = 1;
   ContextGroup *group = nullptr;
 
-  auto notify_start = [&] (JSContext *java_node_context, JSContextRef ctxRef) {
-      JNIEnv *jenv;
-      int getEnvStat = m_jvm->GetEnv((void**)&jenv, JNI_VERSION_1_6);
-      if (getEnvStat == JNI_EDETACHED) {
-        m_jvm->AttachCurrentThread(&jenv, NULL);
-      }
-
-      jclass cls = jenv->GetObjectClass(m_JavaThis);
-      jmethodID mid;
-      do {
-        mid = jenv->GetMethodID(cls,"onNodeStarted","(JJJ)V");
-        if (!jenv->ExceptionCheck()) break;
-        jenv->ExceptionClear();
-        jclass super = jenv->GetSuperclass(cls);
-        jenv->DeleteLocalRef(cls);
-        if (super == NULL || jenv->ExceptionCheck()) {
-          if (super != NULL) jenv->DeleteLocalRef(super);
-          if (getEnvStat == JNI_EDETACHED) {
-            m_jvm->DetachCurrentThread();
-          }
-          CHECK_EQ(0,1); // This is bad
-        }
-        cls = super;
-      } while (true);
-      jenv->DeleteLocalRef(cls);
-
-      jenv->CallVoidMethod(m_JavaThis, mid, reinterpret_cast<jlong>(java_node_context),
-        reinterpret_cast<jlong>(group), reinterpret_cast<jlong>(ctxRef));
-
-      if (getEnvStat == JNI_EDETACHED) {
-          m_jvm->DetachCurrentThread();
-      }
-  };
-
   {
     Mutex::ScopedLock scoped_lock(node_isolate_mutex);
     if (instance_data->is_main()) {
@@ -396,7 +568,8 @@ int NodeInstance::StartNodeInstance(void* arg) {
     Isolate::Scope isolate_scope(isolate);
     HandleScope handle_scope(isolate);
 
-    group = new ContextGroup(isolate, instance_data->event_loop());
+    group = new ContextGroup(isolate, instance_data->event_loop(),
+                             array_buffer_allocator->Counters());
 
     JSGlobalContextRef ctxRef = nullptr;
     JSClassRef globalClass = nullptr;
@@ -417,23 +590,21 @@ int NodeInstance::StartNodeInstance(void* arg) {
 
     Environment* env = CreateEnvironment(isolate, context, instance_data);
     array_buffer_allocator->set_env(env);
+    if (max_heap_mb > 0) {
+      group->SetNearHeapLimitHandler([this, env]() {
+        __android_log_print(ANDROID_LOG_WARN, "NodeInstance",
+          "Heap limit of %zuMB nearly reached, exiting", max_heap_mb);
+        env->isolate()->TerminateExecution();
+        Stop(env);
+        didExit = true;
+        this->exit_code = kHeapLimitExitCode;
+      });
+    }
     Context::Scope context_scope(context);
     {
       ContextGroup::Mutex()->lock();
 
-      // Override default chdir and cwd methods
-      Local<Object> process = env->process_object();
-      env->SetMethod(process, "chdir", Chdir);
-      env->SetMethod(process, "cwd", Cwd);
-
-      // Remove process.dlopen().  Nothing good can come of it in this environment.
-      process->Delete(env->context(), String::NewFromUtf8(isolate, "dlopen"));
-
-      // Override exit() and abort() so they don't nuke the app
-      env->SetMethod(process, "reallyExit", Exit);
-      env->SetMethod(process, "abort", Abort);
-      env->SetMethod(process, "_kill", Kill);
-
+      OverrideProcessMethods(env);
       instance_map[env] = this;
 
       isolate->SetAbortOnUncaughtExceptionCallback(
@@ -466,6 +637,16 @@ int NodeInstance::StartNodeInstance(void* arg) {
       ContextGroup::Mutex()->unlock();
     }
 
+    if (parked && !Park()) {
+      // Discarded without ever being claimed.  Nobody is going to define the onLoad hook
+      // the -e script calls, so define a no-op and let the loop run down.
+      ContextGroup::Mutex()->lock();
+      Local<String> source = String::NewFromUtf8(isolate,
+        "global.__nodedroid_onLoad = function() {};");
+      Script::Compile(context, source).ToLocalChecked()->Run(context);
+      ContextGroup::Mutex()->unlock();
+    }
+
     {
       SealHandleScope seal(isolate);
 
@@ -481,15 +662,64 @@ int NodeInstance::StartNodeInstance(void* arg) {
         ContextGroup::Mutex()->unlock();
       }
 */
-      if (m_jvm) {
+      __android_log_print(ANDROID_LOG_DEBUG, "NodeInstance", "started in %.1fms",
+        (uv_hrtime() - start_time) / 1e6);
+
+      if (m_JavaThis) {
         java_node_context->retain();
-        notify_start(java_node_context, ctxRef);
+        bool notified = CallJava(m_jvm, m_JavaThis, "onNodeStarted", "(JJJ)V",
+          reinterpret_cast<jlong>(java_node_context), reinterpret_cast<jlong>(group),
+          reinterpret_cast<jlong>(ctxRef));
+        CHECK(notified); // This is bad
+      }
+
+      // Hosted processes are started, checked on and torn down in between runs of the loop
+      {
+        Mutex::ScopedLock lock(hosted_mutex);
+        hosted_async = new uv_async_t();
+        uv_async_init(env->event_loop(), hosted_async, [](uv_async_t* handle) {
+          uv_stop(handle->loop);
+        });
+        uv_unref(reinterpret_cast<uv_handle_t*>(hosted_async));
+        hosted_prepare = new uv_prepare_t();
+        hosted_prepare->data = this;
+        uv_prepare_init(env->event_loop(), hosted_prepare);
+        uv_prepare_start(hosted_prepare, [](uv_prepare_t* handle) {
+          if (reinterpret_cast<NodeInstance*>(handle->data)->HostedNeedAttention())
+            uv_stop(handle->loop);
+        });
+        uv_unref(reinterpret_cast<uv_handle_t*>(hosted_prepare));
+      }
+      {
+        Mutex::ScopedLock lock(hosts_mutex);
+        hosts.insert(this);
       }
 
       bool more;
+      bool gc_idle = false;
       do {
         PumpMessageLoop(isolate);
-        more = uv_run(env->event_loop(), UV_RUN_ONCE);
+
+        // About to wait for a while with nothing to do: let V8 use part of that time to
+        // collect garbage, in slices short enough not to delay whatever wakes the loop up.
+        // While it has more to do, only poll the loop in between slices.
+        uv_run_mode mode = UV_RUN_ONCE;
+        int timeout = uv_backend_timeout(env->event_loop());
+        if (!gc_idle && (timeout < 0 || timeout >= kIdleGCMinWait)) {
+          gc_idle = group->IdleNotification(kIdleGCSlice);
+          if (!gc_idle) {
+            mode = UV_RUN_NOWAIT;
+          }
+        }
+
+        more = uv_run(env->event_loop(), mode);
+        if (mode == UV_RUN_ONCE) {
+          gc_idle = false;
+        }
+        if (!didExit) {
+          RunHosted(isolate, group, instance_data);
+          more = uv_loop_alive(env->event_loop());
+        }
 
         if (more == false) {
           PumpMessageLoop(isolate);
@@ -502,6 +732,9 @@ int NodeInstance::StartNodeInstance(void* arg) {
             more = true;
         }
       } while (more == true);
+
+      ShutDownHosted(isolate, group, instance_data);
+      group->Detach();
     }
 
     {
@@ -529,6 +762,8 @@ int NodeInstance::StartNodeInstance(void* arg) {
       array_buffer_allocator->set_env(nullptr);
 
       instance_map.erase(env);
+      nodedroid::DisposeFs(env);
+      group->SetNearHeapLimitHandler(nullptr);
 
       env->Dispose();
       env = nullptr;
@@ -555,6 +790,266 @@ int NodeInstance::StartNodeInstance(void* arg) {
   return exit_code;
 }
 
+HostedProcess* NodeInstance::Host(JNIEnv* env, jobject thiz, NodeInstance* host) {
+    Mutex::ScopedLock lock(hosts_mutex);
+    if (hosts.find(host) == hosts.end()) {
+        return nullptr;
+    }
+
+    HostedProcess *hosted = new HostedProcess();
+    hosted->host = host;
+    hosted->m_JavaThis = env->NewGlobalRef(thiz);
+    {
+        Mutex::ScopedLock hosted_lock(host->hosted_mutex);
+        host->hosted_pending.push_back(hosted);
+    }
+    uv_async_send(host->hosted_async);
+    return hosted;
+}
+
+void NodeInstance::DisposeHosted(HostedProcess* hosted) {
+    delete hosted;
+}
+
+void NodeInstance::KeepHostedAlive(JSContext* context, uv_async_t* handle) {
+    Mutex::ScopedLock lock(hosts_mutex);
+    auto it = hosted_contexts.find(context);
+    if (it == hosted_contexts.end()) return;
+
+    HostedProcess *hosted = it->second;
+    Mutex::ScopedLock hosted_lock(hosted->host->hosted_mutex);
+    if (!hosted->exiting) {
+        handle->data = hosted;
+        hosted->keep_alive.insert(handle);
+    }
+}
+
+void NodeInstance::LetHostedDie(uv_async_t* handle) {
+    HostedProcess *hosted = reinterpret_cast<HostedProcess*>(handle->data);
+    if (hosted) {
+        Mutex::ScopedLock lock(hosted->host->hosted_mutex);
+        hosted->keep_alive.erase(handle);
+        handle->data = nullptr;
+    }
+}
+
+void NodeInstance::StartHosted(HostedProcess* hosted, Isolate* isolate, ContextGroup* group,
+                               NodeInstanceData* instance_data) {
+    HandleScope handle_scope(isolate);
+
+    JSGlobalContextRef ctxRef = nullptr;
+    {
+        JSClassDefinition definition = kJSClassDefinitionEmpty;
+        definition.attributes |= kJSClassAttributeNoAutomaticPrototype;
+        JSClassRef globalClass = JSClassCreate(&definition);
+        ctxRef = JSGlobalContextCreateInGroup(group, globalClass);
+        JSClassRelease(globalClass);
+    }
+
+    JSContext *java_node_context = const_cast<JSContext*>(ctxRef->Context());
+    java_node_context->retain();
+    Local<Context> context = java_node_context->Value();
+
+    Environment* env = CreateEnvironment(isolate, context, instance_data);
+    Context::Scope context_scope(context);
+
+    hosted->env = env;
+    hosted->java_node_context = java_node_context;
+    hosted->ctxRef = ctxRef;
+    {
+        Mutex::ScopedLock lock(hosts_mutex);
+        hosted_map[env] = hosted;
+        hosted_contexts[java_node_context] = hosted;
+    }
+    hosted_processes.push_back(hosted);
+
+    ContextGroup::Mutex()->lock();
+    OverrideProcessMethods(env);
+    {
+        Environment::AsyncCallbackScope callback_scope(env);
+        LoadEnvironment(env);
+    }
+    ContextGroup::Mutex()->unlock();
+
+    java_node_context->retain();
+    bool notified = CallJava(m_jvm, hosted->m_JavaThis, "onNodeStarted", "(JJJ)V",
+        reinterpret_cast<jlong>(java_node_context), reinterpret_cast<jlong>(group),
+        reinterpret_cast<jlong>(ctxRef));
+    CHECK(notified);
+}
+
+// A hosted process has work left as long as one of its handles is referenced, one of its
+// requests is pending, it has immediates queued or Java is keeping it alive.
+bool NodeInstance::HasWork(HostedProcess* hosted) {
+    Environment *env = hosted->env;
+    for (HandleWrap *wrap : *env->handle_wrap_queue()) {
+        if (HandleWrap::HasRef(wrap)) return true;
+    }
+    if (!env->req_wrap_queue()->IsEmpty()) return true;
+    if (uv_is_active(reinterpret_cast<uv_handle_t*>(env->immediate_idle_handle()))) return true;
+
+    Mutex::ScopedLock lock(hosted_mutex);
+    return !hosted->keep_alive.empty();
+}
+
+bool NodeInstance::IsDrained(HostedProcess* hosted) {
+    return hosted->env->handle_wrap_queue()->IsEmpty() &&
+        hosted->env->req_wrap_queue()->IsEmpty();
+}
+
+// Called from the loop's prepare phase.  Closes whatever an exiting process opened since,
+// and returns true if there is a hosted process to start, exit or tear down.
+bool NodeInstance::HostedNeedAttention() {
+    {
+        Mutex::ScopedLock lock(hosted_mutex);
+        if (!hosted_pending.empty()) return true;
+    }
+    bool attention = false;
+    for (HostedProcess *hp : hosted_processes) {
+        if (hp->exiting) {
+            for (HandleWrap *wrap : *hp->env->handle_wrap_queue()) {
+                HandleWrap::Close(wrap);
+            }
+            attention = attention || IsDrained(hp);
+        } else {
+            attention = attention || !HasWork(hp);
+        }
+    }
+    return attention;
+}
+
+// Called in between runs of the loop, outside of any callback.
+void NodeInstance::RunHosted(Isolate* isolate, ContextGroup* group,
+                             NodeInstanceData* instance_data) {
+    std::deque<HostedProcess*> pending;
+    {
+        Mutex::ScopedLock lock(hosted_mutex);
+        pending.swap(hosted_pending);
+    }
+    for (HostedProcess *hp : pending) {
+        StartHosted(hp, isolate, group, instance_data);
+    }
+
+    for (auto it = hosted_processes.begin(); it != hosted_processes.end(); ) {
+        HostedProcess *hp = *it++;
+        if (!hp->exiting && !HasWork(hp)) {
+            PumpMessageLoop(isolate);
+            EmitBeforeExit(hp->env);
+            if (!HasWork(hp)) {
+                hp->exit_code = EmitExit(hp->env);
+                StopHosted(hp);
+            }
+        }
+        if (hp->exiting && IsDrained(hp)) {
+            TearDownHosted(hp);
+        }
+    }
+}
+
+// Marks 'hosted' as exiting and closes its handles.  Its JavaScript code no longer runs once
+// the callback it is in returns.
+void NodeInstance::StopHosted(HostedProcess* hosted) {
+    hosted->exiting = true;
+
+    Environment *env = hosted->env;
+    for (HandleWrap *wrap : *env->handle_wrap_queue()) {
+        HandleWrap::Close(wrap);
+    }
+    uv_idle_stop(env->immediate_idle_handle());
+    uv_check_stop(env->immediate_check_handle());
+
+    Mutex::ScopedLock lock(hosted_mutex);
+    for (uv_async_t *handle : hosted->keep_alive) {
+        uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+        handle->data = nullptr;
+    }
+    hosted->keep_alive.clear();
+}
+
+void NodeInstance::TearDownHosted(HostedProcess* hosted) {
+    Environment *env = hosted->env;
+    HandleScope handle_scope(env->isolate());
+
+    // Closes the environment's own handles, running the loop until they are done
+    env->CleanupHandles();
+
+    {
+        Mutex::ScopedLock lock(hosts_mutex);
+        hosted_map.erase(env);
+        hosted_contexts.erase(hosted->java_node_context);
+    }
+    hosted_processes.remove(hosted);
+
+    ContextGroup::Mutex()->lock();
+    JSGlobalContextRelease(hosted->ctxRef);
+    hosted->java_node_context->SetDefunct();
+    hosted->java_node_context->release();
+    nodedroid::DisposeFs(env);
+    env->Dispose();
+    ContextGroup::Mutex()->unlock();
+
+    hosted->env = nullptr;
+    hosted->java_node_context = nullptr;
+    hosted->ctxRef = nullptr;
+
+    NotifyHostedExit(hosted);
+}
+
+// Java disposes of 'hosted' as soon as it hears about the exit, possibly before
+// onNodeExit() even returns, so 'hosted' must not be touched after the call.
+void NodeInstance::NotifyHostedExit(HostedProcess* hosted) {
+    jobject java_this = hosted->m_JavaThis;
+    hosted->m_JavaThis = nullptr;
+    CallJava(m_jvm, java_this, "onNodeExit", "(J)V", (jlong) hosted->exit_code);
+    DeleteGlobalRef(m_jvm, java_this);
+}
+
+// The host is exiting: takes all of its hosted processes down with it.  Those that never
+// got started exit with kHostExitedExitCode.
+void NodeInstance::ShutDownHosted(Isolate* isolate, ContextGroup* group,
+                                  NodeInstanceData* instance_data) {
+    std::deque<HostedProcess*> pending;
+    {
+        Mutex::ScopedLock lock(hosts_mutex);
+        hosts.erase(this);
+        Mutex::ScopedLock hosted_lock(hosted_mutex);
+        pending.swap(hosted_pending);
+    }
+    for (HostedProcess *hp : pending) {
+        hp->exit_code = kHostExitedExitCode;
+        NotifyHostedExit(hp);
+    }
+
+    for (HostedProcess *hp : hosted_processes) {
+        if (!hp->exiting) {
+            PumpMessageLoop(isolate);
+            hp->exit_code = EmitExit(hp->env);
+            StopHosted(hp);
+        }
+    }
+    uv_loop_t *loop = instance_data->event_loop();
+    while (!hosted_processes.empty()) {
+        HostedProcess *hp = hosted_processes.front();
+        if (IsDrained(hp)) {
+            TearDownHosted(hp);
+        } else {
+            uv_run(loop, UV_RUN_ONCE);
+        }
+    }
+
+    if (hosted_async) {
+        uv_close(reinterpret_cast<uv_handle_t*>(hosted_async), [](uv_handle_t* h) {
+            delete reinterpret_cast<uv_async_t*>(h);
+        });
+        uv_close(reinterpret_cast<uv_handle_t*>(hosted_prepare), [](uv_handle_t* h) {
+            delete reinterpret_cast<uv_prepare_t*>(h);
+        });
+        hosted_async = nullptr;
+        hosted_prepare = nullptr;
+        uv_run(loop, UV_RUN_NOWAIT);
+    }
+}
+
 // Look up environment variable unless running as setuid root.
 inline const char* secure_getenv(const char* key) {
 #ifndef _WIN32
@@ -595,6 +1090,9 @@ int NodeInstance::Start(int argc, char *argv[]) {
   {
     uv_loop_t uv_loop;
     uv_loop_init(&uv_loop);
+    if (threadpool_size > 0) {
+      uv_loop_configure(&uv_loop, UV_LOOP_THREADPOOL_SIZE, threadpool_size);
+    }
     NodeInstanceData instance_data(NodeInstanceType::MAIN,
                                    &uv_loop,
                                    argc,
@@ -618,12 +1116,36 @@ int NodeInstance::Start(int argc, char *argv[]) {
 #undef PARAMS
 #define PARAMS JNIEnv* env, jobject thiz
 
-NATIVE(Process,jlong,start) (PARAMS)
+NATIVE(Process,jlong,start) (PARAMS, jint threadPoolSize, jint maxHeapMB)
 {
-    NodeInstance *instance = new NodeInstance(env, thiz);
+    NodeInstance *instance = NodeInstance::Claim(env, thiz,
+        threadPoolSize < 0 ? 0 : (unsigned int) threadPoolSize,
+        maxHeapMB < 0 ? 0 : (size_t) maxHeapMB);
     return reinterpret_cast<jlong>(instance);
 }
 
+NATIVE(Process,jlong,startHosted) (PARAMS, jlong hostRef)
+{
+    HostedProcess *hosted = NodeInstance::Host(env, thiz,
+        reinterpret_cast<NodeInstance*>(hostRef));
+    return reinterpret_cast<jlong>(hosted);
+}
+
+NATIVE(Process,void,disposeHosted) (PARAMS, jlong ref)
+{
+    NodeInstance::DisposeHosted(reinterpret_cast<HostedProcess*>(ref));
+}
+
+NATIVE(Process,void,setPoolSize) (PARAMS, jint size)
+{
+    NodeInstance::SetPoolSize(env, size < 0 ? 0 : (size_t) size);
+}
+
+NATIVE(Process,void,trimPool) (PARAMS)
+{
+    NodeInstance::TrimPool();
+}
+
 NATIVE(Process,void,dispose) (PARAMS, jlong ref)
 {
     delete reinterpret_cast<NodeInstance*>(ref);
@@ -632,6 +1154,7 @@ NATIVE(Process,void,dispose) (PARAMS, jlong ref)
 NATIVE(Process,long,keepAlive) (PARAMS, jlong contextRef)
 {
     auto done = [](uv_async_t* handle) {
+        NodeInstance::LetHostedDie(handle);
         uv_close((uv_handle_t*)handle, [](uv_handle_t *h){
             delete (uv_async_t*)h;
         });
@@ -641,6 +1164,8 @@ NATIVE(Process,long,keepAlive) (PARAMS, jlong contextRef)
     ContextGroup *group = context->Group();
     uv_async_t *async_handle = new uv_async_t();
     uv_async_init(group->Loop(), async_handle, done);
+    async_handle->data = nullptr;
+    NodeInstance::KeepHostedAlive(context, async_handle);
     return reinterpret_cast<jlong>(async_handle);
 }
 
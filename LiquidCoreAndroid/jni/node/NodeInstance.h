@@ -44,6 +44,9 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include <map>
+#include <deque>
+#include <list>
+#include <set>
 
 #include "node.h"
 #include "uv.h"
@@ -58,13 +61,60 @@
 
 using namespace node;
 
+class OpaqueJSContext;
+class NodeInstance;
+
+// A process hosted by a NodeInstance.  Touched only on the host's thread, except where noted.
+struct HostedProcess {
+    NodeInstance *host;
+    jobject m_JavaThis;
+    Environment *env = nullptr;
+    JSContext *java_node_context = nullptr;
+    OpaqueJSContext *ctxRef = nullptr;
+    bool exiting = false;
+    int exit_code = 0;
+    std::set<uv_async_t*> keep_alive;   // guarded by the host's hosted_mutex
+};
+
 class NodeInstance {
 public:
-    NodeInstance(JNIEnv* env, jobject thiz);
+    // threadpool_size > 0 gives the instance's event loop a libuv thread pool of its own,
+    // 0 shares the process-wide one.  max_heap_mb > 0 limits the size of the instance's
+    // heap; the instance exits with kHeapLimitExitCode when it is nearly full.
+    NodeInstance(JNIEnv* env, jobject thiz, unsigned int threadpool_size = 0,
+                 size_t max_heap_mb = 0);
     NodeInstance();
     virtual ~NodeInstance();
 
+    // Instance pool.  Parked instances are fully bootstrapped and wait, before entering
+    // their event loop, until a Process claims them.
+    static NodeInstance* Claim(JNIEnv* env, jobject thiz, unsigned int threadpool_size,
+                               size_t max_heap_mb);
+    static void SetPoolSize(JNIEnv* env, size_t size);
+    static void TrimPool();
+    static size_t TrimCaches(bool all);
+
+    // Must match Process.kHeapLimitExceeded
+    static const int kHeapLimitExitCode = -223;
+    // Must match Process.kHostExited
+    static const int kHostExitedExitCode = -224;
+
+    // Hosting.  A hosted process has a context, node environment and file system of its own,
+    // but shares the isolate, event loop and thread of its host, and with that the memory
+    // taken by the node core.  It exits when it has nothing left to do, when it calls
+    // process.exit() or when its host exits.  Host() returns nullptr if 'host' has exited.
+    static HostedProcess* Host(JNIEnv* env, jobject thiz, NodeInstance* host);
+    static void DisposeHosted(HostedProcess* hosted);
+    // Keeps a hosted process alive for as long as 'handle' is open
+    static void KeepHostedAlive(JSContext* context, uv_async_t* handle);
+    static void LetHostedDie(uv_async_t* handle);
+
 private:
+    NodeInstance(JavaVM* jvm);
+    bool Park();
+    static void FillPool(JavaVM* jvm);
+    static void DrainPool(size_t size);
+
     Environment* CreateEnvironment(Isolate* isolate,
                                    Local<Context> context,
                                    NodeInstanceData* instance_data);
@@ -90,8 +140,32 @@ private:
     static void Abort(const FunctionCallbackInfo<Value>& args);
     static void Kill(const FunctionCallbackInfo<Value>& args);
     static void OnFatalError(const char* location, const char* message);
+    static void Stop(Environment* env);
+    static void OverrideProcessMethods(Environment* env);
+    static bool CallJava(JavaVM* jvm, jobject thiz, const char* method, const char* sig, ...);
+    static void DeleteGlobalRef(JavaVM* jvm, jobject ref);
+
+    void StartHosted(HostedProcess* hosted, Isolate* isolate, ContextGroup* group,
+                     NodeInstanceData* instance_data);
+    void RunHosted(Isolate* isolate, ContextGroup* group, NodeInstanceData* instance_data);
+    void StopHosted(HostedProcess* hosted);
+    void TearDownHosted(HostedProcess* hosted);
+    void NotifyHostedExit(HostedProcess* hosted);
+    void ShutDownHosted(Isolate* isolate, ContextGroup* group, NodeInstanceData* instance_data);
+    bool HostedNeedAttention();
+    bool HasWork(HostedProcess* hosted);
+    static bool IsDrained(HostedProcess* hosted);
 
     static std::map<Environment*,NodeInstance*> instance_map;
+    static std::map<Environment*,HostedProcess*> hosted_map;
+    static std::map<JSContext*,HostedProcess*> hosted_contexts;
+
+    static Mutex hosts_mutex;
+    static std::set<NodeInstance*> hosts;
+
+    static Mutex pool_mutex;
+    static std::deque<NodeInstance*> pool;
+    static size_t pool_size;
 
 private:
     Mutex node_isolate_mutex;
@@ -103,12 +177,24 @@ private:
     bool use_debug_agent = false;
     bool didExit = false;
     int  exit_code = 0;
+    unsigned int threadpool_size = 0;
+    size_t max_heap_mb = 0;
     std::string node_modules_dir;
 
     JavaVM *m_jvm = nullptr;
     jobject m_JavaThis = nullptr;
 
     std::thread* node_main_thread = nullptr;
+
+    bool parked = false;
+    bool discarded = false;
+    ConditionVariable park_cond;
+
+    Mutex hosted_mutex;
+    std::deque<HostedProcess*> hosted_pending;
+    std::list<HostedProcess*> hosted_processes;
+    uv_async_t* hosted_async = nullptr;
+    uv_prepare_t* hosted_prepare = nullptr;
 };
 
 #endif //NODEDROID_NODEINSTANCE_H
@@ -36,17 +36,21 @@
 #include "node_buffer.h"
 #include "node_internals.h"
 #include "node_stat_watcher.h"
+#include "node_code_cache.h"
+#include "node_mutex.h"
 
 #include "env.h"
 #include "env-inl.h"
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
 #include "string_bytes.h"
+#include "string_bytes_simd.h"
 #include "util.h"
 
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
@@ -62,6 +66,9 @@
 # include <io.h>
 #endif
 
+#include <atomic>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <android/log.h>
 
@@ -80,7 +87,10 @@ using v8::Integer;
 using v8::Local;
 using v8::Number;
 using v8::Object;
+using v8::Script;
+using v8::ScriptOrigin;
 using v8::String;
+using v8::TryCatch;
 using v8::Value;
 using v8::Maybe;
 using v8::MaybeLocal;
@@ -193,10 +203,107 @@ static inline bool IsInt64(double x) {
   return x == static_cast<double>(static_cast<int64_t>(x));
 }
 
+// Module resolution cache.
+//
+// Resolving a require() stats and realpaths every candidate path and reads
+// the package.json of every candidate directory, and each of those goes
+// through fs_().  The results are cached per instance, keyed by the path as
+// the instance sees it, and all caches are dropped whenever any instance in
+// the process changes the file system through this binding.  Changes made
+// behind its back, e.g. from Java, are not seen, same as with the caches in
+// lib/module.js.
+static std::atomic<unsigned int> fs_generation(0);
+
+class ResolveCache {
+ public:
+  struct Counter {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t miss_time = 0;  // ns spent on misses
+  };
+
+  // Drops everything if the file system changed since the last call and
+  // returns the generation results computed from now on belong to.
+  unsigned int Sync() {
+    const unsigned int generation = fs_generation.load();
+    if (generation != generation_) {
+      stats.clear();
+      realpaths.clear();
+      package_mains.clear();
+      generation_ = generation;
+    }
+    return generation;
+  }
+
+  // Stores |value| unless the file system changed while it was computed.
+  template <typename T>
+  static void Store(std::unordered_map<std::string, T>* map,
+                    unsigned int generation,
+                    const std::string& key,
+                    const T& value) {
+    if (generation == fs_generation.load())
+      (*map)[key] = value;
+  }
+
+  std::unordered_map<std::string, int> stats;
+  std::unordered_map<std::string, std::string> realpaths;
+  std::unordered_map<std::string, std::string> package_mains;
+
+  Counter stat;
+  Counter realpath;
+  Counter package_main;
+
+ private:
+  unsigned int generation_ = 0;
+};
+
+static node::Mutex resolve_caches_mutex;
+static std::unordered_map<Environment*, ResolveCache> resolve_caches;
+
+static ResolveCache* GetResolveCache(Environment* env) {
+  node::Mutex::ScopedLock lock(resolve_caches_mutex);
+  return &resolve_caches[env];
+}
+
+void DisposeFs(Environment* env) {
+  node::Mutex::ScopedLock lock(resolve_caches_mutex);
+  resolve_caches.erase(env);
+}
+
+// Drops the module resolution caches of all instances, each the next time it
+// is used.
+void TrimFs() {
+  fs_generation++;
+}
+
+// Called with every completed request, sync or async.
+static void InvalidateResolveCaches(const uv_fs_t* req) {
+  switch (req->fs_type) {
+    case UV_FS_OPEN:
+      if (!(req->flags & (O_CREAT | O_TRUNC)))
+        return;
+      break;
+    case UV_FS_WRITE:
+    case UV_FS_FTRUNCATE:
+    case UV_FS_UNLINK:
+    case UV_FS_RMDIR:
+    case UV_FS_MKDIR:
+    case UV_FS_MKDTEMP:
+    case UV_FS_RENAME:
+    case UV_FS_LINK:
+    case UV_FS_SYMLINK:
+      break;
+    default:
+      return;
+  }
+  fs_generation++;
+}
+
 static void After(uv_fs_t *req) {
   FSReqWrap* req_wrap = static_cast<FSReqWrap*>(req->data);
   CHECK_EQ(req_wrap->req(), req);
   req_wrap->ReleaseEarly();  // Free memory that's no longer used now.
+  InvalidateResolveCaches(req);
 
   Environment* env = req_wrap->env();
   HandleScope handle_scope(env->isolate());
@@ -428,6 +535,7 @@ class fs_req_wrap {
                          &req_wrap.req,                                       \
                          __VA_ARGS__,                                         \
                          nullptr);                                            \
+  InvalidateResolveCaches(&req_wrap.req);                                     \
   if (err < 0) {                                                              \
     return env->ThrowUVException(err, #func, nullptr, path, dest);            \
   }                                                                           \
@@ -769,6 +877,166 @@ void FillStatsArray(double* fields, const uv_stat_t* s) {
 #undef X
 }
 
+// The contents of a module file, handed to V8 as the backing store of an
+// external string: either a read-only mapping of the file, or a copy of it on
+// the heap.  Released when the string is collected.
+class ModuleFileContents : public String::ExternalOneByteStringResource {
+ public:
+  ModuleFileContents(char* data, size_t size, size_t start, bool mapped)
+      : data_(data), size_(size), start_(start), mapped_(mapped) {}
+  ~ModuleFileContents() override {
+    if (mapped_)
+      munmap(data_, size_);
+    else
+      free(data_);
+  }
+
+  const char* data() const override { return data_ + start_; }
+  size_t length() const override { return size_ - start_; }
+
+ private:
+  char* const data_;
+  const size_t size_;
+  const size_t start_;
+  const bool mapped_;
+
+  DISALLOW_COPY_AND_ASSIGN(ModuleFileContents);
+};
+
+// Smaller files, which is most package.json files, are cheaper to copy into
+// the V8 heap than to hand over as external strings.
+static const size_t kMinExternalModuleFileSize = 16 << 10;
+
+// Returns the contents of the module file |fd|, described by |s|, without
+// the UTF-8 BOM and, if |skip_shebang|, without the shebang line (but with
+// the line break after it, as Module.prototype._compile() does).  Large
+// ASCII files are not copied into the V8 heap: the string is backed by a
+// mapping of the file, or by a copy of it when the file can be written to.
+// Returns an empty handle if the file cannot be read.
+static MaybeLocal<String> ReadModuleFile(Environment* env,
+                                         uv_file fd,
+                                         const uv_stat_t& s,
+                                         bool skip_shebang) {
+  size_t size = static_cast<size_t>(s.st_size);
+  const bool external = size >= kMinExternalModuleFileSize;
+  char* data = nullptr;
+  bool mapped = false;
+  MaybeStackBuffer<char, 1024> buffer;
+
+  // V8 reads an external string whenever it likes, long after this returns,
+  // and a mapped file that has been truncated by then faults with SIGBUS.
+  // So only files that nobody may write to are mapped, and only if they are
+  // still as long as they were when they were opened.
+  if (external && (s.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) == 0) {
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      uv_fs_t stat_req;
+      const int err = uv_fs_fstat(env->event_loop(), &stat_req, fd, nullptr);
+      const bool truncated = err < 0 ||
+          static_cast<size_t>(stat_req.statbuf.st_size) < size;
+      uv_fs_req_cleanup(&stat_req);
+      if (truncated) {
+        munmap(map, size);
+      } else {
+        data = static_cast<char*>(map);
+        mapped = true;
+      }
+    }
+  }
+
+  if (!mapped && size > 0) {
+    if (external) {
+      data = static_cast<char*>(node::Malloc(size));
+    } else {
+      buffer.AllocateSufficientStorage(size);
+      data = *buffer;
+    }
+    size_t offset = 0;
+    while (offset < size) {
+      uv_buf_t buf = uv_buf_init(data + offset, size - offset);
+      uv_fs_t read_req;
+      const ssize_t numchars = uv_fs_read(env->event_loop(), &read_req, fd,
+                                          &buf, 1, offset, nullptr);
+      uv_fs_req_cleanup(&read_req);
+      if (numchars < 0) {
+        if (external)
+          free(data);
+        return MaybeLocal<String>();
+      }
+      if (numchars == 0) {
+        break;  // Truncated since we looked at its size.
+      }
+      offset += numchars;
+    }
+    size = offset;
+  }
+
+  const char* chars = data != nullptr ? data : "";
+  size_t start = 0;
+  if (size >= 3 && 0 == memcmp(chars, "\xEF\xBB\xBF", 3)) {
+    start = 3;  // Skip UTF-8 BOM.
+  }
+  if (skip_shebang && size - start >= 2 &&
+      chars[start] == '#' && chars[start + 1] == '!') {
+    start += 2;
+    while (start < size && chars[start] != '\n' && chars[start] != '\r')
+      start++;
+  }
+
+  if (external) {
+    if (node::simd::IsAscii(chars + start, size - start)) {
+      return String::NewExternalOneByte(
+          env->isolate(), new ModuleFileContents(data, size, start, mapped));
+    }
+    // Not ASCII, so not Latin-1 as far as V8 is concerned; decode a copy.
+    MaybeLocal<String> string =
+        String::NewFromUtf8(env->isolate(),
+                            chars + start,
+                            v8::NewStringType::kNormal,
+                            size - start);
+    if (mapped)
+      munmap(data, static_cast<size_t>(s.st_size));
+    else
+      free(data);
+    return string;
+  }
+
+  return String::NewFromUtf8(env->isolate(),
+                             chars + start,
+                             v8::NewStringType::kNormal,
+                             size - start);
+}
+
+// Opens the module file at the mapped path |path| and returns its fd, or a
+// negative value if it cannot be opened or is not a regular file.
+static uv_file OpenModuleFile(uv_loop_t* loop,
+                              const char* path,
+                              uv_stat_t* s) {
+  uv_fs_t open_req;
+  const int fd = uv_fs_open(loop, &open_req, path, O_RDONLY, 0, nullptr);
+  uv_fs_req_cleanup(&open_req);
+
+  if (fd < 0) {
+    return fd;
+  }
+
+  uv_fs_t stat_req;
+  int err = uv_fs_fstat(loop, &stat_req, fd, nullptr);
+  *s = stat_req.statbuf;
+  uv_fs_req_cleanup(&stat_req);
+
+  if (err == 0 && !S_ISREG(s->st_mode)) {
+    err = UV_EISDIR;
+  }
+  if (err < 0) {
+    uv_fs_t close_req;
+    CHECK_EQ(0, uv_fs_close(loop, &close_req, fd, nullptr));
+    uv_fs_req_cleanup(&close_req);
+    return err;
+  }
+  return fd;
+}
+
 // Used to speed up module loading.  Returns the contents of the file as
 // a string or undefined when the file cannot be opened.  The speedup
 // comes from not creating Error objects on failure.
@@ -779,55 +1047,86 @@ static void InternalModuleReadFile(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsString());
   node::Utf8Value path(env->isolate(),  fs_(env, args[0], _FS_ACCESS_NONE));
 
-  uv_fs_t open_req;
-  const int fd = uv_fs_open(loop, &open_req, *path, O_RDONLY, 0, nullptr);
-  uv_fs_req_cleanup(&open_req);
-
+  uv_stat_t s;
+  const int fd = OpenModuleFile(loop, *path, &s);
   if (fd < 0) {
     return;
   }
 
-  std::vector<char> chars;
-  int64_t offset = 0;
-  for (;;) {
-    const size_t kBlockSize = 32 << 10;
-    const size_t start = chars.size();
-    chars.resize(start + kBlockSize);
+  Local<String> chars_string;
+  bool read = ReadModuleFile(env, fd, s, false)
+      .ToLocal(&chars_string);
+
+  uv_fs_t close_req;
+  CHECK_EQ(0, uv_fs_close(loop, &close_req, fd, nullptr));
+  uv_fs_req_cleanup(&close_req);
+
+  if (read) {
+    args.GetReturnValue().Set(chars_string);
+  }
+}
+
+// Used by the module loader in place of reading and compiling a .js file
+// itself.  Returns the compiled module wrapper, built from the file and the
+// wrapper head and tail passed in, or undefined when the file cannot be
+// opened or does not compile, in which case the loader falls back to its
+// own path to report the error.  Sources and code caches are shared by all
+// the instances in the process; see node_code_cache.h.
+static void InternalModuleCompile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  uv_loop_t* loop = env->event_loop();
 
-    uv_buf_t buf;
-    buf.base = &chars[start];
-    buf.len = kBlockSize;
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsString());
+  Local<Value> mapped = fs_(env, args[0], _FS_ACCESS_RD);
+  if (mapped->IsUndefined()) {
+    return;
+  }
+  node::Utf8Value path(env->isolate(), mapped);
 
-    uv_fs_t read_req;
-    const ssize_t numchars =
-        uv_fs_read(loop, &read_req, fd, &buf, 1, offset, nullptr);
-    uv_fs_req_cleanup(&read_req);
+  uv_stat_t s;
+  const int fd = OpenModuleFile(loop, *path, &s);
+  if (fd < 0) {
+    return;
+  }
 
-    CHECK_GE(numchars, 0);
-    if (static_cast<size_t>(numchars) < kBlockSize) {
-      chars.resize(start + numchars);
+  std::ostringstream version;
+  version << s.st_size << ':' << s.st_mtim.tv_sec << '.' << s.st_mtim.tv_nsec;
+
+  Local<String> source;
+  bool read = node::code_cache::GetModuleSource(env->isolate(), *path,
+                                                version.str())
+      .ToLocal(&source);
+  if (!read) {
+    Local<String> content;
+    read = ReadModuleFile(env, fd, s, true)
+        .ToLocal(&content);
+    if (read) {
+      source = String::Concat(args[1].As<String>(),
+                              String::Concat(content, args[2].As<String>()));
+      node::code_cache::SetModuleSource(*path, version.str(), source);
     }
-    if (numchars == 0) {
-      break;
-    }
-    offset += numchars;
   }
 
   uv_fs_t close_req;
   CHECK_EQ(0, uv_fs_close(loop, &close_req, fd, nullptr));
   uv_fs_req_cleanup(&close_req);
 
-  size_t start = 0;
-  if (chars.size() >= 3 && 0 == memcmp(&chars[0], "\xEF\xBB\xBF", 3)) {
-    start = 3;  // Skip UTF-8 BOM.
+  if (!read) {
+    return;
   }
 
-  Local<String> chars_string =
-      String::NewFromUtf8(env->isolate(),
-                          &chars[start],
-                          String::kNormalString,
-                          chars.size() - start);
-  args.GetReturnValue().Set(chars_string);
+  TryCatch try_catch(env->isolate());
+  ScriptOrigin origin(args[0].As<String>());
+  Local<Script> script;
+  Local<Value> compiled;
+  if (!node::code_cache::CompileModule(env, *path, version.str(), source,
+                                       &origin).ToLocal(&script) ||
+      !script->Run(env->context()).ToLocal(&compiled)) {
+    return;
+  }
+  args.GetReturnValue().Set(compiled);
 }
 
 // Used to speed up module loading.  Returns 0 if the path refers to
@@ -837,6 +1136,16 @@ static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   CHECK(args[0]->IsString());
+  ResolveCache* cache = GetResolveCache(env);
+  const unsigned int generation = cache->Sync();
+  const std::string key = *node::Utf8Value(env->isolate(), args[0]);
+  auto it = cache->stats.find(key);
+  if (it != cache->stats.end()) {
+    cache->stat.hits++;
+    return args.GetReturnValue().Set(it->second);
+  }
+
+  const uint64_t start = uv_hrtime();
   node::Utf8Value path(env->isolate(),  fs_(env, args[0], _FS_ACCESS_NONE));
 
   uv_fs_t req;
@@ -847,9 +1156,191 @@ static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
   }
   uv_fs_req_cleanup(&req);
 
+  ResolveCache::Store(&cache->stats, generation, key, rc);
+  cache->stat.misses++;
+  cache->stat.miss_time += uv_hrtime() - start;
+
+  args.GetReturnValue().Set(rc);
+}
+
+// Used to speed up module loading.  Returns the real path of a module file,
+// as the instance sees it, or undefined if it cannot be resolved, in which
+// case the loader falls back to fs.realpathSync() to report the error.
+static void InternalModuleRealpath(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  ResolveCache* cache = GetResolveCache(env);
+  const unsigned int generation = cache->Sync();
+  const std::string key = *node::Utf8Value(env->isolate(), args[0]);
+  auto it = cache->realpaths.find(key);
+  if (it != cache->realpaths.end()) {
+    cache->realpath.hits++;
+    return args.GetReturnValue().Set(
+        String::NewFromUtf8(env->isolate(),
+                            it->second.data(),
+                            String::kNormalString,
+                            it->second.size()));
+  }
+
+  const uint64_t start = uv_hrtime();
+  Local<Value> mapped = fs_(env, args[0], _FS_ACCESS_RD);
+  if (mapped->IsUndefined()) {
+    return;
+  }
+  node::Utf8Value path(env->isolate(), mapped);
+
+  uv_fs_t req;
+  int err = uv_fs_realpath(env->event_loop(), &req, *path, nullptr);
+  Local<Value> rc;
+  if (err == 0) {
+    rc = StringBytes::Encode(env->isolate(),
+                             static_cast<const char*>(req.ptr),
+                             UTF8);
+  }
+  uv_fs_req_cleanup(&req);
+  if (rc.IsEmpty()) {
+    return;
+  }
+  rc = alias_(env, rc);
+  if (!rc->IsString()) {
+    return;
+  }
+
+  ResolveCache::Store(&cache->realpaths, generation, key,
+                      std::string(*node::Utf8Value(env->isolate(), rc)));
+  cache->realpath.misses++;
+  cache->realpath.miss_time += uv_hrtime() - start;
+
   args.GetReturnValue().Set(rc);
 }
 
+// Used to speed up module loading.  Returns the "main" field of the
+// package.json file at the given path, or undefined if there is no such
+// file or it has no main.  Throws if the file is not valid JSON.
+static void InternalModulePackageMain(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  uv_loop_t* loop = env->event_loop();
+
+  CHECK(args[0]->IsString());
+  ResolveCache* cache = GetResolveCache(env);
+  const unsigned int generation = cache->Sync();
+  const std::string key = *node::Utf8Value(env->isolate(), args[0]);
+  auto it = cache->package_mains.find(key);
+  if (it != cache->package_mains.end()) {
+    cache->package_main.hits++;
+    if (!it->second.empty()) {
+      args.GetReturnValue().Set(
+          String::NewFromUtf8(env->isolate(),
+                              it->second.data(),
+                              String::kNormalString,
+                              it->second.size()));
+    }
+    return;
+  }
+
+  const uint64_t start = uv_hrtime();
+  node::Utf8Value path(env->isolate(),  fs_(env, args[0], _FS_ACCESS_NONE));
+
+  // An empty main is cached for a missing file or a missing main alike; the
+  // loader treats them the same.
+  std::string main;
+  uv_stat_t s;
+  const int fd = OpenModuleFile(loop, *path, &s);
+  if (fd >= 0) {
+    Local<String> json;
+    bool read = ReadModuleFile(env, fd, s, false)
+        .ToLocal(&json);
+
+    uv_fs_t close_req;
+    CHECK_EQ(0, uv_fs_close(loop, &close_req, fd, nullptr));
+    uv_fs_req_cleanup(&close_req);
+
+    if (!read) {
+      return;
+    }
+
+    Local<Value> pkg;
+    if (!v8::JSON::Parse(env->isolate(), json).ToLocal(&pkg)) {
+      return;
+    }
+    if (pkg->IsNull()) {
+      return env->ThrowTypeError("Cannot read property 'main' of null");
+    }
+    Local<Value> value = Undefined(env->isolate());
+    if (pkg->IsObject() &&
+        !pkg.As<Object>()->Get(env->context(),
+                               FIXED_ONE_BYTE_STRING(env->isolate(), "main"))
+            .ToLocal(&value)) {
+      return;
+    }
+    if (!value->IsString() && value->BooleanValue()) {
+      // Not something the loader can resolve; let it fail the usual way.
+      return args.GetReturnValue().Set(value);
+    }
+    if (value->IsString()) {
+      main = *node::Utf8Value(env->isolate(), value);
+    }
+  }
+
+  ResolveCache::Store(&cache->package_mains, generation, key, main);
+  cache->package_main.misses++;
+  cache->package_main.miss_time += uv_hrtime() - start;
+
+  if (!main.empty()) {
+    args.GetReturnValue().Set(
+        String::NewFromUtf8(env->isolate(),
+                            main.data(),
+                            String::kNormalString,
+                            main.size()));
+  }
+}
+
+static Local<Object> ResolveCacheCounterObject(Environment* env,
+                                               const ResolveCache::Counter& c,
+                                               double* saved) {
+  Local<Object> counter = Object::New(env->isolate());
+  // Each hit saves about as much as the average miss costs.
+  const double saved_ms = c.misses == 0 ? 0 :
+      static_cast<double>(c.miss_time) / c.misses * c.hits / 1e6;
+  *saved += saved_ms;
+  counter->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "hits"),
+               Number::New(env->isolate(), c.hits));
+  counter->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "misses"),
+               Number::New(env->isolate(), c.misses));
+  counter->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "savedMs"),
+               Number::New(env->isolate(), saved_ms));
+  return counter;
+}
+
+// Returns the module resolution cache statistics of this instance:
+// { stat, realpath, packageMain, hitRatio, savedMs }, where each of the
+// first three is { hits, misses, savedMs }.
+static void InternalModuleCacheStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ResolveCache* cache = GetResolveCache(env);
+
+  double saved = 0;
+  Local<Object> stats = Object::New(env->isolate());
+  stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "stat"),
+             ResolveCacheCounterObject(env, cache->stat, &saved));
+  stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "realpath"),
+             ResolveCacheCounterObject(env, cache->realpath, &saved));
+  stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "packageMain"),
+             ResolveCacheCounterObject(env, cache->package_main, &saved));
+
+  const uint64_t hits =
+      cache->stat.hits + cache->realpath.hits + cache->package_main.hits;
+  const uint64_t lookups = hits +
+      cache->stat.misses + cache->realpath.misses + cache->package_main.misses;
+  const double ratio = lookups == 0 ? 0 : static_cast<double>(hits) / lookups;
+  stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "hitRatio"),
+             Number::New(env->isolate(), ratio));
+  stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "savedMs"),
+             Number::New(env->isolate(), saved));
+  args.GetReturnValue().Set(stats);
+}
+
 static void Stat(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1809,6 +2300,11 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "readdir", ReadDir);
   env->SetMethod(target, "internalModuleReadFile", InternalModuleReadFile);
   env->SetMethod(target, "internalModuleStat", InternalModuleStat);
+  env->SetMethod(target, "internalModuleCompile", InternalModuleCompile);
+  env->SetMethod(target, "internalModuleRealpath", InternalModuleRealpath);
+  env->SetMethod(target, "internalModulePackageMain",
+                 InternalModulePackageMain);
+  env->SetMethod(target, "internalModuleCacheStats", InternalModuleCacheStats);
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
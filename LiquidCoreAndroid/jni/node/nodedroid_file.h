@@ -46,6 +46,8 @@ namespace nodedroid {
 #define _FS_ACCESS_NONE (0)
 
 void InitFs(v8::Local<v8::Object> target);
+void DisposeFs(node::Environment *env);
+void TrimFs();
 v8::Local<v8::Value> alias_(node::Environment *env, v8::Local<v8::Value> path);
 v8::Local<v8::Value> fs_(node::Environment *env, v8::Local<v8::Value> path, int req_access);
 v8::Local<v8::Value> chdir_(node::Environment *env, v8::Local<v8::Value> path);
@@ -316,6 +316,46 @@ public class JSContextTest {
         contextTest2.semaphore.acquire();
     }
 
+    @Test
+    public void testMemoryPressure() throws Exception {
+        JSContextGroup group = new JSContextGroup();
+        JSContext context = new JSContext(group);
+        context.evaluateScript(
+                "var garbage = [];" +
+                "for (var i=0; i<100000; i++) garbage.push({ i: i, s: 'x' + i });" +
+                "garbage = null;");
+
+        long [] reclaimed = JSContextGroup.notifyMemoryPressure(
+                JSContextGroup.kMemoryPressureCritical, 1000);
+        long total = 0;
+        for (long bytes : reclaimed) {
+            if (bytes > 0) total += bytes;
+        }
+        assertTrue(total > 0);
+        assertTrue(group.getGCStatistics().markSweeps > 0);
+        assertEquals(context.evaluateScript("1 + 1").toNumber().intValue(), 2);
+    }
+
+    @Test
+    public void testAllocatorPool() throws Exception {
+        JSContextGroup group = new JSContextGroup();
+        JSContext context = new JSContext(group);
+        context.evaluateScript(
+                "for (var i=0; i<10000; i++) {" +
+                "  var a = new Uint8Array(64 + i % 1024);" +
+                "  for (var j=0; j<a.length; j++) if (a[j] !== 0) throw new Error('not zeroed');" +
+                "  a.fill(0xff);" +
+                "}");
+        JSContextGroup.notifyMemoryPressure(JSContextGroup.kMemoryPressureCritical, 1000);
+        context.evaluateScript("for (var i=0; i<1000; i++) new Float64Array(16);");
+
+        JSContextGroup.AllocatorStatistics stats = group.getAllocatorStatistics();
+        assertTrue(stats.allocations >= 11000);
+        assertTrue(stats.recycled > 0);
+        assertTrue(stats.poolHits > 0);
+        assertTrue(stats.poolCommittedBytes >= stats.poolFreeBytes);
+    }
+
     @org.junit.After
     public void shutDown() {
     }
@@ -216,6 +216,54 @@ public class FSTest {
         Process.uninstall(InstrumentationRegistry.getContext(), "_", Process.UninstallScope.Local);
     }
 
+    @Test
+    public void testModuleResolutionCache() throws Exception {
+        final String script = "" +
+                "var fs = require('fs');" +
+                "process.chdir('./local');" +
+                "try { require('./pkg'); } catch (e) { global.missing = e.code; }" +
+                "fs.mkdirSync('pkg');" +
+                "fs.writeFileSync('pkg/package.json', '{\"main\": \"lib.js\"}');" +
+                "fs.writeFileSync('pkg/lib.js', 'module.exports = 42;');" +
+                "global.found = require('./pkg');" +
+                "global.again = require(process.cwd() + '/pkg');" +
+                "global.stats = process.binding('fs').internalModuleCacheStats();" +
+                "";
+        new Script(script, new OnDone() {
+            @Override
+            public void onDone(JSContext ctx) {
+                assertEquals("MODULE_NOT_FOUND", ctx.property("missing").toString());
+                assertEquals(42, ctx.property("found").toNumber().intValue());
+                assertEquals(42, ctx.property("again").toNumber().intValue());
+                JSObject stats = ctx.property("stats").toObject();
+                assertTrue(stats.property("stat").toObject().property("hits").toNumber() > 0);
+                assertTrue(stats.property("hitRatio").toNumber() > 0);
+            }
+        }).processCompleted.acquire();
+
+        Process.uninstall(InstrumentationRegistry.getContext(), "_", Process.UninstallScope.Local);
+    }
+
+    @Test
+    public void moduleReadTimeTest() throws Exception {
+        InputStream in = getClass().getClassLoader().getResourceAsStream("moduleReadBenchmark.js");
+        Scanner s = new Scanner(in).useDelimiter("\\A");
+        String script = s.hasNext() ? s.next() : "";
+
+        new Script(script, new OnDone() {
+            @Override
+            public void onDone(JSContext ctx) {
+                JSBaseArray results = ctx.property("results").toJSArray();
+                for (Object result : results) {
+                    android.util.Log.d("moduleReadTimeTest", result.toString());
+                }
+                assertTrue(ctx.property("same").toBoolean());
+            }
+        }).processCompleted.acquire();
+
+        Process.uninstall(InstrumentationRegistry.getContext(), "_", Process.UninstallScope.Local);
+    }
+
     /**
      * https://github.com/LiquidPlayer/LiquidCore/issues/9
      */
@@ -337,4 +385,34 @@ public class FSTest {
             assertTrue(new File(media.getAbsolutePath() + "/test2.txt").delete());
         }
     }
+
+    @Test
+    public void testModuleCache() throws Exception {
+        final String script = "" +
+                "var fs = require('fs');" +
+                "process.chdir('./local');" +
+                "function load() {" +
+                "   delete require.cache[require.resolve('./cached.js')];" +
+                "   return require('./cached.js');" +
+                "}" +
+                "fs.writeFileSync('cached.js', '#!/usr/bin/env node\\nmodule.exports = 1;');" +
+                "global.first = load();" +
+                "global.second = load();" +
+                "fs.writeFileSync('cached.js', 'module.exports = 22;');" +
+                "global.changed = load();" +
+                "fs.writeFileSync('cached.js', 'module.exports = ;');" +
+                "try { load(); } catch (e) { global.error = e.name; }" +
+                "";
+        new Script(script, new OnDone() {
+            @Override
+            public void onDone(JSContext ctx) {
+                assertEquals(1, ctx.property("first").toNumber().intValue());
+                assertEquals(1, ctx.property("second").toNumber().intValue());
+                assertEquals(22, ctx.property("changed").toNumber().intValue());
+                assertEquals("SyntaxError", ctx.property("error").toString());
+            }
+        }).processCompleted.acquire();
+
+        Process.uninstall(InstrumentationRegistry.getContext(), "_", Process.UninstallScope.Local);
+    }
 }
\ No newline at end of file
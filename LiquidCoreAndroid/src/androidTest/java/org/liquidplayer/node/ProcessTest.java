@@ -41,6 +41,7 @@ import org.liquidplayer.javascript.JSFunction;
 import org.liquidplayer.javascript.JSValue;
 
 import java.util.concurrent.Semaphore;
+import java.util.concurrent.TimeUnit;
 
 import static org.junit.Assert.*;
 
@@ -190,6 +191,261 @@ public class ProcessTest {
 
     }
 
+    // Returns the time in ms from construction to onProcessStart() for each of 'runs'
+    // processes, started one after the other.
+    private double [] measureStartup(int runs) throws Exception {
+        final double [] elapsed = new double[runs];
+
+        for (int i=0; i<runs; i++) {
+            final Semaphore semaphore = new Semaphore(0);
+            final long start = System.nanoTime();
+            final int run = i;
+            new Process(InstrumentationRegistry.getContext(),"startupTest",
+                    Process.kMediaAccessPermissionsRW,new Process.EventListener() {
+                @Override
+                public void onProcessStart(Process process, JSContext context) {
+                    elapsed[run] = (System.nanoTime() - start) / 1e6;
+                    context.evaluateScript(
+                            "class LiquidCore_ extends require('events') {}\n" +
+                            "var LiquidCore = new LiquidCore_();"
+                    );
+                }
+
+                @Override
+                public void onProcessExit(Process process, int exitCode) {
+                    semaphore.release();
+                }
+
+                @Override
+                public void onProcessAboutToExit(Process process, int exitCode) {}
+
+                @Override
+                public void onProcessFailed(Process process, Exception error) {
+                    semaphore.release();
+                }
+            });
+            semaphore.acquire();
+        }
+
+        Process.uninstall(InstrumentationRegistry.getContext(), "startupTest",
+                Process.UninstallScope.Global);
+        return elapsed;
+    }
+
+    private static double percentile(double [] sorted, int p) {
+        return sorted[Math.min(sorted.length - 1, sorted.length * p / 100)];
+    }
+
+    private static void logPercentiles(String label, double [] elapsed) {
+        double [] sorted = elapsed.clone();
+        java.util.Arrays.sort(sorted);
+        android.util.Log.d("startupTimeTest", String.format(java.util.Locale.US,
+                "%s: p50 %.1fms, p90 %.1fms, max %.1fms (%d runs)", label,
+                percentile(sorted, 50), percentile(sorted, 90), sorted[sorted.length - 1],
+                sorted.length));
+    }
+
+    // Logs start times for a cold first start and for the starts after it, which reuse the
+    // code cache for the core library.
+    @Test
+    public void startupTimeTest() throws Exception {
+        double [] elapsed = measureStartup(5);
+        android.util.Log.d("startupTimeTest", String.format(java.util.Locale.US,
+                "cold start %.1fms", elapsed[0]));
+        logPercentiles("warm start", java.util.Arrays.copyOfRange(elapsed, 1, elapsed.length));
+    }
+
+    // Compares start times with and without pre-warmed instances.
+    @Test
+    public void pooledStartupTimeTest() throws Exception {
+        final int runs = 20;
+        logPercentiles("unpooled", measureStartup(runs));
+
+        Process.setPoolSize(InstrumentationRegistry.getContext(), 2);
+        try {
+            // Let the pool fill up before the first claim
+            Thread.sleep(1000);
+            logPercentiles("pooled", measureStartup(runs));
+        } finally {
+            Process.setPoolSize(InstrumentationRegistry.getContext(), 0);
+        }
+    }
+
+    @Test
+    public void testHeapLimit() throws Exception {
+        final Semaphore semaphore = new Semaphore(0);
+        final int [] exit = new int[1];
+
+        new Process(InstrumentationRegistry.getContext(),"heapLimitTest",
+                Process.kMediaAccessPermissionsRW,0,32,new Process.EventListener() {
+            @Override
+            public void onProcessStart(final Process process, final JSContext context) {
+                context.evaluateScript(
+                        "var hog = [];" +
+                        "setInterval(function(){" +
+                        "  for (var i=0; i<10000; i++) hog.push(new Array(100).fill(i));" +
+                        "},0);");
+            }
+
+            @Override
+            public void onProcessExit(Process process, int exitCode) {
+                exit[0] = exitCode;
+                semaphore.release();
+            }
+
+            @Override
+            public void onProcessAboutToExit(Process process, int exitCode) {}
+
+            @Override
+            public void onProcessFailed(Process process, Exception error) {
+                semaphore.release();
+            }
+        });
+
+        // Hang out here until the process finishes
+        semaphore.acquire();
+        assertEquals(Process.kHeapLimitExceeded, exit[0]);
+
+        Process.uninstall(InstrumentationRegistry.getContext(), "heapLimitTest",
+                Process.UninstallScope.Global);
+    }
+
+    // Starts 'count' processes, either each with an instance of its own or all hosted by one
+    // extra process, and returns how much memory they take, in KB.  Logs that and how long they
+    // took to start.
+    private long measureHosting(final int count, final boolean hosting) throws Exception {
+        final Semaphore started = new Semaphore(0);
+        final Semaphore exited = new Semaphore(0);
+        final java.util.List<Process> processes =
+                java.util.Collections.synchronizedList(new java.util.ArrayList<Process>());
+
+        Process.EventListener listener = new Process.EventListener() {
+            @Override
+            public void onProcessStart(Process process, JSContext context) {
+                process.keepAlive();
+                processes.add(process);
+                started.release();
+            }
+
+            @Override
+            public void onProcessExit(Process process, int exitCode) {
+                exited.release();
+            }
+
+            @Override
+            public void onProcessAboutToExit(Process process, int exitCode) {}
+
+            @Override
+            public void onProcessFailed(Process process, Exception error) {}
+        };
+
+        Runtime.getRuntime().gc();
+        long pss = android.os.Debug.getPss();
+        long start = System.nanoTime();
+
+        Process host = null;
+        if (hosting) {
+            host = new Process(InstrumentationRegistry.getContext(), "hostingTest",
+                    Process.kMediaAccessPermissionsRW, listener);
+            assertTrue(started.tryAcquire(30, TimeUnit.SECONDS));
+        }
+        for (int i=0; i<count; i++) {
+            if (hosting) {
+                new Process(InstrumentationRegistry.getContext(), "hostingTest",
+                        Process.kMediaAccessPermissionsRW, host, listener);
+            } else {
+                new Process(InstrumentationRegistry.getContext(), "hostingTest",
+                        Process.kMediaAccessPermissionsRW, listener);
+            }
+        }
+        assertTrue(started.tryAcquire(count, 60, TimeUnit.SECONDS));
+        assertEquals(hosting ? count + 1 : count, processes.size());
+
+        double elapsed = (System.nanoTime() - start) / 1e6;
+        Runtime.getRuntime().gc();
+        pss = android.os.Debug.getPss() - pss;
+        android.util.Log.d("hostingTest", String.format(java.util.Locale.US,
+                "%s: %d processes started in %.1fms (%.1fms each), %dKB (%dKB each)",
+                hosting ? "hosted" : "one instance each", count, elapsed, elapsed / count,
+                pss, pss / count));
+
+        for (Process process : processes.toArray(new Process[processes.size()])) {
+            process.letDie();
+        }
+        assertTrue(exited.tryAcquire(processes.size(), 60, TimeUnit.SECONDS));
+
+        Process.uninstall(InstrumentationRegistry.getContext(), "hostingTest",
+                Process.UninstallScope.Global);
+        return pss;
+    }
+
+    @Test
+    public void hostingTest() throws Exception {
+        long separate = measureHosting(10, false);
+        long hosted = measureHosting(10, true);
+        // Ten hosted processes share one isolate and its copy of the node core heap; ten
+        // instances have ten of each
+        assertTrue("hosted: " + hosted + "KB, separate: " + separate + "KB", hosted < separate);
+    }
+
+    @Test
+    public void testHostedProcess() throws Exception {
+        final Semaphore semaphore = new Semaphore(0);
+        final int [] exit = new int[2];
+
+        new Process(InstrumentationRegistry.getContext(),"hostedTest",
+                Process.kMediaAccessPermissionsRW,new Process.EventListener() {
+            @Override
+            public void onProcessStart(final Process host, final JSContext hostContext) {
+                hostContext.evaluateScript("var hostOnly = 1;");
+                host.keepAlive();
+                new Process(InstrumentationRegistry.getContext(),"hostedTest",
+                        Process.kMediaAccessPermissionsRW,host,new Process.EventListener() {
+                    @Override
+                    public void onProcessStart(Process process, JSContext context) {
+                        // Contexts are separate, the loop is shared
+                        assertTrue(context.property("hostOnly").isUndefined());
+                        context.evaluateScript("setTimeout(function(){process.exit(3);},100);");
+                    }
+
+                    @Override
+                    public void onProcessExit(Process process, int exitCode) {
+                        exit[1] = exitCode;
+                        host.letDie();
+                    }
+
+                    @Override
+                    public void onProcessAboutToExit(Process process, int exitCode) {}
+
+                    @Override
+                    public void onProcessFailed(Process process, Exception error) {}
+                });
+            }
+
+            @Override
+            public void onProcessExit(Process process, int exitCode) {
+                exit[0] = exitCode;
+                semaphore.release();
+            }
+
+            @Override
+            public void onProcessAboutToExit(Process process, int exitCode) {}
+
+            @Override
+            public void onProcessFailed(Process process, Exception error) {
+                semaphore.release();
+            }
+        });
+
+        // Hang out here until the host finishes
+        semaphore.acquire();
+        assertEquals(0, exit[0]);
+        assertEquals(3, exit[1]);
+
+        Process.uninstall(InstrumentationRegistry.getContext(), "hostedTest",
+                Process.UninstallScope.Global);
+    }
+
     @org.junit.After
     public void shutDown() {
         Runtime.getRuntime().gc();
@@ -0,0 +1,51 @@
+(function() {
+    // Times internalModuleReadFile(), which backs large ASCII files with a
+    // mapping instead of copying them, against fs.readFileSync() for the
+    // sqlite3 module and 2 MB bundles with and without non-ASCII characters.
+    var fs = require('fs');
+    var binding = process.binding('fs');
+
+    process.chdir('./local');
+
+    function bundle(name, comment) {
+        var line = 'exports.f = function(a, b) { return a + b; }; // ' +
+            comment + '\n';
+        var lines = [];
+        for (var size = 0; size < 2 * 1024 * 1024; size += line.length) {
+            lines.push(line);
+        }
+        fs.writeFileSync(name, lines.join(''));
+        return name;
+    }
+
+    function time(label, runs, read) {
+        read();  // warm up
+        var start = process.hrtime();
+        for (var i = 0; i < runs; i++) {
+            read();
+        }
+        var elapsed = process.hrtime(start);
+        var ms = (elapsed[0] * 1e3 + elapsed[1] / 1e6) / runs;
+        global.results.push(label + ': ' + ms.toFixed(3) + 'ms');
+    }
+
+    function compare(name, file, runs) {
+        time(name + ' internalModuleReadFile', runs, function() {
+            binding.internalModuleReadFile(file);
+        });
+        time(name + ' readFileSync', runs, function() {
+            fs.readFileSync(file, 'utf8');
+        });
+    }
+
+    global.results = [];
+    compare('sqlite3', require.resolve('sqlite3'), 200);
+    compare('2MB ascii', bundle('ascii.js', 'plain'), 20);
+    compare('2MB utf8', bundle('utf8.js', 'déjà vu'), 20);
+
+    // The mapped string must read back the same as the copied one.
+    global.same = binding.internalModuleReadFile('ascii.js') ===
+        fs.readFileSync('ascii.js', 'utf8') &&
+        binding.internalModuleReadFile('utf8.js') ===
+        fs.readFileSync('utf8.js', 'utf8');
+})()
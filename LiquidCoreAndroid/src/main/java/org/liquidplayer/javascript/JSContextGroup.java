@@ -54,6 +54,17 @@ public class JSContextGroup {
     public JSContextGroup() {
         group = create();
     }
+    /**
+     * Creates a new context group whose heap is limited to about 'maxHeapSizeMB' megabytes.
+     * When a garbage collection leaves the heap nearly full, the script running in the group
+     * is terminated rather than letting the app run out of memory.
+     * @param maxHeapSizeMB  maximum heap size, in megabytes
+     * @since 0.3.0
+     */
+    public JSContextGroup(int maxHeapSizeMB) {
+        group = createWithHeapLimit(maxHeapSizeMB);
+    }
+
     /**
      * Wraps an existing context group
      * @param groupRef  the JavaScriptCore context group reference
@@ -94,6 +105,116 @@ public class JSContextGroup {
                 groupRef().equals(((JSContextGroup)other).groupRef());
     }
 
+    /**
+     * Garbage collection statistics of a context group
+     * @since 0.3.0
+     */
+    public static class GCStatistics {
+        /** Number of young generation collections */
+        public final long scavenges;
+        /** Number of full collections */
+        public final long markSweeps;
+        /** Time spent in collections, in milliseconds */
+        public final double totalPauseMs;
+        /** Longest collection, in milliseconds */
+        public final double maxPauseMs;
+        /** Number of times the group was given idle time to collect garbage */
+        public final long idleNotifications;
+        /** Idle time used, in milliseconds */
+        public final double idleTimeMs;
+        /** Heap in use after the last collection, in bytes */
+        public final long usedHeapSize;
+        /** Heap size after the last collection, in bytes */
+        public final long totalHeapSize;
+        /** Heap size limit, in bytes */
+        public final long heapSizeLimit;
+
+        private GCStatistics(double[] values) {
+            scavenges = (long) values[0];
+            markSweeps = (long) values[1];
+            totalPauseMs = values[2];
+            maxPauseMs = values[3];
+            idleNotifications = (long) values[4];
+            idleTimeMs = values[5];
+            usedHeapSize = (long) values[6];
+            totalHeapSize = (long) values[7];
+            heapSizeLimit = (long) values[8];
+        }
+    }
+
+    /**
+     * Gets the garbage collection statistics of this group
+     * @return the statistics so far
+     * @since 0.3.0
+     */
+    public GCStatistics getGCStatistics() {
+        return new GCStatistics(getGCStatistics(group));
+    }
+
+    /**
+     * ArrayBuffer allocation statistics of a context group.  Backing stores of small
+     * ArrayBuffers are recycled through a pool shared by all groups in the process.
+     * @since 0.3.0
+     */
+    public static class AllocatorStatistics {
+        /** Number of backing stores allocated */
+        public final long allocations;
+        /** Number of allocations served by recycling a pooled block */
+        public final long poolHits;
+        /** Number of backing stores returned to the pool */
+        public final long recycled;
+        /** Number of backing stores released to the system */
+        public final long freed;
+        /** Memory committed to the pool, process-wide, in bytes */
+        public final long poolCommittedBytes;
+        /** Memory waiting in the pool to be recycled, process-wide, in bytes */
+        public final long poolFreeBytes;
+
+        private AllocatorStatistics(long[] values) {
+            allocations = values[0];
+            poolHits = values[1];
+            recycled = values[2];
+            freed = values[3];
+            poolCommittedBytes = values[4];
+            poolFreeBytes = values[5];
+        }
+    }
+
+    /**
+     * Gets the ArrayBuffer allocation statistics of this group
+     * @return the statistics so far
+     * @since 0.3.0
+     */
+    public AllocatorStatistics getAllocatorStatistics() {
+        return new AllocatorStatistics(getAllocatorStatistics(group));
+    }
+
+    /** No memory pressure; lets the engine return to its normal heap growth */
+    public static final int kMemoryPressureNone = 0;
+    /** Moderate memory pressure; garbage is collected in the background */
+    public static final int kMemoryPressureModerate = 1;
+    /** Critical memory pressure; garbage is collected right away */
+    public static final int kMemoryPressureCritical = 2;
+
+    /**
+     * Notifies every context group in the process, including those of node.js processes,
+     * of memory pressure, and drops the module caches kept for node.js processes.  Each
+     * group is notified on the thread it runs on.  Blocks until all groups have handled the
+     * notification or 'timeoutMs' have passed.
+     * @param level one of kMemoryPressureNone, kMemoryPressureModerate or
+     *              kMemoryPressureCritical
+     * @param timeoutMs how long to wait for groups running on other threads
+     * @return the number of bytes reclaimed by each group, -1 for those that timed out
+     * @since 0.3.0
+     */
+    public static long[] notifyMemoryPressure(int level, int timeoutMs) {
+        return notifyMemoryPressureNative(level, timeoutMs);
+    }
+
     protected native long create();
+    protected native long createWithHeapLimit(int maxHeapSizeMB);
     protected native static void release(long group);
+    protected native static double[] getGCStatistics(long group);
+    protected native static long[] getAllocatorStatistics(long group);
+    private native static long[] notifyMemoryPressureNative(int level, int timeoutMs);
 }
@@ -32,7 +32,9 @@
 */
 package org.liquidplayer.node;
 
+import android.content.ComponentCallbacks2;
 import android.content.Context;
+import android.content.res.Configuration;
 
 import org.liquidplayer.javascript.JSContext;
 import org.liquidplayer.javascript.JSContextGroup;
@@ -47,6 +49,8 @@ import java.util.ArrayList;
 public class Process {
 
     final public static int kContextFinalizedButProcessStillActive = -222;
+    final public static int kHeapLimitExceeded = -223;
+    final public static int kHostExited = -224;
 
     final public static int kMediaAccessPermissionsNone = 0;
     final public static int kMediaAccessPermissionsRead = 1;
@@ -125,14 +129,72 @@ public class Process {
      */
     public Process(Context androidContext, String uniqueID, int mediaAccessMask,
                    EventListener listener) {
+        this(androidContext, uniqueID, mediaAccessMask, 0, listener);
+    }
+
+    /**
+     * Creates a node.js process with a thread pool of its own and attaches an event listener.
+     * Filesystem, DNS and other background work of the process then runs on 'threadPoolSize'
+     * threads which are not shared with other processes.
+     * @param threadPoolSize number of thread pool threads, or 0 to share the default pool
+     * @param listener the listener interface object
+     */
+    public Process(Context androidContext, String uniqueID, int mediaAccessMask,
+                   int threadPoolSize, EventListener listener) {
+        this(androidContext, uniqueID, mediaAccessMask, threadPoolSize, 0, listener);
+    }
+
+    /**
+     * Creates a node.js process with a limited heap and attaches an event listener.  When a
+     * garbage collection leaves the heap nearly full, the process exits with exit code
+     * kHeapLimitExceeded instead of running the app out of memory.
+     * @param threadPoolSize number of thread pool threads, or 0 to share the default pool
+     * @param maxHeapSizeMB maximum heap size in megabytes, or 0 for no limit
+     * @param listener the listener interface object
+     */
+    public Process(Context androidContext, String uniqueID, int mediaAccessMask,
+                   int threadPoolSize, int maxHeapSizeMB, EventListener listener) {
+        addEventListener(listener);
+
+        new Modules(androidContext).setUpNodeModules();
+        registerTrimCallbacks(androidContext);
+
+        processRef = start(threadPoolSize, maxHeapSizeMB);
+        hostRef = processRef;
+        hosted = false;
+        androidCtx = androidContext;
+        this.uniqueID = uniqueID;
+        this.mediaAccessMask = mediaAccessMask;
+    }
+
+    /**
+     * Creates a node.js process hosted by another one and attaches an event listener.  The
+     * process gets a JavaScript context, node environment and file system of its own, but runs
+     * on the isolate, event loop and thread of 'host'.  This saves the memory and startup time
+     * of a separate node.js instance, at the price of sharing the thread and heap with the host
+     * and the other processes it hosts.  A hosted process keeps its host alive and exits when
+     * its host does.  If 'host' has already exited, so does this process, with exit code
+     * kHostExited.
+     * @param host the process to run in, or a process it hosts
+     * @param listener the listener interface object
+     */
+    public Process(Context androidContext, String uniqueID, int mediaAccessMask, Process host,
+                   EventListener listener) {
         addEventListener(listener);
 
         new Modules(androidContext).setUpNodeModules();
+        registerTrimCallbacks(androidContext);
 
-        processRef = start();
         androidCtx = androidContext;
         this.uniqueID = uniqueID;
         this.mediaAccessMask = mediaAccessMask;
+        hostRef = host.hostRef;
+        hosted = true;
+        processRef = startHosted(hostRef);
+        if (processRef == 0L) {
+            isDone = true;
+            eventOnExit(kHostExited);
+        }
     }
 
     /**
@@ -214,6 +276,66 @@ public class Process {
         }
     }
 
+    /**
+     * Keeps up to 'size' node.js instances bootstrapped and parked in the background, so that
+     * a new Process can claim one instead of starting up from scratch.  Parked instances are
+     * released when the system runs low on memory and the pool is filled up again on the next
+     * start.  The default size is 0 (no pooling).
+     * @param androidContext the Android context
+     * @param size the number of parked instances to keep
+     */
+    public static void setPoolSize(Context androidContext, int size) {
+        new Modules(androidContext).setUpNodeModules();
+
+        registerTrimCallbacks(androidContext);
+        setPoolSize(size);
+    }
+
+    // Passes memory pressure on to all node.js processes and context groups, and releases
+    // parked instances when memory is running low
+    private static void registerTrimCallbacks(Context androidContext) {
+        synchronized (Process.class) {
+            if (trimCallbacks == null) {
+                trimCallbacks = new ComponentCallbacks2() {
+                    @Override
+                    public void onTrimMemory(final int level) {
+                        if (level < TRIM_MEMORY_RUNNING_MODERATE) return;
+                        new Thread() {
+                            @Override
+                            public void run() {
+                                if (level >= TRIM_MEMORY_RUNNING_LOW) {
+                                    trimPool();
+                                }
+                                boolean critical = level == TRIM_MEMORY_RUNNING_CRITICAL ||
+                                        level >= TRIM_MEMORY_MODERATE;
+                                long [] reclaimed = JSContextGroup.notifyMemoryPressure(
+                                        critical ? JSContextGroup.kMemoryPressureCritical :
+                                                JSContextGroup.kMemoryPressureModerate,
+                                        kMemoryPressureTimeoutMs);
+                                long total = 0;
+                                for (long bytes : reclaimed) {
+                                    if (bytes > 0) total += bytes;
+                                }
+                                android.util.Log.d("Process", "onTrimMemory(" + level +
+                                        "): reclaimed " + total + " bytes from " +
+                                        reclaimed.length + " groups");
+                            }
+                        }.start();
+                    }
+
+                    @Override
+                    public void onLowMemory() {
+                        onTrimMemory(TRIM_MEMORY_COMPLETE);
+                    }
+
+                    @Override
+                    public void onConfigurationChanged(Configuration configuration) {}
+                };
+                androidContext.getApplicationContext().registerComponentCallbacks(trimCallbacks);
+            }
+        }
+    }
+
     /**
      * Determines the scope of an uninstallation.  A Local uninstallation will only clear
      * data and files related to instances on this host.  A Global uninstallation will
@@ -361,12 +483,21 @@ public class Process {
         (new Thread() {
             @Override
             public void run() {
-                dispose(processRef);
+                if (hosted) {
+                    disposeHosted(processRef);
+                } else {
+                    dispose(processRef);
+                }
             }
         }).start();
     }
 
+    private static ComponentCallbacks2 trimCallbacks = null;
+    private static final int kMemoryPressureTimeoutMs = 1000;
+
     private final long processRef;
+    private final long hostRef;
+    private final boolean hosted;
     private final String uniqueID;
     private final Context androidCtx;
     private final int mediaAccessMask;
@@ -420,9 +551,13 @@ public class Process {
     }
 
     /* Native JNI functions */
-    private native long start();
+    private native long start(int threadPoolSize, int maxHeapSizeMB);
     private native void dispose(long processRef);
+    private native long startHosted(long hostRef);
+    private native void disposeHosted(long processRef);
     private native long keepAlive(long contextRef);
     private native void letDie(long handleRef);
     private native long setFileSystem(long contextRef, long fsObject);
+    private static native void setPoolSize(int size);
+    private static native void trimPool();
 }
@@ -564,6 +564,33 @@ public class MicroService implements Process.EventListener {
                 MicroService.this);
     }
 
+    /**
+     * Starts the MicroService in the process of another one, as with start().  The two services
+     * share a node.js instance and its thread but each keeps its own JavaScript context, node
+     * environment and file system.  Use this for many lightweight services, which then do not
+     * each pay for an instance of their own.  The service exits when 'host' does.  If 'host'
+     * has not been started, there is nothing to share and the service is started with start()
+     * instead.
+     * @param host  The running MicroService to host this one
+     * @param argv  The list of arguments to sent to the MicroService, as with start()
+     * @return true if the service is hosted by 'host', false if it got an instance of its own
+     */
+    public synchronized boolean startHosted(MicroService host, String ... argv) {
+        if (started) throw new ServiceAlreadyStartedError();
+        Process hostProcess = host.getProcess();
+        if (hostProcess == null) {
+            android.util.Log.w("MicroService",
+                    "Host service not started, starting " + serviceURI + " on its own");
+            start(argv);
+            return false;
+        }
+        started = true;
+        this.argv = argv;
+        process = new Process(androidCtx, serviceId, Process.kMediaAccessPermissionsRW,
+                hostProcess, MicroService.this);
+        return true;
+    }
+
     /**
      * Uninstalls the MicroService from this host, and removes any global data associated with the
      * service
@@ -0,0 +1,31 @@
+'use strict';
+const common = require('../common.js');
+
+// The rate is in megabytes filled per second.
+const bench = common.createBenchmark(main, {
+  size: [64, 1024, 65536, 1048576, 16777216],
+  value: ['0', '"a"', '"abc"', '"éè"', 'Buffer(7)', 'Buffer(64)'],
+  mb: [1024]
+});
+
+function main(conf) {
+  const size = conf.size | 0;
+  const mb = conf.mb | 0;
+  const iter = Math.max(1, Math.floor(mb * 1048576 / size));
+  const buf = Buffer.allocUnsafe(size);
+
+  var value;
+  switch (conf.value) {
+    case '0': value = 0; break;
+    case '"a"': value = 'a'; break;
+    case '"abc"': value = 'abc'; break;
+    case '"éè"': value = 'éè'; break;
+    case 'Buffer(7)': value = Buffer.from('abcdefg'); break;
+    case 'Buffer(64)': value = Buffer.alloc(64, 'abcdefg'); break;
+  }
+
+  bench.start();
+  for (var i = 0; i < iter; i++)
+    buf.fill(value);
+  bench.end(iter * size / 1048576);
+}
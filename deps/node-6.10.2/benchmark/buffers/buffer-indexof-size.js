@@ -0,0 +1,52 @@
+'use strict';
+const common = require('../common.js');
+
+// Searches newline-delimited JSON for a needle found only at the very end
+// (or start, for lastIndexOf), so that the whole haystack is scanned. The
+// rate is in megabytes of haystack per second.
+const bench = common.createBenchmark(main, {
+  size: [64, 1024, 65536, 1048576],
+  needle: [2, 4, 8, 16, 32, 64, 128],
+  method: ['indexOf', 'lastIndexOf'],
+  type: ['buffer', 'string'],
+  mb: [256]
+});
+
+function makeHaystack(size) {
+  const line = '{"id":1234,"name":"record","tags":["a","b"],"ok":true}\n';
+  return Buffer.from(line.repeat(Math.ceil(size / line.length)).slice(0, size));
+}
+
+function makeNeedle(length) {
+  // Starts and ends with bytes that are common in the haystack.
+  let needle = '"';
+  while (needle.length < length - 1)
+    needle += 'zyxwvutsrqponmlkjihgfedcba'[needle.length % 26];
+  return needle + '"';
+}
+
+function main(conf) {
+  const size = conf.size | 0;
+  const mb = conf.mb | 0;
+  const iter = Math.max(1, Math.floor(mb * 1048576 / size));
+  const haystack = makeHaystack(size);
+  const needle = makeNeedle(Math.min(conf.needle | 0, size));
+
+  if (conf.method === 'indexOf')
+    haystack.write(needle, size - needle.length, 'latin1');
+  else
+    haystack.write(needle, 0, 'latin1');
+
+  const search = conf.type === 'buffer' ? Buffer.from(needle) : needle;
+  const forward = conf.method === 'indexOf';
+
+  bench.start();
+  if (forward) {
+    for (var i = 0; i < iter; i++)
+      haystack.indexOf(search);
+  } else {
+    for (var j = 0; j < iter; j++)
+      haystack.lastIndexOf(search);
+  }
+  bench.end(iter * size / 1048576);
+}
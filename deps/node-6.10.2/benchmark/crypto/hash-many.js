@@ -0,0 +1,39 @@
+// Digest many small inputs with one crypto.hashMany() call, or with a
+// createHash().update().digest() chain per input.
+'use strict';
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  api: ['hashMany', 'createHash'],
+  algo: ['sha1', 'sha256'],
+  len: [32, 1024],
+  batch: [1, 100, 1000],
+  n: [1e5]
+});
+
+function main(conf) {
+  var algo = conf.algo;
+  var batch = +conf.batch;
+  var rounds = Math.max(1, Math.floor(conf.n / batch));
+
+  var inputs = [];
+  for (var i = 0; i < batch; i++)
+    inputs.push(Buffer.alloc(+conf.len, i));
+
+  var digests;
+  bench.start();
+  if (conf.api === 'hashMany') {
+    for (var r = 0; r < rounds; r++)
+      digests = crypto.hashMany(algo, inputs, 'hex');
+  } else {
+    for (var r2 = 0; r2 < rounds; r2++) {
+      digests = new Array(batch);
+      for (var j = 0; j < batch; j++) {
+        digests[j] =
+            crypto.createHash(algo).update(inputs[j]).digest('hex');
+      }
+    }
+  }
+  bench.end(rounds * batch);
+}
@@ -0,0 +1,71 @@
+// test UDP packets per second over loopback, with and without batching
+'use strict';
+
+const common = require('../common.js');
+const PORT = common.PORT;
+
+// `batch` is the number of datagrams read or sent per system call, or 0 to
+// read and send them one at a time.
+var bench = common.createBenchmark(main, {
+  len: [16, 256],
+  num: [100],
+  batch: [0, 32],
+  type: ['send', 'recv'],
+  dur: [5]
+});
+
+var dur;
+var len;
+var num;
+var batch;
+var type;
+var chunk;
+
+function main(conf) {
+  dur = +conf.dur;
+  len = +conf.len;
+  num = +conf.num;
+  batch = +conf.batch;
+  type = conf.type;
+  chunk = Buffer.allocUnsafe(len);
+  server();
+}
+
+var dgram = require('dgram');
+
+function server() {
+  var sent = 0;
+  var received = 0;
+  var options = { type: 'udp4' };
+  if (batch > 0)
+    options.batch = { count: batch, size: 2048 };
+  var socket = dgram.createSocket(options);
+
+  function onsend() {
+    if (sent++ % num === 0)
+      for (var i = 0; i < num; i++)
+        socket.send(chunk, PORT, '127.0.0.1', onsend);
+  }
+
+  socket.on('listening', function() {
+    bench.start();
+    onsend();
+
+    setTimeout(function() {
+      bench.end(type === 'send' ? sent : received);
+      process.exit(0);
+    }, dur * 1000);
+  });
+
+  if (batch > 0) {
+    socket.on('messages', function(messages) {
+      received += messages.length;
+    });
+  } else {
+    socket.on('message', function(buf, rinfo) {
+      received++;
+    });
+  }
+
+  socket.bind(PORT);
+}
@@ -0,0 +1,45 @@
+'use strict';
+// Requests per second for requests carrying typical browser headers, whose
+// names the parser interns, or the same number of custom headers.
+var common = require('../common.js');
+var http = require('http');
+
+var bench = common.createBenchmark(main, {
+  headers: ['known', 'custom'],
+  c: [50, 500]
+});
+
+var known = [
+  'Accept: text/html,application/xhtml+xml,*/*;q=0.8',
+  'Accept-Encoding: gzip, deflate',
+  'Accept-Language: en-US,en;q=0.5',
+  'Cache-Control: max-age=0',
+  'Cookie: session=0123456789abcdef',
+  'If-None-Match: "5f3c-1a2b"',
+  'Referer: http://127.0.0.1/',
+  'User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:52.0) Gecko/20100101'
+];
+
+function main(conf) {
+  var headers = known;
+  if (conf.headers === 'custom') {
+    headers = known.map(function(header, i) {
+      return 'X-Custom-' + i + header.slice(header.indexOf(':'));
+    });
+  }
+
+  var server = http.createServer(function(req, res) {
+    res.end('ok');
+  });
+
+  server.listen(common.PORT, function() {
+    var args = ['-d', '10s', '-t', 8, '-c', conf.c];
+    headers.forEach(function(header) {
+      args.push('-H', header);
+    });
+
+    bench.http('/', args, function() {
+      server.close();
+    });
+  });
+}
@@ -0,0 +1,205 @@
+/**
+ * Throughput of the vectorized StringBytes kernels against the scalar loops
+ * they replace, in GB/s of input per kernel and size.
+ *
+ * g++ -O2 -DNODE_WANT_INTERNALS=1 -Isrc -o simdtest \
+ *     benchmark/string_bytes_simd.cc src/string_bytes_simd.cc
+ *
+ * Add -mssse3 on x86 for the base64 kernels; ARM builds use NEON if enabled.
+ */
+
+#include "string_bytes_simd.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+using namespace node;
+
+static const size_t sizes[] = { 64, 1024, 65536, 1048576 };
+static const size_t total = 256 * 1048576;
+
+static char* dst;
+static volatile size_t sink;
+
+static uint64_t now(void) {
+  struct timeval tv;
+
+  if (gettimeofday(&tv, NULL))
+    abort();
+
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+static const char hex[] = "0123456789abcdef";
+static const char b64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static size_t scalar_is_ascii(const char* s, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    if (s[i] & 0x80)
+      return 0;
+  return 1;
+}
+
+static size_t scalar_force_ascii(const char* s, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    dst[i] = s[i] & 0x7f;
+  return n;
+}
+
+static size_t scalar_count_non_ascii(const char* s, size_t n) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++)
+    count += static_cast<uint8_t>(s[i]) >> 7;
+  return count;
+}
+
+static size_t scalar_hex_encode(const char* s, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint8_t c = s[i];
+    dst[2 * i] = hex[c >> 4];
+    dst[2 * i + 1] = hex[c & 15];
+  }
+  return n;
+}
+
+static int unhex(uint8_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static size_t scalar_hex_decode(const char* s, size_t n) {
+  size_t i;
+  for (i = 0; i < n / 2; i++) {
+    int a = unhex(s[2 * i]);
+    int b = unhex(s[2 * i + 1]);
+    if (a < 0 || b < 0)
+      break;
+    dst[i] = a * 16 + b;
+  }
+  return i;
+}
+
+static size_t scalar_base64_encode(const char* s, size_t n) {
+  size_t i, k = 0;
+  for (i = 0; i + 3 <= n; i += 3) {
+    uint8_t a = s[i], b = s[i + 1], c = s[i + 2];
+    dst[k++] = b64[a >> 2];
+    dst[k++] = b64[((a & 3) << 4) | (b >> 4)];
+    dst[k++] = b64[((b & 15) << 2) | (c >> 6)];
+    dst[k++] = b64[c & 63];
+  }
+  return i;
+}
+
+static int8_t unb64[256];
+
+static size_t scalar_base64_decode(const char* s, size_t n) {
+  size_t i, k = 0;
+  for (i = 0; i + 4 <= n; i += 4) {
+    int8_t a = unb64[static_cast<uint8_t>(s[i])];
+    int8_t b = unb64[static_cast<uint8_t>(s[i + 1])];
+    int8_t c = unb64[static_cast<uint8_t>(s[i + 2])];
+    int8_t d = unb64[static_cast<uint8_t>(s[i + 3])];
+    if ((a | b | c | d) < 0)
+      break;
+    dst[k++] = (a << 2) | (b >> 4);
+    dst[k++] = (b << 4) | (c >> 2);
+    dst[k++] = (c << 6) | d;
+  }
+  return k;
+}
+
+static size_t simd_is_ascii(const char* s, size_t n) {
+  return simd::IsAscii(s, n);
+}
+
+static size_t simd_force_ascii(const char* s, size_t n) {
+  simd::ForceAscii(s, dst, n);
+  return n;
+}
+
+static size_t simd_count_non_ascii(const char* s, size_t n) {
+  return simd::CountNonAscii(s, n);
+}
+
+static size_t simd_hex_encode(const char* s, size_t n) {
+  return simd::HexEncode(s, n, dst);
+}
+
+static size_t simd_hex_decode(const char* s, size_t n) {
+  return simd::HexDecode(dst, n / 2, s, n);
+}
+
+static size_t simd_base64_encode(const char* s, size_t n) {
+  return simd::Base64Encode(s, n, dst);
+}
+
+static size_t simd_base64_decode(const char* s, size_t n) {
+  size_t consumed;
+  return simd::Base64Decode(dst, n, s, n, &consumed);
+}
+
+typedef size_t (*kernel_t)(const char*, size_t);
+
+static double run(kernel_t kernel, const char* input, size_t size) {
+  size_t iterations = total / size;
+  size_t result = 0;
+  uint64_t start = now();
+  for (size_t i = 0; i < iterations; i++)
+    result += kernel(input, size);
+  uint64_t elapsed = now() - start;
+  sink = result;
+  if (elapsed == 0)
+    elapsed = 1;
+  return static_cast<double>(iterations * size) / (elapsed * 1000.0);
+}
+
+static void bench(const char* name,
+                  kernel_t scalar,
+                  kernel_t vector,
+                  const char* input) {
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    double a = run(scalar, input, sizes[i]);
+    double b = run(vector, input, sizes[i]);
+    printf("%-16s %8zu B  scalar %7.2f GB/s  simd %7.2f GB/s  x%.1f\n",
+           name, sizes[i], a, b, b / a);
+  }
+}
+
+int main() {
+  size_t max = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+  char* ascii = static_cast<char*>(malloc(max));
+  char* binary = static_cast<char*>(malloc(max));
+  char* hexed = static_cast<char*>(malloc(max));
+  char* base64 = static_cast<char*>(malloc(max));
+  dst = static_cast<char*>(malloc(2 * max));
+
+  memset(unb64, -1, sizeof(unb64));
+  for (int i = 0; i < 64; i++)
+    unb64[static_cast<uint8_t>(b64[i])] = i;
+
+  srand(42);
+  for (size_t i = 0; i < max; i++) {
+    ascii[i] = rand() & 0x7f;
+    binary[i] = rand();
+    hexed[i] = hex[rand() & 15];
+    base64[i] = b64[rand() & 63];
+  }
+
+  bench("is_ascii", scalar_is_ascii, simd_is_ascii, ascii);
+  bench("force_ascii", scalar_force_ascii, simd_force_ascii, binary);
+  bench("count_non_ascii",
+        scalar_count_non_ascii, simd_count_non_ascii, binary);
+  bench("hex_encode", scalar_hex_encode, simd_hex_encode, binary);
+  bench("hex_decode", scalar_hex_decode, simd_hex_decode, hexed);
+  bench("base64_encode", scalar_base64_encode, simd_base64_encode, binary);
+  bench("base64_decode", scalar_base64_decode, simd_base64_decode, base64);
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+// 100k concurrent timers with distinct durations, scheduled in per-duration
+// lists (the default) or in the timer wheel (--timer-wheel).
+'use strict';
+var common = require('../common.js');
+var child_process = require('child_process');
+var timers = require('timers');
+
+var bench = common.createBenchmark(main, {
+  backend: ['lists', 'wheel'],
+  type: ['insert', 'rearm', 'cancel', 'expire'],
+  n: [100000]
+});
+
+function main(conf) {
+  var wheel = !!process.binding('config').timerWheel ||
+              process.env.NODE_TIMER_WHEEL === '1';
+  if ((conf.backend === 'wheel') !== wheel) {
+    // The backend is picked at startup, so run this configuration in a child
+    // started with the right flag.
+    var argv = process.execArgv.filter(function(arg) {
+      return arg !== '--timer-wheel';
+    });
+    if (conf.backend === 'wheel')
+      argv.push('--timer-wheel');
+    argv = argv.concat(process.argv.slice(1));
+    var env = Object.assign({}, process.env);
+    delete env.NODE_TIMER_WHEEL;
+    child_process.spawn(process.execPath, argv, { stdio: 'inherit', env: env });
+    return;
+  }
+
+  var n = +conf.n;
+  switch (conf.type) {
+    case 'insert': return insert(n);
+    case 'rearm': return rearm(n);
+    case 'cancel': return cancel(n);
+    case 'expire': return expire(n);
+  }
+}
+
+function insert(n) {
+  var list = new Array(n);
+  bench.start();
+  for (var i = 0; i < n; i++)
+    list[i] = setTimeout(fail, 60000 + i);
+  bench.end(n);
+  list.forEach(clearTimeout);
+}
+
+// What sockets do on every read and write.
+function rearm(n) {
+  var items = new Array(n);
+  for (var i = 0; i < n; i++) {
+    items[i] = { _onTimeout: fail };
+    timers.enroll(items[i], 60000 + i);
+    timers._unrefActive(items[i]);
+  }
+
+  bench.start();
+  for (var round = 0; round < 10; round++) {
+    for (var j = 0; j < n; j++)
+      timers._unrefActive(items[j]);
+  }
+  bench.end(10 * n);
+  items.forEach(timers.unenroll);
+}
+
+function cancel(n) {
+  var list = new Array(n);
+  for (var i = 0; i < n; i++)
+    list[i] = setTimeout(fail, 60000 + i);
+
+  bench.start();
+  for (var j = 0; j < n; j++)
+    clearTimeout(list[j]);
+  bench.end(n);
+}
+
+// Spread over 1000 durations so that the run stays short.
+function expire(n) {
+  var left = n;
+  function done() {
+    if (--left === 0)
+      bench.end(n);
+  }
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    setTimeout(done, 1 + i % 1000);
+}
+
+function fail() {
+  throw new Error('timer should not have fired');
+}
@@ -0,0 +1,67 @@
+'use strict';
+var fs = require('fs'),
+  path = require('path'),
+  tls = require('tls');
+
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  sessionCache: ['true', 'false'],
+  dur: [5]
+});
+
+var clientConn = 0;
+var server;
+var dur;
+var sessionCache;
+var ca;
+var running = true;
+
+function main(conf) {
+  dur = +conf.dur;
+  sessionCache = conf.sessionCache === 'true';
+
+  var cert_dir = path.resolve(__dirname, '../../test/fixtures/keys');
+  var options = {
+    key: fs.readFileSync(cert_dir + '/agent1-key.pem'),
+    cert: fs.readFileSync(cert_dir + '/agent1-cert.pem'),
+    ciphers: 'AES256-GCM-SHA384'
+  };
+  ca = fs.readFileSync(cert_dir + '/ca1-cert.pem');
+
+  server = tls.createServer(options, function(conn) {
+    conn.end();
+  });
+  server.listen(common.PORT, onListening);
+}
+
+function onListening() {
+  setTimeout(done, dur * 1000);
+  bench.start();
+  makeConnection();
+}
+
+function makeConnection() {
+  var options = {
+    port: common.PORT,
+    ca: ca,
+    servername: 'agent1',
+    sessionCache: sessionCache
+  };
+  var conn = tls.connect(options, function() {
+    clientConn++;
+    conn.end();
+    if (running) makeConnection();
+  });
+  conn.on('error', function(er) {
+    console.error('client error', er);
+    throw er;
+  });
+  conn.resume();
+}
+
+function done() {
+  running = false;
+  bench.end(clientConn);
+  server.close();
+  process.exit(0);
+}
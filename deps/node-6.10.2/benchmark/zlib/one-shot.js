@@ -0,0 +1,65 @@
+// Compress or decompress whole buffers with the convenience methods, which
+// use the native one-shot path, or with a stream object per buffer.
+'use strict';
+var common = require('../common.js');
+var zlib = require('zlib');
+
+var bench = common.createBenchmark(main, {
+  method: ['gzip', 'gunzip', 'deflate', 'inflate'],
+  len: [64, 1024, 16 * 1024, 1024 * 1024],
+  api: ['oneshot', 'stream'],
+  n: [4e3]
+});
+
+var streams = {
+  gzip: zlib.createGzip,
+  gunzip: zlib.createGunzip,
+  deflate: zlib.createDeflate,
+  inflate: zlib.createInflate
+};
+
+function viaStream(create, input, callback) {
+  var chunks = [];
+  var stream = create();
+  stream.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  stream.on('end', function() {
+    callback(null, Buffer.concat(chunks));
+  });
+  stream.end(input);
+}
+
+function main(conf) {
+  var n = +conf.n;
+  var len = +conf.len;
+  // Large inputs take long enough that fewer rounds still give stable numbers.
+  if (len >= 1024 * 1024)
+    n = Math.max(1, Math.floor(n / 64));
+
+  var input = Buffer.alloc(len);
+  for (var i = 0; i < len; i++)
+    input[i] = 'abcdefghijklmnopqrstuvwxyz'.charCodeAt(i % 26) ^ (i & 7);
+  if (conf.method === 'gunzip')
+    input = zlib.gzipSync(input);
+  else if (conf.method === 'inflate')
+    input = zlib.deflateSync(input);
+
+  var run;
+  if (conf.api === 'oneshot')
+    run = zlib[conf.method];
+  else
+    run = viaStream.bind(null, streams[conf.method]);
+
+  var done = 0;
+  bench.start();
+  (function next() {
+    run(input, function(err) {
+      if (err)
+        throw err;
+      if (++done === n)
+        return bench.end(n);
+      next();
+    });
+  })();
+}
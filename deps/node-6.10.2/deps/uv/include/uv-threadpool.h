@@ -31,6 +31,8 @@ struct uv__work {
   void (*work)(struct uv__work *w);
   void (*done)(struct uv__work *w, int status);
   struct uv_loop_s* loop;
+  void* pool;
+  unsigned int priority;
   void* wq[2];
 };
 
@@ -233,7 +233,8 @@ typedef struct uv_dirent_s uv_dirent_t;
 typedef struct uv_passwd_s uv_passwd_t;
 
 typedef enum {
-  UV_LOOP_BLOCK_SIGNAL
+  UV_LOOP_BLOCK_SIGNAL,
+  UV_LOOP_THREADPOOL_SIZE
 } uv_loop_option;
 
 typedef enum {
@@ -569,7 +570,18 @@ enum uv_udp_flags {
    * (provided they all set the flag) but only the last one to bind will receive
    * any traffic, in effect "stealing" the port from the previous listener.
    */
-  UV_UDP_REUSEADDR = 4
+  UV_UDP_REUSEADDR = 4,
+  /*
+   * Indicates that the message was received as part of a batch, see
+   * uv_udp_set_mmsg(). Its buffer points into the one from alloc_cb and must
+   * not be freed. Used in uv_udp_recv_cb.
+   */
+  UV_UDP_MMSG_CHUNK = 8,
+  /*
+   * Indicates that a batch has been delivered and the buffer from alloc_cb,
+   * passed to this last call, can be freed. Used in uv_udp_recv_cb.
+   */
+  UV_UDP_MMSG_FREE = 16
 };
 
 typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
@@ -637,6 +649,9 @@ UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
 UV_EXTERN int uv_udp_recv_stop(uv_udp_t* handle);
+UV_EXTERN int uv_udp_set_mmsg(uv_udp_t* handle,
+                              unsigned int count,
+                              size_t size);
 
 
 /*
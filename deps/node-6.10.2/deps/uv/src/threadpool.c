@@ -41,15 +41,30 @@ static void uv__req_init(uv_loop_t* loop,
 
 #define MAX_THREADPOOL_SIZE 128
 
+/* A set of worker threads with one work queue per priority. Loops share the
+ * process-wide default pool unless they were given their own with
+ * uv_loop_configure(loop, UV_LOOP_THREADPOOL_SIZE, n).
+ *
+ * Latency-sensitive requests are always taken before bulk ones. Workers with
+ * nothing to do take work from the queues of other pools, as long as another
+ * thread of their own pool stays idle.
+ */
+struct uv__threadpool {
+  uv_mutex_t mutex;
+  uv_cond_t cond;
+  unsigned int nthreads;
+  unsigned int idle_threads;
+  int exiting;
+  uv_thread_t* threads;
+  QUEUE wq[2];  /* Indexed by enum uv__work_priority. */
+  QUEUE pool_queue;
+};
+
 static uv_once_t once = UV_ONCE_INIT;
-static uv_cond_t cond;
-static uv_mutex_t mutex;
-static unsigned int idle_threads;
-static unsigned int nthreads;
-static uv_thread_t* threads;
+static struct uv__threadpool default_pool;
 static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static uv_mutex_t pools_mutex;
+static QUEUE pools;
 static volatile int initialized;
 
 
@@ -58,40 +73,123 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
-/* To avoid deadlock with uv_cancel() it's crucial that the worker
- * never holds the global mutex and the loop-local mutex at the same time.
+/* Takes the next request off |pool|'s queues, latency-sensitive work first.
+ * Must be called with pool->mutex held.
  */
-static void worker(void* arg) {
+static struct uv__work* next_work(struct uv__threadpool* pool) {
+  QUEUE* q;
+
+  if (!QUEUE_EMPTY(&pool->wq[UV__WORK_LATENCY]))
+    q = QUEUE_HEAD(&pool->wq[UV__WORK_LATENCY]);
+  else if (!QUEUE_EMPTY(&pool->wq[UV__WORK_BULK]))
+    q = QUEUE_HEAD(&pool->wq[UV__WORK_BULK]);
+  else
+    return NULL;
+
+  QUEUE_REMOVE(q);
+  QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is executing. */
+
+  return QUEUE_DATA(q, struct uv__work, wq);
+}
+
+
+/* Takes a request off the queues of any pool other than |self|. Lock order is
+ * pools_mutex, then the mutex of a single pool.
+ */
+static struct uv__work* steal(struct uv__threadpool* self) {
+  struct uv__threadpool* pool;
   struct uv__work* w;
   QUEUE* q;
 
-  (void) arg;
+  w = NULL;
+  uv_mutex_lock(&pools_mutex);
+  QUEUE_FOREACH(q, &pools) {
+    pool = QUEUE_DATA(q, struct uv__threadpool, pool_queue);
+    if (pool == self)
+      continue;
 
-  for (;;) {
-    uv_mutex_lock(&mutex);
+    uv_mutex_lock(&pool->mutex);
+    w = next_work(pool);
+    uv_mutex_unlock(&pool->mutex);
 
-    while (QUEUE_EMPTY(&wq)) {
-      idle_threads += 1;
-      uv_cond_wait(&cond, &mutex);
-      idle_threads -= 1;
-    }
+    if (w != NULL)
+      break;
+  }
+  uv_mutex_unlock(&pools_mutex);
 
-    q = QUEUE_HEAD(&wq);
+  return w;
+}
 
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
-    }
 
-    uv_mutex_unlock(&mutex);
+/* Wakes up an idle worker of another pool to help |self| out. */
+static void wake_thief(struct uv__threadpool* self) {
+  struct uv__threadpool* pool;
+  QUEUE* q;
+  int woken;
+
+  woken = 0;
+  uv_mutex_lock(&pools_mutex);
+  QUEUE_FOREACH(q, &pools) {
+    pool = QUEUE_DATA(q, struct uv__threadpool, pool_queue);
+    if (pool == self)
+      continue;
+
+    uv_mutex_lock(&pool->mutex);
+    if (pool->idle_threads > 1) {
+      uv_cond_signal(&pool->cond);
+      woken = 1;
+    }
+    uv_mutex_unlock(&pool->mutex);
 
-    if (q == &exit_message)
+    if (woken)
       break;
+  }
+  uv_mutex_unlock(&pools_mutex);
+}
+
+
+/* To avoid deadlock with uv_cancel() it's crucial that the worker
+ * never holds a pool mutex and the loop-local mutex at the same time.
+ */
+static void worker(void* arg) {
+  struct uv__threadpool* pool;
+  struct uv__work* w;
+  int tried_stealing;
+
+  pool = arg;
+
+  uv_mutex_lock(&pool->mutex);
+
+  for (;;) {
+    tried_stealing = 0;
+
+    while ((w = next_work(pool)) == NULL) {
+      if (pool->exiting) {
+        uv_mutex_unlock(&pool->mutex);
+        return;
+      }
+
+      /* Help out other pools, but only while another one of our own threads
+       * is left waiting for our own work.
+       */
+      if (!tried_stealing && pool->idle_threads > 0) {
+        tried_stealing = 1;
+        uv_mutex_unlock(&pool->mutex);
+        w = steal(pool);
+        uv_mutex_lock(&pool->mutex);
+        if (w != NULL)
+          break;
+        continue;
+      }
+
+      pool->idle_threads += 1;
+      uv_cond_wait(&pool->cond, &pool->mutex);
+      pool->idle_threads -= 1;
+      tried_stealing = 0;
+    }
+
+    uv_mutex_unlock(&pool->mutex);
 
-    w = QUEUE_DATA(q, struct uv__work, wq);
     w->work(w);
 
     uv_mutex_lock(&w->loop->wq_mutex);
@@ -100,57 +198,118 @@ static void worker(void* arg) {
     QUEUE_INSERT_TAIL(&w->loop->wq, &w->wq);
     uv_async_send(&w->loop->wq_async);
     uv_mutex_unlock(&w->loop->wq_mutex);
+
+    uv_mutex_lock(&pool->mutex);
   }
 }
 
 
-static void post(QUEUE* q) {
-  uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
-  if (idle_threads > 0)
-    uv_cond_signal(&cond);
-  uv_mutex_unlock(&mutex);
+static void post(struct uv__threadpool* pool, struct uv__work* w) {
+  int busy;
+
+  uv_mutex_lock(&pool->mutex);
+  QUEUE_INSERT_TAIL(&pool->wq[w->priority], &w->wq);
+  busy = pool->idle_threads == 0;
+  if (!busy)
+    uv_cond_signal(&pool->cond);
+  uv_mutex_unlock(&pool->mutex);
+
+  if (busy)
+    wake_thief(pool);
 }
 
 
-#ifndef _WIN32
-UV_DESTRUCTOR(static void cleanup(void)) {
+static void pool_init(struct uv__threadpool* pool,
+                      unsigned int nthreads,
+                      uv_thread_t* threads) {
   unsigned int i;
 
-  if (initialized == 0)
-    return;
+  pool->nthreads = nthreads;
+  pool->idle_threads = 0;
+  pool->exiting = 0;
+  pool->threads = threads;
+  QUEUE_INIT(&pool->wq[UV__WORK_LATENCY]);
+  QUEUE_INIT(&pool->wq[UV__WORK_BULK]);
+
+  if (uv_cond_init(&pool->cond))
+    abort();
 
-  post(&exit_message);
+  if (uv_mutex_init(&pool->mutex))
+    abort();
+
+  uv_mutex_lock(&pools_mutex);
+  QUEUE_INSERT_TAIL(&pools, &pool->pool_queue);
+  uv_mutex_unlock(&pools_mutex);
 
   for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+    if (uv_thread_create(threads + i, worker, pool))
       abort();
+}
+
+
+static void pool_destroy(struct uv__threadpool* pool) {
+  unsigned int i;
 
-  if (threads != default_threads)
-    uv__free(threads);
+  uv_mutex_lock(&pools_mutex);
+  QUEUE_REMOVE(&pool->pool_queue);
+  uv_mutex_unlock(&pools_mutex);
 
-  uv_mutex_destroy(&mutex);
-  uv_cond_destroy(&cond);
+  uv_mutex_lock(&pool->mutex);
+  pool->exiting = 1;
+  uv_cond_broadcast(&pool->cond);
+  uv_mutex_unlock(&pool->mutex);
 
-  threads = NULL;
-  nthreads = 0;
+  for (i = 0; i < pool->nthreads; i++)
+    if (uv_thread_join(pool->threads + i))
+      abort();
+
+  uv_mutex_destroy(&pool->mutex);
+  uv_cond_destroy(&pool->cond);
+}
+
+
+#ifndef _WIN32
+UV_DESTRUCTOR(static void cleanup(void)) {
+  if (initialized == 0)
+    return;
+
+  pool_destroy(&default_pool);
+
+  if (default_pool.threads != default_threads)
+    uv__free(default_pool.threads);
+
+  /* pools_mutex stays; loops that were never closed may still have their own
+   * pools running.
+   */
   initialized = 0;
 }
 #endif
 
 
+static unsigned int clamp_threads(unsigned int nthreads) {
+  if (nthreads == 0)
+    nthreads = 1;
+  if (nthreads > MAX_THREADPOOL_SIZE)
+    nthreads = MAX_THREADPOOL_SIZE;
+  return nthreads;
+}
+
+
 static void init_once(void) {
-  unsigned int i;
+  unsigned int nthreads;
+  uv_thread_t* threads;
   const char* val;
 
+  if (uv_mutex_init(&pools_mutex))
+    abort();
+
+  QUEUE_INIT(&pools);
+
   nthreads = ARRAY_SIZE(default_threads);
   val = getenv("UV_THREADPOOL_SIZE");
   if (val != NULL)
     nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
+  nthreads = clamp_threads(nthreads);
 
   threads = default_threads;
   if (nthreads > ARRAY_SIZE(default_threads)) {
@@ -161,38 +320,67 @@ static void init_once(void) {
     }
   }
 
-  if (uv_cond_init(&cond))
-    abort();
+  pool_init(&default_pool, nthreads, threads);
 
-  if (uv_mutex_init(&mutex))
-    abort();
+  initialized = 1;
+}
 
-  QUEUE_INIT(&wq);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
-      abort();
+int uv__threadpool_configure(uv_loop_t* loop, unsigned int nthreads) {
+  struct uv__threadpool* pool;
 
-  initialized = 1;
+  if (nthreads == 0)
+    return UV_EINVAL;
+
+  if (loop->threadpool != NULL)
+    return UV_EBUSY;
+
+  uv_once(&once, init_once);
+
+  nthreads = clamp_threads(nthreads);
+  pool = uv__malloc(sizeof(*pool) + nthreads * sizeof(uv_thread_t));
+  if (pool == NULL)
+    return UV_ENOMEM;
+
+  pool_init(pool, nthreads, (uv_thread_t*) (pool + 1));
+  loop->threadpool = pool;
+
+  return 0;
+}
+
+
+void uv__threadpool_cleanup(uv_loop_t* loop) {
+  if (loop->threadpool == NULL)
+    return;
+
+  pool_destroy(loop->threadpool);
+  uv__free(loop->threadpool);
+  loop->threadpool = NULL;
 }
 
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     enum uv__work_priority priority,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
   uv_once(&once, init_once);
   w->loop = loop;
+  w->pool = loop->threadpool != NULL ? loop->threadpool : &default_pool;
+  w->priority = priority;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  post(w->pool, w);
 }
 
 
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  struct uv__threadpool* pool;
   int cancelled;
 
-  uv_mutex_lock(&mutex);
+  pool = w->pool;
+
+  uv_mutex_lock(&pool->mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
@@ -200,7 +388,7 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
     QUEUE_REMOVE(&w->wq);
 
   uv_mutex_unlock(&w->loop->wq_mutex);
-  uv_mutex_unlock(&mutex);
+  uv_mutex_unlock(&pool->mutex);
 
   if (!cancelled)
     return UV_EBUSY;
@@ -269,7 +457,11 @@ int uv_queue_work(uv_loop_t* loop,
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  &req->work_req,
+                  UV__WORK_BULK,
+                  uv__queue_work,
+                  uv__queue_done);
   return 0;
 }
 
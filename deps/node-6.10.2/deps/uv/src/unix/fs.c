@@ -114,7 +114,11 @@
 #define POST                                                                  \
   do {                                                                        \
     if (cb != NULL) {                                                         \
-      uv__work_submit(loop, &req->work_req, uv__fs_work, uv__fs_done);        \
+      uv__work_submit(loop,                                                   \
+                      &req->work_req,                                         \
+                      uv__fs_priority(req),                                   \
+                      uv__fs_work,                                            \
+                      uv__fs_done);                                           \
       return 0;                                                               \
     }                                                                         \
     else {                                                                    \
@@ -125,6 +129,24 @@
   while (0)
 
 
+/* Reads and writes at least this big go to the bulk queue of the threadpool. */
+#define UV__FS_BULK_SIZE (64 * 1024)
+
+static enum uv__work_priority uv__fs_priority(const uv_fs_t* req) {
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (uv__count_bufs(req->bufs, req->nbufs) >= UV__FS_BULK_SIZE)
+      return UV__WORK_BULK;
+    return UV__WORK_LATENCY;
+  case UV_FS_SENDFILE:
+    return UV__WORK_BULK;
+  default:
+    return UV__WORK_LATENCY;
+  }
+}
+
+
 static ssize_t uv__fs_fdatasync(uv_fs_t* req) {
 #if defined(__linux__) || defined(__sun) || defined(__NetBSD__)
   return fdatasync(req->file);
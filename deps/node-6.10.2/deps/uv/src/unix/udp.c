@@ -36,6 +36,23 @@
 # define IPV6_DROP_MEMBERSHIP IPV6_LEAVE_GROUP
 #endif
 
+/* Largest number of datagrams moved by one recvmmsg() or sendmmsg() call. */
+#define UV__MMSG_MAXWIDTH 32
+
+#if defined(__linux__)
+static uv_once_t once = UV_ONCE_INIT;
+static int uv__recvmmsg_avail;
+static int uv__sendmmsg_avail;
+
+static void uv__udp_mmsg_init(void) {
+  /* Probe with an invalid fd: EBADF means the system call exists. */
+  if (uv__recvmmsg(-1, NULL, 0, 0, NULL) == -1 && errno != ENOSYS)
+    uv__recvmmsg_avail = 1;
+  if (uv__sendmmsg(-1, NULL, 0, 0) == -1 && errno != ENOSYS)
+    uv__sendmmsg_avail = 1;
+}
+#endif
+
 
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents);
@@ -145,6 +162,72 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+#if defined(__linux__)
+/* Reads up to handle->mmsg_count datagrams into consecutive chunks of |buf|
+ * and delivers them one by one, then hands |buf| back. Returns the number of
+ * datagrams read or -1, like recvmsg() returns bytes.
+ */
+static ssize_t uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
+  struct sockaddr_storage peers[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  const struct sockaddr* addr;
+  uv_udp_recv_cb recv_cb;
+  uv_buf_t chunk;
+  ssize_t nread;
+  size_t chunks;
+  ssize_t k;
+  int flags;
+
+  chunks = buf->len / handle->mmsg_size;
+  if (chunks > handle->mmsg_count)
+    chunks = handle->mmsg_count;
+
+  for (k = 0; k < (ssize_t) chunks; k++) {
+    iov[k].iov_base = buf->base + k * handle->mmsg_size;
+    iov[k].iov_len = handle->mmsg_size;
+    memset(&msgs[k], 0, sizeof(msgs[k]));
+    msgs[k].msg_hdr.msg_iov = iov + k;
+    msgs[k].msg_hdr.msg_iovlen = 1;
+    msgs[k].msg_hdr.msg_name = peers + k;
+    msgs[k].msg_hdr.msg_namelen = sizeof(peers[k]);
+  }
+
+  do {
+    nread = uv__recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
+  }
+  while (nread == -1 && errno == EINTR);
+
+  if (nread == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+    else
+      handle->recv_cb(handle, -errno, buf, NULL, 0);
+    return -1;
+  }
+
+  recv_cb = handle->recv_cb;
+  for (k = 0; k < nread && handle->recv_cb != NULL; k++) {
+    if (msgs[k].msg_hdr.msg_namelen == 0)
+      addr = NULL;
+    else
+      addr = (const struct sockaddr*) &peers[k];
+
+    flags = UV_UDP_MMSG_CHUNK;
+    if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+      flags |= UV_UDP_PARTIAL;
+
+    chunk = uv_buf_init(iov[k].iov_base, msgs[k].msg_len);
+    handle->recv_cb(handle, msgs[k].msg_len, &chunk, addr, flags);
+  }
+
+  /* Always handed back, even if a callback above stopped the handle. */
+  recv_cb(handle, 0, buf, NULL, UV_UDP_MMSG_FREE);
+  return nread;
+}
+#endif
+
+
 static void uv__udp_recvmsg(uv_udp_t* handle) {
   struct sockaddr_storage peer;
   struct msghdr h;
@@ -165,13 +248,25 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
   h.msg_name = &peer;
 
   do {
-    handle->alloc_cb((uv_handle_t*) handle, 64 * 1024, &buf);
+    if (handle->mmsg_count > 0)
+      handle->alloc_cb((uv_handle_t*) handle,
+                       handle->mmsg_count * handle->mmsg_size,
+                       &buf);
+    else
+      handle->alloc_cb((uv_handle_t*) handle, 64 * 1024, &buf);
     if (buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
       return;
     }
     assert(buf.base != NULL);
 
+#if defined(__linux__)
+    if (handle->mmsg_count > 0 && buf.len >= handle->mmsg_size) {
+      nread = uv__udp_recvmmsg(handle, &buf);
+      continue;
+    }
+#endif
+
     h.msg_namelen = sizeof(peer);
     h.msg_iov = (void*) &buf;
     h.msg_iovlen = 1;
@@ -209,12 +304,76 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 }
 
 
+#if defined(__linux__)
+/* Sends queued datagrams UV__MMSG_MAXWIDTH at a time, see uv__udp_sendmsg().
+ * sendmmsg() only fails when the first datagram does, so an error completes
+ * that one request and the rest are retried.
+ */
+static void uv__udp_sendmmsg(uv_udp_t* handle) {
+  uv_udp_send_t* req;
+  struct uv__mmsghdr h[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr* p;
+  QUEUE* q;
+  ssize_t npkts;
+  size_t pkts;
+  ssize_t i;
+
+  while (!QUEUE_EMPTY(&handle->write_queue)) {
+    for (pkts = 0, q = QUEUE_HEAD(&handle->write_queue);
+         pkts < UV__MMSG_MAXWIDTH && q != &handle->write_queue;
+         ++pkts, q = QUEUE_NEXT(q)) {
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+
+      p = &h[pkts];
+      memset(p, 0, sizeof(*p));
+      p->msg_hdr.msg_name = &req->addr;
+      p->msg_hdr.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+      p->msg_hdr.msg_iov = (struct iovec*) req->bufs;
+      p->msg_hdr.msg_iovlen = req->nbufs;
+    }
+
+    do {
+      npkts = uv__sendmmsg(handle->io_watcher.fd, h, pkts, 0);
+    } while (npkts == -1 && errno == EINTR);
+
+    if (npkts == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+
+    if (npkts == -1) {
+      q = QUEUE_HEAD(&handle->write_queue);
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      req->status = -errno;
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+    } else {
+      for (i = 0; i < npkts; i++) {
+        q = QUEUE_HEAD(&handle->write_queue);
+        req = QUEUE_DATA(q, uv_udp_send_t, queue);
+        req->status = h[i].msg_len;
+        QUEUE_REMOVE(&req->queue);
+        QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+      }
+    }
+    uv__io_feed(handle->loop, &handle->io_watcher);
+  }
+}
+#endif
+
+
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
   struct msghdr h;
   ssize_t size;
 
+#if defined(__linux__)
+  if (handle->mmsg_count > 0 && uv__sendmmsg_avail) {
+    uv__udp_sendmmsg(handle);
+    return;
+  }
+#endif
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -421,7 +580,12 @@ int uv__udp_send(uv_udp_send_t* req,
   QUEUE_INSERT_TAIL(&handle->write_queue, &req->queue);
   uv__handle_start(handle);
 
-  if (empty_queue && !(handle->flags & UV_UDP_PROCESSING)) {
+  /* In multi-message mode, sends are left for the next poll so that all of
+   * the ones queued by then go out together.
+   */
+  if (empty_queue &&
+      !(handle->flags & UV_UDP_PROCESSING) &&
+      handle->mmsg_count == 0) {
     uv__udp_sendmsg(handle);
   } else {
     uv__io_start(handle->loop, &handle->io_watcher, POLLOUT);
@@ -584,6 +748,8 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned int flags) {
   handle->recv_cb = NULL;
   handle->send_queue_size = 0;
   handle->send_queue_count = 0;
+  handle->mmsg_count = 0;
+  handle->mmsg_size = 0;
   uv__io_init(&handle->io_watcher, uv__udp_io, fd);
   QUEUE_INIT(&handle->write_queue);
   QUEUE_INIT(&handle->write_completed_queue);
@@ -860,6 +1026,24 @@ int uv__udp_recv_start(uv_udp_t* handle,
 }
 
 
+int uv_udp_set_mmsg(uv_udp_t* handle, unsigned int count, size_t size) {
+#if defined(__linux__)
+  if (count > UV__MMSG_MAXWIDTH || (count > 0 && size == 0))
+    return -EINVAL;
+
+  uv_once(&once, uv__udp_mmsg_init);
+  if (count > 0 && !uv__recvmmsg_avail)
+    return -ENOSYS;
+
+  handle->mmsg_count = count;
+  handle->mmsg_size = size;
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
 int uv__udp_recv_stop(uv_udp_t* handle) {
   uv__io_stop(handle->loop, &handle->io_watcher, POLLIN);
 
@@ -110,11 +110,20 @@ void uv__fs_poll_close(uv_fs_poll_t* handle);
 
 int uv__getaddrinfo_translate_error(int sys_err);    /* EAI_* error. */
 
+enum uv__work_priority {
+  UV__WORK_LATENCY,  /* Short requests somebody is waiting on: dns, most fs. */
+  UV__WORK_BULK      /* Long running: uv_queue_work(), big reads and writes. */
+};
+
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work *w,
+                     enum uv__work_priority priority,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 
+int uv__threadpool_configure(uv_loop_t* loop, unsigned int nthreads);
+void uv__threadpool_cleanup(uv_loop_t* loop);
+
 void uv__work_done(uv_async_t* handle);
 
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs);
@@ -166,6 +166,7 @@ int uv_loop_init(uv_loop_t* loop) {
 
   loop->timer_counter = 0;
   loop->stop_flag = 0;
+  loop->threadpool = NULL;
 
   err = uv_mutex_init(&loop->wq_mutex);
   if (err)
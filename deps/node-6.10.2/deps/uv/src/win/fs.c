@@ -46,7 +46,8 @@
 #define QUEUE_FS_TP_JOB(loop, req)                                          \
   do {                                                                      \
     uv__req_register(loop, req);                                            \
-    uv__work_submit((loop), &(req)->work_req, uv__fs_work, uv__fs_done);    \
+    uv__work_submit((loop), &(req)->work_req, uv__fs_priority(req),         \
+                    uv__fs_work, uv__fs_done);                              \
   } while (0)
 
 #define SET_REQ_RESULT(req, result_value)                                   \
@@ -221,6 +222,25 @@ INLINE static int fs__capture_path(uv_fs_t* req, const char* path,
 
 
 
+/* Reads and writes at least this big go to the bulk queue of the threadpool. */
+#define UV__FS_BULK_SIZE (64 * 1024)
+
+static enum uv__work_priority uv__fs_priority(const uv_fs_t* req) {
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (uv__count_bufs(req->fs.info.bufs, req->fs.info.nbufs) >=
+        UV__FS_BULK_SIZE)
+      return UV__WORK_BULK;
+    return UV__WORK_LATENCY;
+  case UV_FS_SENDFILE:
+    return UV__WORK_BULK;
+  default:
+    return UV__WORK_LATENCY;
+  }
+}
+
+
 INLINE static void uv_fs_req_init(uv_loop_t* loop, uv_fs_t* req,
     uv_fs_type fs_type, const uv_fs_cb cb) {
   uv_req_init(loop, (uv_req_t*) req);
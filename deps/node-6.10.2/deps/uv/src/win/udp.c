@@ -178,6 +178,11 @@ int uv_udp_init(uv_loop_t* loop, uv_udp_t* handle) {
 }
 
 
+int uv_udp_set_mmsg(uv_udp_t* handle, unsigned int count, size_t size) {
+  return UV_ENOSYS;
+}
+
+
 void uv_udp_close(uv_loop_t* loop, uv_udp_t* handle) {
   uv_udp_recv_stop(handle);
   closesocket(handle->socket);
@@ -0,0 +1,167 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "task.h"
+#include "uv.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_LOOPS             4
+#define NUM_STATS             1000
+#define NUM_BULK_REQS         16
+#define BULK_MS               5
+
+/* One loop keeps the threadpool busy with bulk work while the others time
+ * stat() requests, one at a time, as a stand-in for latency-sensitive work.
+ */
+struct instance {
+  uv_loop_t loop;
+  uv_thread_t thread;
+  uv_fs_t fs_req;
+  uv_work_t work_reqs[NUM_BULK_REQS];
+  uint64_t start;
+  uint64_t* latencies;
+  int count;
+};
+
+static volatile int stop;
+
+
+static void bulk_work(uv_work_t* req) {
+  uint64_t until;
+
+  until = uv_hrtime() + BULK_MS * (uint64_t) 1e6;
+  while (uv_hrtime() < until);
+}
+
+
+static void bulk_done(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  if (!stop)
+    ASSERT(0 == uv_queue_work(req->loop, req, bulk_work, bulk_done));
+}
+
+
+static void start_stat(struct instance* inst);
+
+
+static void stat_cb(uv_fs_t* req) {
+  struct instance* inst = container_of(req, struct instance, fs_req);
+
+  ASSERT(req->result == 0);
+  inst->latencies[inst->count++] = uv_hrtime() - inst->start;
+  uv_fs_req_cleanup(req);
+
+  if (inst->count < NUM_STATS)
+    start_stat(inst);
+}
+
+
+static void start_stat(struct instance* inst) {
+  inst->start = uv_hrtime();
+  ASSERT(0 == uv_fs_stat(&inst->loop, &inst->fs_req, ".", stat_cb));
+}
+
+
+static void run_loop(void* arg) {
+  struct instance* inst = arg;
+  ASSERT(0 == uv_run(&inst->loop, UV_RUN_DEFAULT));
+}
+
+
+static int compare(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
+  return x < y ? -1 : x > y;
+}
+
+
+static void fairness(const char* name, unsigned int threads_per_loop) {
+  struct instance instances[NUM_LOOPS];
+  struct instance* inst;
+  uint64_t* latencies;
+  int total;
+  int i;
+
+  total = (NUM_LOOPS - 1) * NUM_STATS;
+  latencies = malloc(total * sizeof(latencies[0]));
+  ASSERT(latencies != NULL);
+
+  stop = 0;
+
+  for (i = 0; i < NUM_LOOPS; i++) {
+    inst = instances + i;
+    inst->count = 0;
+    inst->latencies = i > 0 ? latencies + (i - 1) * NUM_STATS : NULL;
+    ASSERT(0 == uv_loop_init(&inst->loop));
+    if (threads_per_loop > 0)
+      ASSERT(0 == uv_loop_configure(&inst->loop,
+                                    UV_LOOP_THREADPOOL_SIZE,
+                                    threads_per_loop));
+  }
+
+  for (i = 0; i < NUM_BULK_REQS; i++)
+    ASSERT(0 == uv_queue_work(&instances[0].loop,
+                              instances[0].work_reqs + i,
+                              bulk_work,
+                              bulk_done));
+
+  for (i = 1; i < NUM_LOOPS; i++)
+    start_stat(instances + i);
+
+  for (i = 0; i < NUM_LOOPS; i++)
+    ASSERT(0 == uv_thread_create(&instances[i].thread,
+                                 run_loop,
+                                 instances + i));
+
+  for (i = 1; i < NUM_LOOPS; i++)
+    ASSERT(0 == uv_thread_join(&instances[i].thread));
+
+  stop = 1;
+  ASSERT(0 == uv_thread_join(&instances[0].thread));
+
+  for (i = 0; i < NUM_LOOPS; i++)
+    ASSERT(0 == uv_loop_close(&instances[i].loop));
+
+  qsort(latencies, total, sizeof(latencies[0]), compare);
+
+  printf("%s: stat latency p50 %.3fms, p99 %.3fms, max %.3fms\n",
+         name,
+         latencies[total / 2] / 1e6,
+         latencies[total * 99 / 100] / 1e6,
+         latencies[total - 1] / 1e6);
+  fflush(stdout);
+
+  free(latencies);
+}
+
+
+/* Compares the latency of small requests from three loops while a fourth one
+ * floods the threadpool, with all loops sharing the default pool and with a
+ * pool of their own for each loop.
+ */
+BENCHMARK_IMPL(threadpool_fairness) {
+  fairness("shared pool", 0);
+  fairness("pool per loop", 2);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -74,3 +74,85 @@ TEST_IMPL(threadpool_queue_work_einval) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+
+static uv_sem_t bulk_sem;
+static int bulk_cb_count;
+static int stat_cb_count;
+
+
+static void bulk_work_cb(uv_work_t* req) {
+  if (req->data == &bulk_sem)
+    uv_sem_wait(&bulk_sem);
+}
+
+
+static void bulk_after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  /* The stat() was queued after the second bulk request but ran first. */
+  if (req->data != &bulk_sem)
+    ASSERT(stat_cb_count == 1);
+  bulk_cb_count++;
+}
+
+
+static void stat_cb(uv_fs_t* req) {
+  ASSERT(req->result == 0);
+  ASSERT(bulk_cb_count <= 1);
+  uv_fs_req_cleanup(req);
+  stat_cb_count++;
+}
+
+
+TEST_IMPL(threadpool_loop_configure) {
+  uv_loop_t loop;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(UV_EINVAL == uv_loop_configure(&loop, UV_LOOP_THREADPOOL_SIZE, 0));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_THREADPOOL_SIZE, 2));
+  ASSERT(UV_EBUSY == uv_loop_configure(&loop, UV_LOOP_THREADPOOL_SIZE, 2));
+
+  work_req.data = &data;
+  ASSERT(0 == uv_queue_work(&loop, &work_req, work_cb, after_work_cb));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+
+  ASSERT(work_cb_count == 1);
+  ASSERT(after_work_cb_count == 1);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_latency_priority) {
+  uv_work_t bulk_reqs[2];
+  uv_fs_t stat_req;
+  uv_loop_t loop;
+
+  ASSERT(0 == uv_sem_init(&bulk_sem, 0));
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_THREADPOOL_SIZE, 1));
+
+  /* The first request keeps the only thread busy until both others are
+   * queued.
+   */
+  bulk_reqs[0].data = &bulk_sem;
+  bulk_reqs[1].data = NULL;
+  ASSERT(0 == uv_queue_work(&loop, bulk_reqs + 0,
+                            bulk_work_cb, bulk_after_work_cb));
+  ASSERT(0 == uv_queue_work(&loop, bulk_reqs + 1,
+                            bulk_work_cb, bulk_after_work_cb));
+  ASSERT(0 == uv_fs_stat(&loop, &stat_req, ".", stat_cb));
+  uv_sem_post(&bulk_sem);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+
+  ASSERT(stat_cb_count == 1);
+  ASSERT(bulk_cb_count == 2);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  uv_sem_destroy(&bulk_sem);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
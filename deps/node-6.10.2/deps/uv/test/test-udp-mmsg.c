@@ -0,0 +1,168 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_HANDLE(handle) \
+  ASSERT((uv_udp_t*)(handle) == &server || (uv_udp_t*)(handle) == &client)
+
+#define NUM_SENDS 40
+#define MMSG_COUNT 8
+#define MMSG_SIZE 256
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_reqs[NUM_SENDS];
+static char send_data[NUM_SENDS][4];
+
+static int alloc_cb_called;
+static int recv_cb_called;
+static int free_cb_called;
+static int send_cb_called;
+static int close_cb_called;
+static int received[NUM_SENDS];
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  CHECK_HANDLE(handle);
+  ASSERT(suggested_size == MMSG_COUNT * MMSG_SIZE);
+  buf->base = malloc(suggested_size);
+  ASSERT(buf->base != NULL);
+  buf->len = suggested_size;
+  alloc_cb_called++;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  CHECK_HANDLE(handle);
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  int i;
+
+  ASSERT(handle == &server);
+  ASSERT(nread >= 0);
+
+  if (flags & UV_UDP_MMSG_FREE) {
+    ASSERT(nread == 0);
+    ASSERT(addr == NULL);
+    ASSERT(buf->len == MMSG_COUNT * MMSG_SIZE);
+    free_cb_called++;
+    free(buf->base);
+    return;
+  }
+
+  if (nread == 0) {
+    /* Nothing read, the buffer is ours to free. */
+    ASSERT(addr == NULL);
+    free(buf->base);
+    return;
+  }
+
+  ASSERT(flags & UV_UDP_MMSG_CHUNK);
+  ASSERT(!(flags & UV_UDP_PARTIAL));
+  ASSERT(addr != NULL);
+  ASSERT(nread == 4);
+  ASSERT(buf->len == 4);
+  ASSERT(memcmp(buf->base, "PNG", 3) == 0);
+
+  i = (unsigned char) buf->base[3];
+  ASSERT(i < NUM_SENDS);
+  ASSERT(received[i] == 0);
+  received[i] = 1;
+
+  if (++recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT(status == 0);
+  CHECK_HANDLE(req->handle);
+  send_cb_called++;
+}
+
+
+TEST_IMPL(udp_mmsg) {
+  struct sockaddr_in addr;
+  uv_buf_t buf;
+  int i;
+  int r;
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT(0 == uv_udp_init(uv_default_loop(), &server));
+  r = uv_udp_set_mmsg(&server, MMSG_COUNT, MMSG_SIZE);
+  if (r == UV_ENOSYS)
+    RETURN_SKIP("recvmmsg() not supported on this platform");
+  ASSERT(r == 0);
+  ASSERT(UV_EINVAL == uv_udp_set_mmsg(&server, 1000, MMSG_SIZE));
+  ASSERT(UV_EINVAL == uv_udp_set_mmsg(&server, MMSG_COUNT, 0));
+
+  ASSERT(0 == uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_udp_recv_start(&server, alloc_cb, recv_cb));
+
+  /* All of the sends are queued before the next poll, so they go out in
+   * batches too.
+   */
+  ASSERT(0 == uv_udp_init(uv_default_loop(), &client));
+  ASSERT(0 == uv_udp_set_mmsg(&client, MMSG_COUNT, MMSG_SIZE));
+  for (i = 0; i < NUM_SENDS; i++) {
+    memcpy(send_data[i], "PNG", 3);
+    send_data[i][3] = (char) i;
+    buf = uv_buf_init(send_data[i], 4);
+    ASSERT(0 == uv_udp_send(&send_reqs[i],
+                            &client,
+                            &buf,
+                            1,
+                            (const struct sockaddr*) &addr,
+                            send_cb));
+  }
+  ASSERT(client.send_queue_count == NUM_SENDS);
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT(send_cb_called == NUM_SENDS);
+  ASSERT(recv_cb_called == NUM_SENDS);
+  ASSERT(free_cb_called >= (NUM_SENDS + MMSG_COUNT - 1) / MMSG_COUNT);
+  ASSERT(free_cb_called <= alloc_cb_called);
+  ASSERT(close_cb_called == 2);
+  for (i = 0; i < NUM_SENDS; i++)
+    ASSERT(received[i] == 1);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
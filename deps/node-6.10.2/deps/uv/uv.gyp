@@ -401,6 +401,7 @@
         'test/test-udp-create-socket-early.c',
         'test/test-udp-dgram-too-big.c',
         'test/test-udp-ipv6.c',
+        'test/test-udp-mmsg.c',
         'test/test-udp-open.c',
         'test/test-udp-options.c',
         'test/test-udp-send-and-recv.c',
@@ -479,6 +480,7 @@
         'test/benchmark-sizes.c',
         'test/benchmark-spawn.c',
         'test/benchmark-thread.c',
+        'test/benchmark-threadpool-fairness.c',
         'test/benchmark-tcp-write-batch.c',
         'test/benchmark-udp-pummel.c',
         'test/dns-server.c',
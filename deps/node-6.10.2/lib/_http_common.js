@@ -44,7 +44,7 @@ function parserOnHeaders(headers, url) {
 // all our parsers are request parsers.
 function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
                                  url, statusCode, statusMessage, upgrade,
-                                 shouldKeepAlive) {
+                                 shouldKeepAlive, contentLength) {
   var parser = this;
 
   if (!headers) {
@@ -62,6 +62,7 @@ function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
   parser.incoming.httpVersionMinor = versionMinor;
   parser.incoming.httpVersion = versionMajor + '.' + versionMinor;
   parser.incoming.url = url;
+  parser.incoming.contentLength = contentLength;
 
   var n = headers.length;
 
@@ -2,6 +2,9 @@
 
 const util = require('util');
 const Stream = require('stream');
+// Lower case names of the well-known headers, keyed by the spellings the HTTP
+// parser hands out as internalized strings.
+const knownHeaders = process.binding('http_parser').knownHeaders;
 
 function readStart(socket) {
   if (socket && !socket._paused && socket.readable)
@@ -33,6 +36,7 @@ function IncomingMessage(socket) {
   this.httpVersionMajor = null;
   this.httpVersionMinor = null;
   this.httpVersion = null;
+  this.contentLength = undefined;
   this.complete = false;
   this.headers = {};
   this.rawHeaders = [];
@@ -130,7 +134,7 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 // and drop the second. Extended header fields (those beginning with 'x-') are
 // always joined.
 IncomingMessage.prototype._addHeaderLine = function(field, value, dest) {
-  field = field.toLowerCase();
+  field = knownHeaders[field] || field.toLowerCase();
   switch (field) {
     // Array headers:
     case 'set-cookie':
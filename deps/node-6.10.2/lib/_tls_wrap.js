@@ -997,6 +997,44 @@ function normalizeConnectArgs(listArgs) {
   return (cb) ? [options, cb] : [options];
 }
 
+// Options that change what a server would accept, and so are part of the key
+// of a session in the client session cache along with the peer.
+const sessionCacheKeyOptions = [
+  'ALPNProtocols', 'NPNProtocols', 'ca', 'cert', 'ciphers', 'crl',
+  'ecdhCurve', 'key', 'passphrase', 'pfx', 'rejectUnauthorized',
+  'secureOptions', 'secureProtocol'
+];
+
+// Serializes an option so that different values never give the same string:
+// strings quoted, Buffers by their bytes, arrays entry by entry and the
+// {pem, passphrase} entries of a key array by those two fields.
+function sessionCacheKeyValue(value) {
+  if (value === undefined || value === null)
+    return '';
+  if (typeof value === 'string')
+    return JSON.stringify(value);
+  if (value instanceof Buffer)
+    return 'b' + value.toString('base64');
+  if (Array.isArray(value)) {
+    var values = new Array(value.length);
+    for (var i = 0; i < value.length; i++)
+      values[i] = sessionCacheKeyValue(value[i]);
+    return '[' + values.join(',') + ']';
+  }
+  if (typeof value === 'object') {
+    return '{' + sessionCacheKeyValue(value.pem) + ',' +
+           sessionCacheKeyValue(value.passphrase) + '}';
+  }
+  return String(value);
+}
+
+function sessionCacheKey(options, servername) {
+  var key = `${options.host}:${options.port}:${options.path}:${servername}`;
+  for (var i = 0; i < sessionCacheKeyOptions.length; i++)
+    key += ':' + sessionCacheKeyValue(options[sessionCacheKeyOptions[i]]);
+  return key;
+}
+
 exports.connect = function(/* [port,] [host,] [options,] [cb] */) {
   const argsLen = arguments.length;
   var args = new Array(argsLen);
@@ -1031,6 +1069,20 @@ exports.connect = function(/* [port,] [host,] [options,] [cb] */) {
   const NPN = {};
   const ALPN = {};
   const context = options.secureContext || tls.createSecureContext(options);
+
+  // Sessions are cached for the whole process unless the caller manages
+  // them, or the context or the transport, itself.  Nor are they cached for
+  // callers with a checkServerIdentity() of their own: a resumed session
+  // skips it, so a session verified by another one must not be resumed.
+  var cacheKey = null;
+  if (options.sessionCache !== false &&
+      !options.session &&
+      !options.secureContext &&
+      !options.socket &&
+      options.checkServerIdentity === tls.checkServerIdentity) {
+    cacheKey = sessionCacheKey(options, hostname);
+  }
+
   tls.convertNPNProtocols(options.NPNProtocols, NPN);
   tls.convertALPNProtocols(options.ALPNProtocols, ALPN);
 
@@ -1070,6 +1122,8 @@ exports.connect = function(/* [port,] [host,] [options,] [cb] */) {
 
   if (options.session)
     socket.setSession(options.session);
+  else if (cacheKey !== null)
+    socket._handle.setSessionCacheKey(cacheKey);
 
   if (options.servername)
     socket.setServername(options.servername);
@@ -1110,6 +1164,8 @@ exports.connect = function(/* [port,] [host,] [options,] [cb] */) {
       }
     } else {
       socket.authorized = true;
+      if (cacheKey !== null)
+        socket._handle.cacheSession();
       socket.emit('secureConnect');
     }
 
@@ -1128,5 +1184,13 @@ exports.connect = function(/* [port,] [host,] [options,] [cb] */) {
   }
   socket.once('end', onHangUp);
 
+  // Do not try to resume a session with a peer that failed.
+  if (cacheKey !== null) {
+    socket.once('close', (hadError) => {
+      if (hadError)
+        tls_wrap.evictSession(cacheKey);
+    });
+  }
+
   return socket;
 };
@@ -82,6 +82,28 @@ Hash.prototype.digest = function(outputEncoding) {
 };
 
 
+exports.hashMany = function(algorithm, data, outputEncoding, callback) {
+  if (typeof outputEncoding === 'function') {
+    callback = outputEncoding;
+    outputEncoding = undefined;
+  }
+  if (typeof algorithm !== 'string')
+    throw new TypeError('"algorithm" argument must be a string');
+  if (!Array.isArray(data))
+    throw new TypeError('"data" argument must be an array');
+  if (callback !== undefined && typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+  const digests = binding.hashMany(algorithm, data, outputEncoding, callback);
+  // Small batches are hashed synchronously even when there is a callback.
+  if (callback !== undefined && Array.isArray(digests))
+    process.nextTick(callback, null, digests);
+  else if (callback === undefined)
+    return digests;
+};
+
+
 exports.createHmac = exports.Hmac = Hmac;
 
 function Hmac(hmac, key, options) {
@@ -98,6 +98,18 @@ function Socket(type, listener) {
   // If true - UV_UDP_REUSEADDR flag will be set
   this._reuseAddr = options && options.reuseAddr;
 
+  // If set - datagrams are read and sent in batches, see startListening()
+  this._batch = null;
+  if (options && options.batch != null) {
+    const count = options.batch.count;
+    const size = options.batch.size;
+    if (!Number.isInteger(count) || count < 1 || count > 32)
+      throw new RangeError('"batch.count" must be an integer from 1 to 32');
+    if (!Number.isInteger(size) || size < 1 || size > 65536)
+      throw new RangeError('"batch.size" must be an integer from 1 to 65536');
+    this._batch = { count: count, size: size };
+  }
+
   if (typeof listener === 'function')
     this.on('message', listener);
 }
@@ -112,6 +124,11 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onmessages = onMessages;
+  // Where recvmmsg() is not available this fails with ENOSYS and the
+  // socket keeps reading one datagram at a time.
+  if (socket._batch)
+    socket._handle.setMmsg(socket._batch.count, socket._batch.size);
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -550,6 +567,21 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+function onMessages(handle, messages) {
+  var self = handle.owner;
+  for (var i = 0; i < messages.length; i++)
+    messages[i][1].size = messages[i][0].length; // compatibility
+
+  if (self.listenerCount('messages') > 0) {
+    self.emit('messages', messages);
+    return;
+  }
+
+  for (i = 0; i < messages.length && self._handle; i++)
+    self.emit('message', messages[i][0], messages[i][1]);
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
@@ -155,6 +155,15 @@ exports.lookup = function lookup(hostname, options, callback) {
     return {};
   }
 
+  var cached = cares.getaddrinfoCached(hostname, family, hints);
+  if (cached !== undefined) {
+    const oncomplete = all ? onlookupall : onlookup;
+    oncomplete.call({ callback: callback, family: family, hostname: hostname },
+                    typeof cached === 'number' ? cached : 0,
+                    cached);
+    return {};
+  }
+
   var req = new GetAddrInfoReqWrap();
   req.callback = callback;
   req.family = family;
@@ -219,8 +228,12 @@ function onresolve(err, result) {
 }
 
 
+// Families of the queries whose answers are cached, see dns.setCacheOptions().
+const cachedQueries = { queryA: 4, queryAaaa: 6 };
+
 function resolver(bindingName) {
   var binding = cares[bindingName];
+  var cacheFamily = cachedQueries[bindingName];
 
   return function query(name, callback) {
     if (typeof name !== 'string') {
@@ -230,6 +243,19 @@ function resolver(bindingName) {
     }
 
     callback = makeAsync(callback);
+
+    if (cacheFamily !== undefined) {
+      const cached = cares.queryCached(cacheFamily, name);
+      if (cached !== undefined) {
+        onresolve.call({ bindingName: bindingName,
+                         callback: callback,
+                         hostname: name },
+                       typeof cached === 'string' ? cached : null,
+                       cached);
+        return {};
+      }
+    }
+
     var req = new QueryReqWrap();
     req.bindingName = bindingName;
     req.callback = callback;
@@ -291,21 +317,22 @@ exports.setServers = function(servers) {
   servers.forEach((serv) => {
     var ipVersion = isIP(serv);
     if (ipVersion !== 0)
-      return newSet.push([ipVersion, serv]);
+      return newSet.push([ipVersion, serv, 0]);
 
-    const match = serv.match(/\[(.*)\](?::\d+)?/);
+    const match = serv.match(/\[(.*)\](?::(\d+))?/);
     // we have an IPv6 in brackets
     if (match) {
       ipVersion = isIP(match[1]);
       if (ipVersion !== 0)
-        return newSet.push([ipVersion, match[1]]);
+        return newSet.push([ipVersion, match[1], match[2] | 0]);
     }
 
+    const port = serv.match(/:(\d+)$/);
     const s = serv.split(/:\d+$/)[0];
     ipVersion = isIP(s);
 
     if (ipVersion !== 0)
-      return newSet.push([ipVersion, s]);
+      return newSet.push([ipVersion, s, port ? port[1] | 0 : 0]);
 
     throw new Error(`IP address is not properly formatted: ${serv}`);
   });
@@ -321,6 +348,42 @@ exports.setServers = function(servers) {
   }
 };
 
+exports.setCacheOptions = function(options) {
+  if (options === null || typeof options !== 'object')
+    throw new TypeError('"options" argument must be an object');
+
+  // -1 keeps the current setting.
+  var ttl = -1;
+  var negativeTtl = -1;
+  var maxEntries = -1;
+
+  if (options.ttl !== undefined) {
+    if (typeof options.ttl !== 'number' || !(options.ttl >= 0))
+      throw new TypeError('"ttl" option must be a non-negative number');
+    ttl = options.ttl * 1000;
+  }
+  if (options.negativeTtl !== undefined) {
+    if (typeof options.negativeTtl !== 'number' || !(options.negativeTtl >= 0))
+      throw new TypeError('"negativeTtl" option must be a non-negative number');
+    negativeTtl = options.negativeTtl * 1000;
+  }
+  if (options.maxEntries !== undefined) {
+    if (!Number.isSafeInteger(options.maxEntries) || options.maxEntries < 0)
+      throw new TypeError('"maxEntries" option must be a non-negative integer');
+    maxEntries = options.maxEntries;
+  }
+
+  cares.setCacheOptions(ttl, negativeTtl, maxEntries);
+};
+
+exports.getCacheStats = function() {
+  return cares.getCacheStats();
+};
+
+exports.clearCache = function() {
+  cares.clearCache();
+};
+
 // uv_getaddrinfo flags
 exports.ADDRCONFIG = cares.AI_ADDRCONFIG;
 exports.V4MAPPED = cares.AI_V4MAPPED;
@@ -69,6 +69,11 @@ function createConnection(port, host, options) {
 
   debug('createConnection', options);
 
+  // An agent given its own session limit does not share sessions with the
+  // rest of the process.
+  if (this.options.maxCachedSessions !== undefined)
+    options = util._extend({ sessionCache: false }, options);
+
   if (options._agentKey) {
     const session = this._getSession(options._agentKey);
     if (session) {
@@ -398,11 +398,7 @@
   // core modules found in lib/*.js. All core modules are compiled into the
   // node binary, so they can be loaded faster.
 
-  const ContextifyScript = process.binding('contextify').ContextifyScript;
-  function runInThisContext(code, options) {
-    const script = new ContextifyScript(code, options);
-    return script.runInThisContext();
-  }
+  const codeCache = process.binding('code_cache');
 
   function NativeModule(id) {
     this.filename = `${id}.js`;
@@ -488,11 +484,9 @@
     this.loading = true;
 
     try {
-      const fn = runInThisContext(source, {
-        filename: this.filename,
-        lineOffset: 0,
-        displayErrors: true
-      });
+      // Compiled through the process-wide code cache, which is shared by
+      // every instance bootstrapping from the same core library sources.
+      const fn = codeCache.runInThisContext(source, this.filename);
       fn(this.exports, NativeModule.require, this, this.filename);
 
       this.loaded = true;
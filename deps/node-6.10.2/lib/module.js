@@ -10,6 +10,10 @@ const fs = require('fs');
 const path = require('path');
 const internalModuleReadFile = process.binding('fs').internalModuleReadFile;
 const internalModuleStat = process.binding('fs').internalModuleStat;
+const internalModuleCompile = process.binding('fs').internalModuleCompile;
+const internalModuleRealpath = process.binding('fs').internalModuleRealpath;
+const internalModulePackageMain =
+    process.binding('fs').internalModulePackageMain;
 const preserveSymlinks = !!process.binding('config').preserveSymlinks;
 
 // If obj.hasOwnProperty has been overridden, then calling
@@ -77,6 +81,11 @@ const debug = Module._debug;
 const packageMainCache = {};
 
 function readPackage(requestPath) {
+  // The binding keeps its own cache, which, unlike packageMainCache, is
+  // dropped when files are written.
+  if (internalModulePackageMain !== undefined)
+    return readPackageMain(requestPath);
+
   if (hasOwnProperty(packageMainCache, requestPath)) {
     return packageMainCache[requestPath];
   }
@@ -98,6 +107,19 @@ function readPackage(requestPath) {
   return pkg;
 }
 
+function readPackageMain(requestPath) {
+  const jsonPath = path.resolve(requestPath, 'package.json');
+  var pkg;
+  try {
+    pkg = internalModulePackageMain(path._makeLong(jsonPath));
+  } catch (e) {
+    e.path = jsonPath;
+    e.message = 'Error parsing ' + jsonPath + ': ' + e.message;
+    throw e;
+  }
+  return pkg === undefined ? false : pkg;
+}
+
 function tryPackage(requestPath, exts, isMain) {
   var pkg = readPackage(requestPath);
 
@@ -130,6 +152,11 @@ function tryFile(requestPath, isMain) {
 }
 
 function toRealPath(requestPath) {
+  if (internalModuleRealpath !== undefined) {
+    const realPath = internalModuleRealpath(path.resolve(requestPath));
+    if (realPath !== undefined)
+      return realPath;
+  }
   return fs.realpathSync(requestPath, {
     [realpathCacheKey]: realpathCache
   });
@@ -545,6 +572,11 @@ Module.prototype._compile = function(content, filename) {
     displayErrors: true
   });
 
+  return runCompiledWrapper(this, compiledWrapper, filename);
+};
+
+
+function runCompiledWrapper(module, compiledWrapper, filename) {
   if (process._debugWaitConnect && process._eval == null) {
     if (!resolvedArgv) {
       // we enter the repl if we're not given a filename argument.
@@ -563,18 +595,43 @@ Module.prototype._compile = function(content, filename) {
     }
   }
   var dirname = path.dirname(filename);
-  var require = internalModule.makeRequireFunction.call(this);
-  var args = [this.exports, require, this, filename, dirname];
+  var require = internalModule.makeRequireFunction.call(module);
+  var args = [module.exports, require, module, filename, dirname];
   var depth = internalModule.requireDepth;
   if (depth === 0) stat.cache = new Map();
-  var result = compiledWrapper.apply(this.exports, args);
+  var result = compiledWrapper.apply(module.exports, args);
   if (depth === 0) stat.cache = null;
   return result;
-};
+}
+
+
+const defaultCompile = Module.prototype._compile;
+const defaultWrap = Module.wrap;
+const defaultWrapper = Module.wrapper.slice();
+
+// The binding compiles the file itself, sharing the source and the code
+// cache with every other instance in the process that loads it, as long as
+// nobody changed how modules are wrapped and compiled.
+function canCompileInternally(module) {
+  return internalModuleCompile !== undefined &&
+         module._compile === defaultCompile &&
+         Module.wrap === defaultWrap &&
+         Module.wrapper[0] === defaultWrapper[0] &&
+         Module.wrapper[1] === defaultWrapper[1];
+}
 
 
 // Native extension for .js
 Module._extensions['.js'] = function(module, filename) {
+  if (canCompileInternally(module)) {
+    var compiledWrapper = internalModuleCompile(filename,
+                                                Module.wrapper[0],
+                                                Module.wrapper[1]);
+    if (compiledWrapper !== undefined) {
+      runCompiledWrapper(module, compiledWrapper, filename);
+      return;
+    }
+  }
   var content = fs.readFileSync(filename, 'utf8');
   module._compile(internalModule.stripBOM(content), filename);
 };
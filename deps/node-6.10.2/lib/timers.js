@@ -1,6 +1,7 @@
 'use strict';
 
 const TimerWrap = process.binding('timer_wrap').Timer;
+const TimerWheel = process.binding('timer_wheel').TimerWheel;
 const L = require('internal/linkedlist');
 const assert = require('assert');
 const util = require('util');
@@ -83,6 +84,16 @@ const TIMEOUT_MAX = 2147483647; // 2^31-1
 // timers within (or creation of a new list).
 // However, these operations combined have shown to be trivial in comparison to
 // other alternative timers architectures.
+//
+// That stops being true when there are tens of thousands of distinct
+// durations, as with socket and request timeouts that are computed rather than
+// fixed: every list then costs a TimerWrap and a libuv heap operation. Running
+// with --timer-wheel (or NODE_TIMER_WHEEL=1) keeps every timer in one
+// hierarchical timing wheel in C++ instead (src/timer_wheel.cc). The wheel
+// inserts and cancels in constant time, is driven by a single libuv timer and
+// hands everything that expires on a tick to `wheelOnTimeout()` at once.
+const useTimerWheel = !!process.binding('config').timerWheel ||
+                      process.env.NODE_TIMER_WHEEL === '1';
 
 
 // Object maps containing linked lists of timers, keyed and sorted by their
@@ -122,6 +133,11 @@ function insert(item, unrefed) {
 
   item._idleStart = TimerWrap.now();
 
+  if (useTimerWheel) {
+    wheelInsert(item, msecs, unrefed === true);
+    return;
+  }
+
   const lists = unrefed === true ? unrefedLists : refedLists;
 
   // Use an existing list if there is one, otherwise we need to make a new one.
@@ -271,6 +287,116 @@ function listOnTimeoutNT(list) {
 }
 
 
+// The TimerWheel, created on first use, and the timers it holds, indexed by the
+// id of their wheel entry.
+var wheel = null;
+const wheelTimers = [];
+
+function wheelInsert(item, msecs, unrefed) {
+  if (item._wheelId >= 0) {
+    // Sockets re-arm their timeout on every read and write. If the pending
+    // entry is not due any later, leave it alone: `wheelRunTimers()` moves it
+    // along if it turns out to fire early.
+    if (item._wheelExpiry <= item._idleStart + msecs &&
+        item._wheelUnrefed === unrefed) {
+      return;
+    }
+    wheelRemove(item);
+  }
+  wheelAdd(item, item._idleStart, msecs, unrefed);
+}
+
+function wheelAdd(item, now, delay, unrefed) {
+  if (wheel === null) {
+    wheel = new TimerWheel();
+    wheel[kOnTimeout] = wheelOnTimeout;
+  }
+  const id = wheel.add(delay, !unrefed);
+  wheelTimers[id] = item;
+  item._wheelId = id;
+  item._wheelExpiry = now + delay;
+  item._wheelUnrefed = unrefed;
+}
+
+function wheelRemove(item) {
+  const id = item._wheelId;
+  if (id >= 0) {
+    wheel.remove(id);
+    wheelTimers[id] = undefined;
+    item._wheelId = -1;
+  }
+}
+
+function wheelOnTimeout(timers) {
+  // `timers` holds the ids of the expired entries. The wheel has already
+  // released them and callbacks may add timers that reuse them, so swap every
+  // id for its timer before running any.
+  for (var i = 0; i < timers.length; i++) {
+    const id = timers[i];
+    const timer = wheelTimers[id];
+    wheelTimers[id] = undefined;
+    timer._wheelId = -1;
+    timers[i] = timer;
+  }
+  wheelRunTimers(timers, 0);
+}
+
+function wheelRunTimers(timers, start) {
+  debug('wheel timeout callback for %d timers', timers.length - start);
+
+  var now = TimerWrap.now();
+
+  for (var i = start; i < timers.length; i++) {
+    const timer = timers[i];
+    const msecs = timer._idleTimeout;
+
+    // Skip timers that an earlier callback has cleared or re-armed.
+    if (msecs < 0 || msecs === undefined || timer._wheelId >= 0) continue;
+
+    var diff = now - timer._idleStart;
+    if (diff < msecs) {
+      // The timer was re-armed after its entry was added, wait out the rest.
+      wheelAdd(timer, now, msecs - diff, timer._wheelUnrefed);
+      continue;
+    }
+
+    if (!timer._onTimeout) continue;
+
+    var domain = timer.domain;
+    if (domain) {
+      // Same as in `listOnTimeout()`.
+      if (domain._disposed)
+        continue;
+
+      domain.enter();
+    }
+
+    tryOnWheelTimeout(timer, timers, i);
+
+    if (domain)
+      domain.exit();
+  }
+}
+
+function tryOnWheelTimeout(timer, timers, index) {
+  timer._called = true;
+  var threw = true;
+  try {
+    ontimeout(timer);
+    threw = false;
+  } finally {
+    if (threw) {
+      // Run the timers that expired on the same tick once the exception has
+      // been handled, outside of whatever domain the timeout left behind.
+      const domain = process.domain;
+      process.domain = null;
+      process.nextTick(wheelRunTimers, timers, index + 1);
+      process.domain = domain;
+    }
+  }
+}
+
+
 // A convenience function for re-using TimerWrap handles more easily.
 //
 // This mostly exists to fix https://github.com/nodejs/node/issues/1264.
@@ -295,10 +421,14 @@ function reuse(item) {
 
 // Remove a timer. Cancels the timeout and resets the relevant timer properties.
 const unenroll = exports.unenroll = function(item) {
-  var handle = reuse(item);
-  if (handle) {
-    debug('unenroll: list empty');
-    handle.close();
+  if (useTimerWheel) {
+    wheelRemove(item);
+  } else {
+    var handle = reuse(item);
+    if (handle) {
+      debug('unenroll: list empty');
+      handle.close();
+    }
   }
   // if active is called later, then we want to make sure not to insert again
   item._idleTimeout = -1;
@@ -407,7 +537,7 @@ function rearm(timer) {
     timer._handle.start(timer._repeat);
   } else {
     timer._idleTimeout = timer._repeat;
-    active(timer);
+    insert(timer, timer._wheelUnrefed === true);
   }
 }
 
@@ -477,6 +607,9 @@ function Timeout(after, callback, args) {
   this._onTimeout = callback;
   this._timerArgs = args;
   this._repeat = null;
+  this._wheelId = -1;
+  this._wheelExpiry = 0;
+  this._wheelUnrefed = false;
 }
 
 
@@ -498,6 +631,8 @@ function unrefdHandle() {
 Timeout.prototype.unref = function() {
   if (this._handle) {
     this._handle.unref();
+  } else if (useTimerWheel) {
+    wheelSetUnrefed(this, true);
   } else if (typeof this._onTimeout === 'function') {
     var now = TimerWrap.now();
     if (!this._idleStart) this._idleStart = now;
@@ -525,9 +660,25 @@ Timeout.prototype.unref = function() {
 Timeout.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
+  else if (useTimerWheel)
+    wheelSetUnrefed(this, false);
   return this;
 };
 
+// With the timer wheel, unref()'d timers stay in the wheel; their entries just
+// stop keeping the event loop alive.
+function wheelSetUnrefed(timer, unrefed) {
+  if (timer._wheelUnrefed === unrefed) return;
+  timer._wheelUnrefed = unrefed;
+  if (timer._wheelId < 0) return;
+
+  const now = TimerWrap.now();
+  var delay = timer._idleStart + timer._idleTimeout - now;
+  if (delay < 0) delay = 0;
+  wheelRemove(timer);
+  wheelAdd(timer, now, delay, unrefed);
+}
+
 Timeout.prototype.close = function() {
   this._onTimeout = null;
   if (this._handle) {
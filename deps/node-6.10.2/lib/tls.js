@@ -229,6 +229,29 @@ exports.parseCertString = function parseCertString(s) {
 };
 
 // Public API
+// Client sessions are cached natively for the whole process, see
+// tls.connect().
+const tls_wrap = process.binding('tls_wrap');
+
+exports.setSessionCacheOptions = function(options) {
+  if (options === null || typeof options !== 'object')
+    throw new TypeError('"options" argument must be an object');
+
+  if (options.maxEntries !== undefined) {
+    if (!Number.isSafeInteger(options.maxEntries) || options.maxEntries < 0)
+      throw new TypeError('"maxEntries" option must be a non-negative integer');
+    tls_wrap.setSessionCacheSize(options.maxEntries);
+  }
+};
+
+exports.getSessionCacheStats = function() {
+  return tls_wrap.getSessionCacheStats();
+};
+
+exports.clearSessionCache = function() {
+  tls_wrap.clearSessionCache();
+};
+
 exports.createSecureContext = require('_tls_common').createSecureContext;
 exports.SecureContext = require('_tls_common').SecureContext;
 exports.TLSSocket = require('_tls_wrap').TLSSocket;
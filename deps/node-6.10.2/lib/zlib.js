@@ -3,6 +3,7 @@
 const Buffer = require('buffer').Buffer;
 const Transform = require('_stream_transform');
 const binding = process.binding('zlib');
+const ZlibBufferReq = binding.ZlibBufferReq;
 const util = require('util');
 const assert = require('assert').ok;
 const kMaxLength = require('buffer').kMaxLength;
@@ -108,11 +109,11 @@ exports.deflate = function(buffer, opts, callback) {
     callback = opts;
     opts = {};
   }
-  return zlibBuffer(new Deflate(opts), buffer, callback);
+  return zlibBuffer(Deflate, binding.DEFLATE, buffer, opts, callback);
 };
 
 exports.deflateSync = function(buffer, opts) {
-  return zlibBufferSync(new Deflate(opts), buffer);
+  return zlibBufferSync(Deflate, binding.DEFLATE, buffer, opts);
 };
 
 exports.gzip = function(buffer, opts, callback) {
@@ -120,11 +121,11 @@ exports.gzip = function(buffer, opts, callback) {
     callback = opts;
     opts = {};
   }
-  return zlibBuffer(new Gzip(opts), buffer, callback);
+  return zlibBuffer(Gzip, binding.GZIP, buffer, opts, callback);
 };
 
 exports.gzipSync = function(buffer, opts) {
-  return zlibBufferSync(new Gzip(opts), buffer);
+  return zlibBufferSync(Gzip, binding.GZIP, buffer, opts);
 };
 
 exports.deflateRaw = function(buffer, opts, callback) {
@@ -132,11 +133,11 @@ exports.deflateRaw = function(buffer, opts, callback) {
     callback = opts;
     opts = {};
   }
-  return zlibBuffer(new DeflateRaw(opts), buffer, callback);
+  return zlibBuffer(DeflateRaw, binding.DEFLATERAW, buffer, opts, callback);
 };
 
 exports.deflateRawSync = function(buffer, opts) {
-  return zlibBufferSync(new DeflateRaw(opts), buffer);
+  return zlibBufferSync(DeflateRaw, binding.DEFLATERAW, buffer, opts);
 };
 
 exports.unzip = function(buffer, opts, callback) {
@@ -144,11 +145,11 @@ exports.unzip = function(buffer, opts, callback) {
     callback = opts;
     opts = {};
   }
-  return zlibBuffer(new Unzip(opts), buffer, callback);
+  return zlibBuffer(Unzip, binding.UNZIP, buffer, opts, callback);
 };
 
 exports.unzipSync = function(buffer, opts) {
-  return zlibBufferSync(new Unzip(opts), buffer);
+  return zlibBufferSync(Unzip, binding.UNZIP, buffer, opts);
 };
 
 exports.inflate = function(buffer, opts, callback) {
@@ -156,11 +157,11 @@ exports.inflate = function(buffer, opts, callback) {
     callback = opts;
     opts = {};
   }
-  return zlibBuffer(new Inflate(opts), buffer, callback);
+  return zlibBuffer(Inflate, binding.INFLATE, buffer, opts, callback);
 };
 
 exports.inflateSync = function(buffer, opts) {
-  return zlibBufferSync(new Inflate(opts), buffer);
+  return zlibBufferSync(Inflate, binding.INFLATE, buffer, opts);
 };
 
 exports.gunzip = function(buffer, opts, callback) {
@@ -168,11 +169,11 @@ exports.gunzip = function(buffer, opts, callback) {
     callback = opts;
     opts = {};
   }
-  return zlibBuffer(new Gunzip(opts), buffer, callback);
+  return zlibBuffer(Gunzip, binding.GUNZIP, buffer, opts, callback);
 };
 
 exports.gunzipSync = function(buffer, opts) {
-  return zlibBufferSync(new Gunzip(opts), buffer);
+  return zlibBufferSync(Gunzip, binding.GUNZIP, buffer, opts);
 };
 
 exports.inflateRaw = function(buffer, opts, callback) {
@@ -180,14 +181,73 @@ exports.inflateRaw = function(buffer, opts, callback) {
     callback = opts;
     opts = {};
   }
-  return zlibBuffer(new InflateRaw(opts), buffer, callback);
+  return zlibBuffer(InflateRaw, binding.INFLATERAW, buffer, opts, callback);
 };
 
 exports.inflateRawSync = function(buffer, opts) {
-  return zlibBufferSync(new InflateRaw(opts), buffer);
+  return zlibBufferSync(InflateRaw, binding.INFLATERAW, buffer, opts);
 };
 
-function zlibBuffer(engine, buffer, callback) {
+// Buffers with options the native one-shot path supports are compressed or
+// decompressed with a single call, on the thread pool unless they are small,
+// using a zlib stream from a process-wide pool. Everything else goes through a
+// stream object.
+function canUseOneShot(buffer, opts) {
+  return buffer instanceof Buffer &&
+         (opts.finishFlush === undefined ||
+          opts.finishFlush === binding.Z_FINISH);
+}
+
+function oneShot(req, mode, buffer, opts) {
+  var level = exports.Z_DEFAULT_COMPRESSION;
+  if (typeof opts.level === 'number') level = opts.level;
+
+  var strategy = exports.Z_DEFAULT_STRATEGY;
+  if (typeof opts.strategy === 'number') strategy = opts.strategy;
+
+  return binding.zlibBuffer(req,
+                            mode,
+                            buffer,
+                            opts.windowBits || exports.Z_DEFAULT_WINDOWBITS,
+                            level,
+                            opts.memLevel || exports.Z_DEFAULT_MEMLEVEL,
+                            strategy,
+                            opts.dictionary);
+}
+
+// A null message means the output would not fit in a Buffer.
+function oneShotError(message, errno) {
+  if (message === null)
+    return new RangeError(kRangeErrorMessage);
+  return zlibError(message, errno);
+}
+
+function zlibBuffer(Engine, mode, buffer, opts, callback) {
+  opts = opts || {};
+  if (typeof buffer === 'string')
+    buffer = Buffer.from(buffer);
+  if (!canUseOneShot(buffer, opts))
+    return streamBuffer(new Engine(opts), buffer, callback);
+
+  validateOptions(opts);
+
+  const req = new ZlibBufferReq();
+  req.buffer = buffer;
+  req.oncomplete = function(message, errno, result) {
+    if (result === undefined)
+      callback(oneShotError(message, errno));
+    else
+      callback(null, result);
+  };
+
+  const result = oneShot(req, mode, buffer, opts);
+  if (Array.isArray(result))
+    process.nextTick(callback, oneShotError(result[0], result[1]));
+  else if (result !== undefined)
+    process.nextTick(callback, null, result);
+}
+
+function streamBuffer(engine, buffer, callback) {
   var buffers = [];
   var nread = 0;
 
@@ -228,15 +288,23 @@ function zlibBuffer(engine, buffer, callback) {
   }
 }
 
-function zlibBufferSync(engine, buffer) {
+function zlibBufferSync(Engine, mode, buffer, opts) {
+  opts = opts || {};
+  validateOptions(opts);
   if (typeof buffer === 'string')
     buffer = Buffer.from(buffer);
   if (!(buffer instanceof Buffer))
     throw new TypeError('Not a string or buffer');
 
-  var flushFlag = engine._finishFlushFlag;
+  if (!canUseOneShot(buffer, opts)) {
+    const engine = new Engine(opts);
+    return engine._processChunk(buffer, engine._finishFlushFlag);
+  }
 
-  return engine._processChunk(buffer, flushFlag);
+  const result = oneShot(undefined, mode, buffer, opts);
+  if (Array.isArray(result))
+    throw oneShotError(result[0], result[1]);
+  return result;
 }
 
 // generic zlib
@@ -291,17 +359,7 @@ function isValidFlushFlag(flag) {
          flag === binding.Z_BLOCK;
 }
 
-// the Zlib class they all inherit from
-// This thing manages the queue of requests, and returns
-// true or false if there is anything in the queue when
-// you call the .write() method.
-
-function Zlib(opts, mode) {
-  this._opts = opts = opts || {};
-  this._chunkSize = opts.chunkSize || exports.Z_DEFAULT_CHUNK;
-
-  Transform.call(this, opts);
-
+function validateOptions(opts) {
   if (opts.flush && !isValidFlushFlag(opts.flush)) {
     throw new Error('Invalid flush flag: ' + opts.flush);
   }
@@ -309,10 +367,6 @@ function Zlib(opts, mode) {
     throw new Error('Invalid flush flag: ' + opts.finishFlush);
   }
 
-  this._flushFlag = opts.flush || binding.Z_NO_FLUSH;
-  this._finishFlushFlag = typeof opts.finishFlush !== 'undefined' ?
-    opts.finishFlush : binding.Z_FINISH;
-
   if (opts.chunkSize) {
     if (opts.chunkSize < exports.Z_MIN_CHUNK ||
         opts.chunkSize > exports.Z_MAX_CHUNK) {
@@ -356,6 +410,31 @@ function Zlib(opts, mode) {
       throw new Error('Invalid dictionary: it should be a Buffer instance');
     }
   }
+}
+
+function zlibError(message, errno) {
+  var error = new Error(message);
+  error.errno = errno;
+  error.code = exports.codes[errno];
+  return error;
+}
+
+// the Zlib class they all inherit from
+// This thing manages the queue of requests, and returns
+// true or false if there is anything in the queue when
+// you call the .write() method.
+
+function Zlib(opts, mode) {
+  this._opts = opts = opts || {};
+  this._chunkSize = opts.chunkSize || exports.Z_DEFAULT_CHUNK;
+
+  Transform.call(this, opts);
+
+  validateOptions(opts);
+
+  this._flushFlag = opts.flush || binding.Z_NO_FLUSH;
+  this._finishFlushFlag = typeof opts.finishFlush !== 'undefined' ?
+    opts.finishFlush : binding.Z_FINISH;
 
   this._handle = new binding.Zlib(mode);
 
@@ -366,11 +445,7 @@ function Zlib(opts, mode) {
     // continuing only obscures problems.
     _close(self);
     self._hadError = true;
-
-    var error = new Error(message);
-    error.errno = errno;
-    error.code = exports.codes[errno];
-    self.emit('error', error);
+    self.emit('error', zlibError(message, errno));
   };
 
   var level = exports.Z_DEFAULT_COMPRESSION;
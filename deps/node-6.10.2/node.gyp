@@ -1,6 +1,6 @@
 {
   'variables': {
-    'v8_use_snapshot%': 'false',
+    'v8_use_snapshot%': 'true',
     'node_use_dtrace%': 'false',
     'node_use_lttng%': 'false',
     'node_use_etw%': 'false',
@@ -143,12 +143,14 @@
         'src/connection_wrap.cc',
         'src/connect_wrap.cc',
         'src/debug-agent.cc',
+        'src/dns_cache.cc',
         'src/env.cc',
         'src/fs_event_wrap.cc',
         'src/handle_wrap.cc',
         'src/js_stream.cc',
         'src/node.cc',
         'src/node_buffer.cc',
+        'src/node_code_cache.cc',
         'src/node_config.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
@@ -168,10 +170,12 @@
         'src/signal_wrap.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
+        'src/string_bytes_simd.cc',
         'src/string_search.cc',
         'src/stream_base.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
+        'src/timer_wheel.cc',
         'src/timer_wrap.cc',
         'src/tty_wrap.cc',
         'src/udp_wrap.cc',
@@ -185,12 +189,14 @@
         'src/connection_wrap.h',
         'src/connect_wrap.h',
         'src/debug-agent.h',
+        'src/dns_cache.h',
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
         'src/js_stream.h',
         'src/node.h',
         'src/node_buffer.h',
+        'src/node_code_cache.h',
         'src/node_constants.h',
         'src/node_file.h',
         'src/node_http_parser.h',
@@ -210,6 +216,7 @@
         'src/req-wrap.h',
         'src/req-wrap-inl.h',
         'src/string_bytes.h',
+        'src/string_bytes_simd.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
         'src/stream_wrap.h',
@@ -340,6 +347,8 @@
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
+            'src/tls_session_cache.cc',
+            'src/tls_session_cache.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
@@ -881,6 +890,8 @@
         'NODE_WANT_INTERNALS=1',
       ],
       'sources': [
+        'src/string_bytes_simd.cc',
+        'test/cctest/test_string_bytes_simd.cc',
         'test/cctest/util.cc',
       ],
 
@@ -3,6 +3,7 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include "string_bytes_simd.h"
 #include "util.h"
 
 #include <stddef.h>
@@ -85,6 +86,23 @@ size_t base64_decode_slow(char* dst, size_t dstlen,
 }
 
 
+// Decodes the bulk of one-byte input with vector instructions.  Two-byte
+// input goes through the scalar loop only.
+inline size_t base64_decode_blocks(char* dst, size_t dstlen,
+                                   const char* src, size_t srclen,
+                                   size_t* consumed) {
+  return simd::Base64Decode(dst, dstlen, src, srclen, consumed);
+}
+
+template <typename TypeName>
+inline size_t base64_decode_blocks(char* dst, size_t dstlen,
+                                   const TypeName* src, size_t srclen,
+                                   size_t* consumed) {
+  *consumed = 0;
+  return 0;
+}
+
+
 template <typename TypeName>
 size_t base64_decode_fast(char* const dst, const size_t dstlen,
                           const TypeName* const src, const size_t srclen,
@@ -93,7 +111,7 @@ size_t base64_decode_fast(char* const dst, const size_t dstlen,
   const size_t max_i = srclen / 4 * 4;
   const size_t max_k = available / 3 * 3;
   size_t i = 0;
-  size_t k = 0;
+  size_t k = base64_decode_blocks(dst, max_k, src, max_i, &i);
   while (i < max_i && k < max_k) {
     const uint32_t v =
         unbase64(src[i + 0]) << 24 |
@@ -145,8 +163,8 @@ static size_t base64_encode(const char* src,
                               "abcdefghijklmnopqrstuvwxyz"
                               "0123456789+/";
 
-  i = 0;
-  k = 0;
+  i = simd::Base64Encode(src, slen, dst);
+  k = i / 3 * 4;
   n = slen / 3 * 3;
 
   while (i < n) {
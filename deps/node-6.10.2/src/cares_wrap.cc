@@ -2,9 +2,11 @@
 #include "ares.h"
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
+#include "dns_cache.h"
 #include "env.h"
 #include "env-inl.h"
 #include "node.h"
+#include "node_mutex.h"
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
 #include "tree.h"
@@ -16,6 +18,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #if defined(__ANDROID__) || \
     defined(__MINGW32__) || \
     defined(__OpenBSD__) || \
@@ -42,6 +48,7 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -84,6 +91,12 @@ class GetAddrInfoReqWrap : public ReqWrap<uv_getaddrinfo_t> {
   GetAddrInfoReqWrap(Environment* env, Local<Object> req_wrap_obj);
 
   size_t self_size() const override { return sizeof(*this); }
+
+  std::string hostname_;
+  int family_;
+  std::string cache_key_;
+  // Requests for the same key made while this one was in flight.
+  std::vector<GetAddrInfoReqWrap*> waiters_;
 };
 
 GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
@@ -316,6 +329,12 @@ class QueryWrap : public AsyncWrap {
     QueryWrap* wrap = static_cast<QueryWrap*>(arg);
 
     if (status != ARES_SUCCESS) {
+      if (!wrap->cache_key_.empty() &&
+          (status == ARES_ENOTFOUND || status == ARES_ENODATA)) {
+        DnsCache::Result result;
+        result.status = status;
+        DnsCache::Put(wrap->cache_key_, result, DnsCache::NegativeTtl());
+      }
       wrap->ParseError(status);
     } else {
       wrap->Parse(answer_buf, answer_len);
@@ -375,9 +394,48 @@ class QueryWrap : public AsyncWrap {
   virtual void Parse(struct hostent* host) {
     UNREACHABLE();
   }
+
+  // Caches the reply under this key when set by the subclass, see DnsCache.
+  std::string cache_key_;
 };
 
 
+static inline const void* TtlAddress(const ares_addrttl& addrttl) {
+  return &addrttl.ipaddr;
+}
+
+
+static inline const void* TtlAddress(const ares_addr6ttl& addrttl) {
+  return &addrttl.ip6addr;
+}
+
+
+// Caches the addresses of an A or AAAA reply for the lowest TTL among them.
+template <typename T>
+static void CacheAddresses(const std::string& key,
+                           int family,
+                           const T* addrttls,
+                           int naddrttls) {
+  if (naddrttls <= 0)
+    return;
+
+  DnsCache::Result result;
+  result.status = 0;
+  int ttl = addrttls[0].ttl;
+  char ip[INET6_ADDRSTRLEN];
+  for (int i = 0; i < naddrttls; i++) {
+    if (addrttls[i].ttl < ttl)
+      ttl = addrttls[i].ttl;
+    if (uv_inet_ntop(family, TtlAddress(addrttls[i]), ip, sizeof(ip)) != 0)
+      return;
+    result.addresses.push_back(ip);
+  }
+
+  if (ttl > 0)
+    DnsCache::Put(key, result, static_cast<uint64_t>(ttl) * 1000);
+}
+
+
 class QueryAWrap: public QueryWrap {
  public:
   QueryAWrap(Environment* env, Local<Object> req_wrap_obj)
@@ -385,6 +443,7 @@ class QueryAWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
+    cache_key_ = DnsCache::QueryKey(4, name, env()->dns_servers());
     ares_query(env()->cares_channel(),
                name,
                ns_c_in,
@@ -402,13 +461,17 @@ class QueryAWrap: public QueryWrap {
     Context::Scope context_scope(env()->context());
 
     struct hostent* host;
+    ares_addrttl addrttls[256];
+    int naddrttls = arraysize(addrttls);
 
-    int status = ares_parse_a_reply(buf, len, &host, nullptr, nullptr);
+    int status = ares_parse_a_reply(buf, len, &host, addrttls, &naddrttls);
     if (status != ARES_SUCCESS) {
       ParseError(status);
       return;
     }
 
+    CacheAddresses(cache_key_, AF_INET, addrttls, naddrttls);
+
     Local<Array> addresses = HostentToAddresses(env(), host);
     ares_free_hostent(host);
 
@@ -424,6 +487,7 @@ class QueryAaaaWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
+    cache_key_ = DnsCache::QueryKey(6, name, env()->dns_servers());
     ares_query(env()->cares_channel(),
                name,
                ns_c_in,
@@ -441,13 +505,17 @@ class QueryAaaaWrap: public QueryWrap {
     Context::Scope context_scope(env()->context());
 
     struct hostent* host;
+    ares_addr6ttl addrttls[256];
+    int naddrttls = arraysize(addrttls);
 
-    int status = ares_parse_aaaa_reply(buf, len, &host, nullptr, nullptr);
+    int status = ares_parse_aaaa_reply(buf, len, &host, addrttls, &naddrttls);
     if (status != ARES_SUCCESS) {
       ParseError(status);
       return;
     }
 
+    CacheAddresses(cache_key_, AF_INET6, addrttls, naddrttls);
+
     Local<Array> addresses = HostentToAddresses(env(), host);
     ares_free_hostent(host);
 
@@ -949,67 +1017,108 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
-  GetAddrInfoReqWrap* req_wrap = static_cast<GetAddrInfoReqWrap*>(req->data);
+// The getaddrinfo() request in flight for each lookup key on each loop,
+// which later requests for the same key wait for instead of making their own.
+static Mutex inflight_mutex;
+static std::unordered_map<std::string, GetAddrInfoReqWrap*> inflight;
+
+
+static std::string InFlightKey(Environment* env, const std::string& key) {
+  char loop[32];
+  snprintf(loop, sizeof(loop), "%p:", static_cast<void*>(env->event_loop()));
+  return loop + key;
+}
+
+
+static Local<Array> AddressesToJS(Environment* env,
+                                  const std::vector<std::string>& addresses) {
+  Local<Array> results = Array::New(env->isolate(), addresses.size());
+  for (size_t i = 0; i < addresses.size(); i++)
+    results->Set(i, OneByteString(env->isolate(), addresses[i].c_str()));
+  return results;
+}
+
+
+// How long to cache the result of a lookup: the TTL of the c-ares answers
+// for the same name if we have seen them, the default TTL otherwise.
+// Only "no such name" failures are cached, not transient ones.
+static uint64_t LookupTtl(const GetAddrInfoReqWrap* req_wrap, int status) {
+  if (status == UV_EAI_NONAME || status == UV_EAI_NODATA)
+    return DnsCache::NegativeTtl();
+  if (status != 0)
+    return 0;
+
+  const char* hostname = req_wrap->hostname_.c_str();
+  const std::string& servers = req_wrap->env()->dns_servers();
+  uint64_t ttl = 0;
+  if (req_wrap->family_ != 6)
+    ttl = DnsCache::Remaining(DnsCache::QueryKey(4, hostname, servers));
+  if (req_wrap->family_ != 4) {
+    uint64_t ttl6 =
+        DnsCache::Remaining(DnsCache::QueryKey(6, hostname, servers));
+    if (ttl6 != 0 && (ttl == 0 || ttl6 < ttl))
+      ttl = ttl6;
+  }
+  return ttl != 0 ? ttl : DnsCache::DefaultTtl();
+}
+
+
+static void CompleteGetAddrInfo(GetAddrInfoReqWrap* req_wrap,
+                                const DnsCache::Result& result) {
   Environment* env = req_wrap->env();
 
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
   Local<Value> argv[] = {
-    Integer::New(env->isolate(), status),
+    Integer::New(env->isolate(), result.status),
     Null(env->isolate())
   };
 
-  if (status == 0) {
-    // Success
-    struct addrinfo *address;
-    int n = 0;
+  if (result.status == 0)
+    argv[1] = AddressesToJS(env, result.addresses);
 
-    // Create the response array.
-    Local<Array> results = Array::New(env->isolate());
+  // Make the callback into JavaScript
+  req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
 
-    char ip[INET6_ADDRSTRLEN];
-    const char *addr;
+  delete req_wrap;
+}
 
-    // Iterate over the IPv4 responses again this time creating javascript
-    // strings for each IP and filling the results array.
-    address = res;
-    while (address) {
-      CHECK_EQ(address->ai_socktype, SOCK_STREAM);
 
-      // Ignore random ai_family types.
-      if (address->ai_family == AF_INET) {
-        // Juggle pointers
-        addr = reinterpret_cast<char*>(&(reinterpret_cast<struct sockaddr_in*>(
-            address->ai_addr)->sin_addr));
-        int err = uv_inet_ntop(address->ai_family,
-                               addr,
-                               ip,
-                               INET6_ADDRSTRLEN);
-        if (err)
-          continue;
+void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
+  GetAddrInfoReqWrap* req_wrap = static_cast<GetAddrInfoReqWrap*>(req->data);
+  Environment* env = req_wrap->env();
 
-        // Create JavaScript string
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(n, s);
-        n++;
-      }
+  DnsCache::Result result;
+  result.status = status;
 
-      // Increment
-      address = address->ai_next;
-    }
+  if (status == 0) {
+    // Success
+    char ip[INET6_ADDRSTRLEN];
+    const char *addr;
+
+    // IPv4 addresses first, then IPv6 ones.
+    static const int families[] = { AF_INET, AF_INET6 };
+    for (size_t i = 0; i < arraysize(families); i++) {
+      for (struct addrinfo* address = res;
+           address != nullptr;
+           address = address->ai_next) {
+        CHECK_EQ(address->ai_socktype, SOCK_STREAM);
 
-    // Iterate over the IPv6 responses putting them in the array.
-    address = res;
-    while (address) {
-      CHECK_EQ(address->ai_socktype, SOCK_STREAM);
+        // Ignore random ai_family types.
+        if (address->ai_family != families[i])
+          continue;
 
-      // Ignore random ai_family types.
-      if (address->ai_family == AF_INET6) {
         // Juggle pointers
-        addr = reinterpret_cast<char*>(&(reinterpret_cast<struct sockaddr_in6*>(
-            address->ai_addr)->sin6_addr));
+        if (address->ai_family == AF_INET) {
+          addr = reinterpret_cast<char*>(
+              &(reinterpret_cast<struct sockaddr_in*>(
+                  address->ai_addr)->sin_addr));
+        } else {
+          addr = reinterpret_cast<char*>(
+              &(reinterpret_cast<struct sockaddr_in6*>(
+                  address->ai_addr)->sin6_addr));
+        }
         int err = uv_inet_ntop(address->ai_family,
                                addr,
                                ip,
@@ -1017,30 +1126,33 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
         if (err)
           continue;
 
-        // Create JavaScript string
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(n, s);
-        n++;
+        result.addresses.push_back(ip);
       }
-
-      // Increment
-      address = address->ai_next;
     }
 
     // No responses were found to return
-    if (n == 0) {
-      argv[0] = Integer::New(env->isolate(), UV_EAI_NODATA);
+    if (result.addresses.empty()) {
+      result.status = UV_EAI_NODATA;
     }
-
-    argv[1] = results;
   }
 
   uv_freeaddrinfo(res);
 
-  // Make the callback into JavaScript
-  req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+  {
+    Mutex::ScopedLock scoped_lock(inflight_mutex);
+    inflight.erase(InFlightKey(env, req_wrap->cache_key_));
+  }
 
-  delete req_wrap;
+  DnsCache::Put(req_wrap->cache_key_,
+                result,
+                LookupTtl(req_wrap, result.status));
+
+  std::vector<GetAddrInfoReqWrap*> waiters;
+  waiters.swap(req_wrap->waiters_);
+
+  CompleteGetAddrInfo(req_wrap, result);
+  for (size_t i = 0; i < waiters.size(); i++)
+    CompleteGetAddrInfo(waiters[i], result);
 }
 
 
@@ -1137,6 +1249,21 @@ static void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
   }
 
   GetAddrInfoReqWrap* req_wrap = new GetAddrInfoReqWrap(env, req_wrap_obj);
+  req_wrap->hostname_ = *hostname;
+  req_wrap->family_ = args[2]->Int32Value();
+  req_wrap->cache_key_ =
+      DnsCache::LookupKey(*hostname, req_wrap->family_, flags);
+
+  const std::string inflight_key = InFlightKey(env, req_wrap->cache_key_);
+  Mutex::ScopedLock scoped_lock(inflight_mutex);
+
+  auto found = inflight.find(inflight_key);
+  if (found != inflight.end()) {
+    found->second->waiters_.push_back(req_wrap);
+    req_wrap->Dispatched();
+    DnsCache::CountCoalesced();
+    return args.GetReturnValue().Set(0);
+  }
 
   struct addrinfo hints;
   memset(&hints, 0, sizeof(struct addrinfo));
@@ -1153,11 +1280,100 @@ static void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
   req_wrap->Dispatched();
   if (err)
     delete req_wrap;
+  else
+    inflight[inflight_key] = req_wrap;
 
   args.GetReturnValue().Set(err);
 }
 
 
+// getaddrinfoCached(hostname, family, hints) returns the cached addresses
+// for a lookup, its cached error code, or undefined on a miss.
+static void GetAddrInfoCached(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsInt32());
+  node::Utf8Value hostname(env->isolate(), args[0]);
+  int32_t flags = (args[2]->IsInt32()) ? args[2]->Int32Value() : 0;
+
+  DnsCache::Result result;
+  const std::string key =
+      DnsCache::LookupKey(*hostname, args[1]->Int32Value(), flags);
+  if (!DnsCache::Get(key, &result))
+    return;
+
+  if (result.status != 0)
+    args.GetReturnValue().Set(result.status);
+  else
+    args.GetReturnValue().Set(AddressesToJS(env, result.addresses));
+}
+
+
+// queryCached(family, name) is the same for resolve4() and resolve6(),
+// with c-ares error codes.
+static void QueryCached(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsInt32());
+  CHECK(args[1]->IsString());
+  node::Utf8Value name(env->isolate(), args[1]);
+
+  DnsCache::Result result;
+  const std::string key =
+      DnsCache::QueryKey(args[0]->Int32Value(), *name, env->dns_servers());
+  if (!DnsCache::Get(key, &result))
+    return;
+
+  if (result.status != 0) {
+    const char* code = ToErrorCodeString(result.status);
+    args.GetReturnValue().Set(OneByteString(env->isolate(), code));
+  } else {
+    args.GetReturnValue().Set(AddressesToJS(env, result.addresses));
+  }
+}
+
+
+// setCacheOptions(ttl, negativeTtl, maxEntries), with TTLs in milliseconds.
+// A negative value keeps the current setting.
+static void SetCacheOptions(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsNumber());
+  CHECK(args[2]->IsNumber());
+  const double ttl = args[0]->NumberValue();
+  const double negative_ttl = args[1]->NumberValue();
+  const double max_entries = args[2]->NumberValue();
+  DnsCache::Configure(
+      ttl < 0 ? DnsCache::DefaultTtl() : static_cast<uint64_t>(ttl),
+      negative_ttl < 0 ? DnsCache::NegativeTtl()
+                       : static_cast<uint64_t>(negative_ttl),
+      max_entries < 0 ? DnsCache::MaxEntries()
+                      : static_cast<size_t>(max_entries));
+}
+
+
+static void GetCacheStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  DnsCache::Stats stats = DnsCache::GetStats();
+
+  Local<Object> info = Object::New(env->isolate());
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "hits"),
+            Number::New(env->isolate(), static_cast<double>(stats.hits)));
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "misses"),
+            Number::New(env->isolate(), static_cast<double>(stats.misses)));
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "coalesced"),
+            Number::New(env->isolate(), static_cast<double>(stats.coalesced)));
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "entries"),
+            Number::New(env->isolate(), static_cast<double>(stats.entries)));
+  args.GetReturnValue().Set(info);
+}
+
+
+static void ClearCache(const FunctionCallbackInfo<Value>& args) {
+  DnsCache::Clear();
+}
+
+
 static void GetNameInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1227,11 +1443,15 @@ static void SetServers(const FunctionCallbackInfo<Value>& args) {
 
   if (len == 0) {
     int rv = ares_set_servers(env->cares_channel(), nullptr);
+    if (rv == 0)
+      env->set_dns_servers("[]");
     return args.GetReturnValue().Set(rv);
   }
 
-  ares_addr_node* servers = new ares_addr_node[len];
-  ares_addr_node* last = nullptr;
+  ares_addr_port_node* servers = new ares_addr_port_node[len];
+  ares_addr_port_node* last = nullptr;
+  // The servers as given, for the keys of their answers in the DnsCache.
+  std::string id = "[";
 
   int err;
 
@@ -1245,8 +1465,12 @@ static void SetServers(const FunctionCallbackInfo<Value>& args) {
 
     int fam = elm->Get(0)->Int32Value();
     node::Utf8Value ip(env->isolate(), elm->Get(1));
+    // A port of 0 means the default one.
+    int port = elm->Get(2)->Int32Value();
 
-    ares_addr_node* cur = &servers[i];
+    ares_addr_port_node* cur = &servers[i];
+    cur->udp_port = port;
+    cur->tcp_port = port;
 
     switch (fam) {
       case 4:
@@ -1264,6 +1488,7 @@ static void SetServers(const FunctionCallbackInfo<Value>& args) {
     if (err)
       break;
 
+    id += std::to_string(fam) + " " + *ip + " " + std::to_string(port) + ",";
     cur->next = nullptr;
 
     if (last != nullptr)
@@ -1273,10 +1498,14 @@ static void SetServers(const FunctionCallbackInfo<Value>& args) {
   }
 
   if (err == 0)
-    err = ares_set_servers(env->cares_channel(), &servers[0]);
+    err = ares_set_servers_ports(env->cares_channel(), &servers[0]);
   else
     err = ARES_EBADSTR;
 
+  // Answers from the old servers stay cached, but under the old servers' key.
+  if (err == 0)
+    env->set_dns_servers(id + "]");
+
   delete[] servers;
 
   args.GetReturnValue().Set(err);
@@ -1349,6 +1578,11 @@ static void Initialize(Local<Object> target,
   env->SetMethod(target, "getHostByAddr", Query<GetHostByAddrWrap>);
 
   env->SetMethod(target, "getaddrinfo", GetAddrInfo);
+  env->SetMethod(target, "getaddrinfoCached", GetAddrInfoCached);
+  env->SetMethod(target, "queryCached", QueryCached);
+  env->SetMethod(target, "setCacheOptions", SetCacheOptions);
+  env->SetMethod(target, "getCacheStats", GetCacheStats);
+  env->SetMethod(target, "clearCache", ClearCache);
   env->SetMethod(target, "getnameinfo", GetNameInfo);
   env->SetMethod(target, "isIP", IsIP);
   env->SetMethod(target, "isIPv4", IsIPv4);
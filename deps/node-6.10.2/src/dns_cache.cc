@@ -0,0 +1,183 @@
+#include "dns_cache.h"
+#include "node_mutex.h"
+#include "uv.h"
+
+#include <ctype.h>
+#include <stdio.h>
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace node {
+namespace cares_wrap {
+
+namespace {
+
+struct Entry {
+  std::string key;
+  DnsCache::Result result;
+  uint64_t expires;
+};
+
+typedef std::list<Entry> EntryList;
+
+Mutex cache_mutex;
+// Most recently used first.
+EntryList entries;
+std::unordered_map<std::string, EntryList::iterator> index;
+
+uint64_t default_ttl = 30 * 1000;
+uint64_t negative_ttl = 5 * 1000;
+size_t max_entries = 1000;
+
+uint64_t hits;
+uint64_t misses;
+uint64_t coalesced;
+
+inline uint64_t Now() {
+  return uv_hrtime() / 1000000;
+}
+
+// Host names are compared case-insensitively. |servers| is prefixed by its
+// length, so that it cannot run into the host name.
+std::string Key(char kind,
+                int family,
+                int hints,
+                const std::string& servers,
+                const char* host) {
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%c%d:%d:%zu:",
+           kind, family, hints, servers.size());
+  std::string key(prefix);
+  key += servers;
+  for (const char* p = host; *p != '\0'; p++)
+    key += static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+  return key;
+}
+
+void Erase(EntryList::iterator it) {
+  index.erase(it->key);
+  entries.erase(it);
+}
+
+void Trim() {
+  while (entries.size() > max_entries)
+    Erase(--entries.end());
+}
+
+}  // anonymous namespace
+
+
+std::string DnsCache::LookupKey(const char* host, int family, int hints) {
+  return Key('L', family, hints, std::string(), host);
+}
+
+
+std::string DnsCache::QueryKey(int family,
+                               const char* host,
+                               const std::string& servers) {
+  return Key('Q', family, 0, servers, host);
+}
+
+
+bool DnsCache::Get(const std::string& key, Result* result) {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  auto found = index.find(key);
+  if (found == index.end()) {
+    misses++;
+    return false;
+  }
+
+  EntryList::iterator it = found->second;
+  if (it->expires <= Now()) {
+    Erase(it);
+    misses++;
+    return false;
+  }
+
+  entries.splice(entries.begin(), entries, it);
+  *result = it->result;
+  hits++;
+  return true;
+}
+
+
+void DnsCache::Put(const std::string& key, const Result& result, uint64_t ttl) {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  if (ttl == 0 || max_entries == 0)
+    return;
+
+  auto found = index.find(key);
+  if (found != index.end())
+    Erase(found->second);
+
+  entries.push_front(Entry { key, result, Now() + ttl });
+  index[key] = entries.begin();
+  Trim();
+}
+
+
+uint64_t DnsCache::Remaining(const std::string& key) {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  auto found = index.find(key);
+  if (found == index.end() || found->second->result.status != 0)
+    return 0;
+  const uint64_t now = Now();
+  const uint64_t expires = found->second->expires;
+  return expires > now ? expires - now : 0;
+}
+
+
+uint64_t DnsCache::DefaultTtl() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  return default_ttl;
+}
+
+
+uint64_t DnsCache::NegativeTtl() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  return negative_ttl;
+}
+
+
+size_t DnsCache::MaxEntries() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  return max_entries;
+}
+
+
+void DnsCache::Configure(uint64_t ttl, uint64_t negative, size_t max) {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  default_ttl = ttl;
+  negative_ttl = negative;
+  max_entries = max;
+  Trim();
+}
+
+
+void DnsCache::Clear() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  entries.clear();
+  index.clear();
+}
+
+
+void DnsCache::CountCoalesced() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  coalesced++;
+}
+
+
+DnsCache::Stats DnsCache::GetStats() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  Stats stats;
+  stats.hits = hits;
+  stats.misses = misses;
+  stats.coalesced = coalesced;
+  stats.entries = entries.size();
+  return stats;
+}
+
+}  // namespace cares_wrap
+}  // namespace node
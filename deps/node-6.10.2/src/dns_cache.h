@@ -0,0 +1,72 @@
+#ifndef SRC_DNS_CACHE_H_
+#define SRC_DNS_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace node {
+namespace cares_wrap {
+
+// Process-wide cache of name resolution results, shared by every Environment
+// (and so every thread running one) in the process. Keys come from LookupKey()
+// for getaddrinfo() results and QueryKey() for c-ares A and AAAA answers. The
+// latter include the servers that gave them, as each Environment may query
+// servers of its own, see Environment::dns_servers().
+// Failures are cached too, for the negative TTL. Entries are evicted least
+// recently used first once there are more than the configured maximum; a
+// maximum of 0 turns the cache off.
+class DnsCache {
+ public:
+  struct Result {
+    // 0, or the libuv (getaddrinfo) or c-ares (queries) error code.
+    int status;
+    std::vector<std::string> addresses;
+  };
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t coalesced;
+    size_t entries;
+  };
+
+  static std::string LookupKey(const char* host, int family, int hints);
+  static std::string QueryKey(int family,
+                              const char* host,
+                              const std::string& servers);
+
+  // Copies the entry for |key| to |*result| if it has not expired yet.
+  static bool Get(const std::string& key, Result* result);
+
+  // Caches |result| for |ttl| milliseconds. A |ttl| of 0 caches nothing.
+  static void Put(const std::string& key, const Result& result, uint64_t ttl);
+
+  // Milliseconds until the successful entry for |key| expires, 0 if there is
+  // none.
+  static uint64_t Remaining(const std::string& key);
+
+  // The TTLs used when the resolver does not report one, in milliseconds.
+  static uint64_t DefaultTtl();
+  static uint64_t NegativeTtl();
+  static size_t MaxEntries();
+
+  static void Configure(uint64_t ttl, uint64_t negative_ttl, size_t max);
+  // Drops every entry, but not the counters.
+  static void Clear();
+
+  // Counts a request that was answered by one already in flight.
+  static void CountCoalesced();
+  static Stats GetStats();
+};
+
+}  // namespace cares_wrap
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_DNS_CACHE_H_
@@ -447,6 +447,14 @@ inline node_ares_task_list* Environment::cares_task_list() {
   return &cares_task_list_;
 }
 
+inline const std::string& Environment::dns_servers() const {
+  return dns_servers_;
+}
+
+inline void Environment::set_dns_servers(const std::string& servers) {
+  dns_servers_ = servers;
+}
+
 inline Environment::IsolateData* Environment::isolate_data() const {
   return isolate_data_;
 }
@@ -72,6 +72,7 @@ namespace node {
   V(async_queue_string, "_asyncQueue")                                        \
   V(buffer_string, "buffer")                                                  \
   V(bytes_string, "bytes")                                                    \
+  V(bytes_copied_string, "bytesCopied")                                       \
   V(bytes_parsed_string, "bytesParsed")                                       \
   V(bytes_read_string, "bytesRead")                                           \
   V(cached_data_string, "cachedData")                                         \
@@ -150,6 +151,7 @@ namespace node {
   V(onhandshakedone_string, "onhandshakedone")                                \
   V(onhandshakestart_string, "onhandshakestart")                              \
   V(onmessage_string, "onmessage")                                            \
+  V(onmessages_string, "onmessages")                                          \
   V(onnewsession_string, "onnewsession")                                      \
   V(onnewsessiondone_string, "onnewsessiondone")                              \
   V(onocspresponse_string, "onocspresponse")                                  \
@@ -439,6 +441,9 @@ class Environment {
   inline ares_channel cares_channel();
   inline ares_channel* cares_channel_ptr();
   inline node_ares_task_list* cares_task_list();
+  // Identifies the servers set with dns.setServers(), empty for the system's.
+  inline const std::string& dns_servers() const;
+  inline void set_dns_servers(const std::string& servers);
 
   inline bool using_domains() const;
   inline void set_using_domains(bool value);
@@ -557,6 +562,7 @@ class Environment {
   uv_timer_t cares_timer_handle_;
   ares_channel cares_channel_;
   node_ares_task_list cares_task_list_;
+  std::string dns_servers_;
   bool using_domains_;
   bool printed_error_;
   bool trace_sync_io_;
@@ -66,6 +66,15 @@ void HandleWrap::Close(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void HandleWrap::Close(HandleWrap* wrap) {
+  if (!IsAlive(wrap) || wrap->state_ != kInitialized)
+    return;
+
+  uv_close(wrap->handle_, OnClose);
+  wrap->state_ = kClosing;
+}
+
+
 HandleWrap::HandleWrap(Environment* env,
                        Local<Object> object,
                        uv_handle_t* handle,
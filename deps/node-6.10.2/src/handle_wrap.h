@@ -39,6 +39,10 @@ class HandleWrap : public AsyncWrap {
   static void Unref(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HasRef(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Closes |wrap| from C++, without a close callback.  Used to shut down an
+  // environment that shares its event loop with others.
+  static void Close(HandleWrap* wrap);
+
   static inline bool IsAlive(const HandleWrap* wrap) {
     return wrap != nullptr && wrap->state_ != kClosed;
   }
@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_buffer.h"
+#include "node_code_cache.h"
 #include "node_constants.h"
 #include "node_file.h"
 #include "node_http_parser.h"
@@ -189,6 +190,11 @@ bool trace_warnings = false;
 // that is used by lib/module.js
 bool config_preserve_symlinks = false;
 
+// Set in node.cc by ParseArgs when --timer-wheel is used.
+// Used in node_config.cc to set a constant on process.binding('config')
+// that is used by lib/timers.js
+bool config_timer_wheel = false;
+
 // process-relative uptime base, initialized at start-up
 static double prog_start_time;
 static bool debugger_running;
@@ -1024,12 +1030,18 @@ Local<Value> WinapiErrnoException(Isolate* isolate,
 #endif
 
 
-void* ArrayBufferAllocator::Allocate(size_t size) {
+bool ArrayBufferAllocator::ZeroFill() {
   if (env_ == nullptr ||
       !env_->array_buffer_allocator_info()->no_zero_fill() ||
       zero_fill_all_buffers)
-    return node::Calloc(size, 1);
+    return true;
   env_->array_buffer_allocator_info()->reset_fill_flag();
+  return false;
+}
+
+void* ArrayBufferAllocator::Allocate(size_t size) {
+  if (ZeroFill())
+    return node::Calloc(size, 1);
   return node::Malloc(size);
 }
 
@@ -1723,9 +1735,12 @@ static void ReportException(Environment* env, const TryCatch& try_catch) {
 
 
 // Executes a str within the current v8 context.
+// If |cache_key| is given, the script is compiled through the shared code
+// cache.
 static Local<Value> ExecuteString(Environment* env,
                                   Local<String> source,
-                                  Local<String> filename) {
+                                  Local<String> filename,
+                                  const char* cache_key = nullptr) {
   EscapableHandleScope scope(env->isolate());
   TryCatch try_catch(env->isolate());
 
@@ -1734,7 +1749,8 @@ static Local<Value> ExecuteString(Environment* env,
   try_catch.SetVerbose(false);
 
   ScriptOrigin origin(filename);
-  MaybeLocal<v8::Script> script =
+  MaybeLocal<v8::Script> script = cache_key != nullptr ?
+      code_cache::Compile(env, source, &origin, cache_key) :
       v8::Script::Compile(env->context(), source, &origin);
   if (script.IsEmpty()) {
     ReportException(env, try_catch);
@@ -3498,7 +3514,8 @@ void LoadEnvironment(Environment* env) {
   // 'internal_bootstrap_node_native' is the string containing that source code.
   Local<String> script_name = FIXED_ONE_BYTE_STRING(env->isolate(),
                                                     "bootstrap_node.js");
-  Local<Value> f_value = ExecuteString(env, MainSource(env), script_name);
+  Local<Value> f_value = ExecuteString(env, MainSource(env), script_name,
+                                       "bootstrap_node.js");
   if (try_catch.HasCaught())  {
     ReportException(env, try_catch);
     exit(10);
@@ -3668,6 +3685,8 @@ static void PrintHelp() {
          "                        using --prof\n"
          "  --zero-fill-buffers   automatically zero-fill all newly allocated\n"
          "                        Buffer and SlowBuffer instances\n"
+         "  --timer-wheel         schedule timers in a hierarchical timing\n"
+         "                        wheel instead of per-duration lists\n"
          "  --v8-options          print v8 command line options\n"
          "  --v8-pool-size=num    set v8's thread pool size\n"
 #if HAVE_OPENSSL
@@ -3712,6 +3731,8 @@ static void PrintHelp() {
 #endif
          "                        prefixed to the module search path\n"
          "NODE_REPL_HISTORY       path to the persistent REPL history file\n"
+         "NODE_TIMER_WHEEL        set to 1 to behave as if --timer-wheel\n"
+         "                        was given\n"
          "\n"
          "Documentation can be found at https://nodejs.org/\n");
 }
@@ -3831,6 +3852,8 @@ static void ParseArgs(int* argc,
       short_circuit = true;
     } else if (strcmp(arg, "--zero-fill-buffers") == 0) {
       zero_fill_all_buffers = true;
+    } else if (strcmp(arg, "--timer-wheel") == 0) {
+      config_timer_wheel = true;
     } else if (strcmp(arg, "--v8-options") == 0) {
       new_v8_argv[new_v8_argc] = "--help";
       new_v8_argc += 1;
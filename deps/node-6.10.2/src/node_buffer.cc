@@ -4,6 +4,7 @@
 #include "env.h"
 #include "env-inl.h"
 #include "string_bytes.h"
+#include "string_bytes_simd.h"
 #include "string_search.h"
 #include "util.h"
 #include "util-inl.h"
@@ -568,6 +569,10 @@ void Copy(const FunctionCallbackInfo<Value> &args) {
 }
 
 
+// Largest block Fill() copies at once, small enough for L1 on most devices.
+static const size_t kFillChunkSize = 16 * 1024;
+
+
 void Fill(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -646,16 +651,40 @@ void Fill(const FunctionCallbackInfo<Value>& args) {
   if (str_length >= fill_length)
     return;
 
+  if (str_length == 1) {
+    memset(ts_obj_data + start + 1, ts_obj_data[start], fill_length - 1);
+    return;
+  }
 
+  // Double the pattern in place until it spans kFillChunkSize bytes, then
+  // copy that chunk over the rest, so that the source of every copy stays
+  // in cache however large the fill.
   size_t in_there = str_length;
   char* ptr = ts_obj_data + start + str_length;
+  size_t chunk = MIN(fill_length,
+                     str_length > kFillChunkSize ? str_length : kFillChunkSize);
 
-  while (in_there < fill_length - in_there) {
+  while (in_there < chunk - in_there) {
     memcpy(ptr, ts_obj_data + start, in_there);
     ptr += in_there;
     in_there *= 2;
   }
 
+  // Keep the chunk a whole number of patterns for the copies below.
+  if (in_there < chunk) {
+    size_t extra = (chunk - in_there) / str_length * str_length;
+    memcpy(ptr, ts_obj_data + start, extra);
+    ptr += extra;
+    in_there += extra;
+  }
+  chunk = in_there;
+
+  while (in_there < fill_length - chunk) {
+    memcpy(ptr, ts_obj_data + start, chunk);
+    ptr += chunk;
+    in_there += chunk;
+  }
+
   if (in_there < fill_length) {
     memcpy(ptr, ts_obj_data + start, fill_length - in_there);
   }
@@ -853,8 +882,9 @@ void WriteDoubleBE(const FunctionCallbackInfo<Value>& args) {
 void ByteLengthUtf8(const FunctionCallbackInfo<Value> &args) {
   CHECK(args[0]->IsString());
 
-  // Fast case: avoid StringBytes on UTF8 string. Jump to v8.
-  args.GetReturnValue().Set(args[0].As<String>()->Utf8Length());
+  // Fast case: avoid StringBytes::Size() on UTF8 string.
+  args.GetReturnValue().Set(
+      static_cast<uint32_t>(StringBytes::Utf8Length(args[0].As<String>())));
 }
 
 // Normalize val to be an integer in the range of [1, -1] since
@@ -931,6 +961,34 @@ void Compare(const FunctionCallbackInfo<Value> &args) {
 }
 
 
+// Longest needle searched for with the vectorized first and last byte filter.
+// Longer ones go through Boyer-Moore-Horspool, whose skips pay off by then.
+static const size_t kMaxFilteredNeedle = 64;
+
+
+// Searches one-byte data for |needle| as SearchString() does.
+static size_t SearchBytes(const char* haystack,
+                          size_t haystack_length,
+                          const char* needle,
+                          size_t needle_length,
+                          size_t offset,
+                          bool is_forward) {
+  if (needle_length >= 2 && needle_length <= kMaxFilteredNeedle) {
+    if (is_forward)
+      return simd::IndexOf(haystack, haystack_length,
+                           needle, needle_length, offset);
+    return simd::LastIndexOf(haystack, haystack_length,
+                             needle, needle_length, offset);
+  }
+  return SearchString(reinterpret_cast<const uint8_t*>(haystack),
+                      haystack_length,
+                      reinterpret_cast<const uint8_t*>(needle),
+                      needle_length,
+                      offset,
+                      is_forward);
+}
+
+
 // Computes the offset for starting an indexOf or lastIndexOf search.
 // Returns either a valid offset in [0...<length - 1>], ie inside the Buffer,
 // or -1 to signal that there is no possible match.
@@ -1044,12 +1102,12 @@ void IndexOfString(const FunctionCallbackInfo<Value>& args) {
     if (*needle_value == nullptr)
       return args.GetReturnValue().Set(-1);
 
-    result = SearchString(reinterpret_cast<const uint8_t*>(haystack),
-                          haystack_length,
-                          reinterpret_cast<const uint8_t*>(*needle_value),
-                          needle_length,
-                          offset,
-                          is_forward);
+    result = SearchBytes(haystack,
+                         haystack_length,
+                         *needle_value,
+                         needle_length,
+                         offset,
+                         is_forward);
   } else if (enc == LATIN1) {
     uint8_t* needle_data = static_cast<uint8_t*>(node::Malloc(needle_length));
     if (needle_data == nullptr) {
@@ -1058,12 +1116,12 @@ void IndexOfString(const FunctionCallbackInfo<Value>& args) {
     needle->WriteOneByte(
         needle_data, 0, needle_length, String::NO_NULL_TERMINATION);
 
-    result = SearchString(reinterpret_cast<const uint8_t*>(haystack),
-                          haystack_length,
-                          needle_data,
-                          needle_length,
-                          offset,
-                          is_forward);
+    result = SearchBytes(haystack,
+                         haystack_length,
+                         reinterpret_cast<const char*>(needle_data),
+                         needle_length,
+                         offset,
+                         is_forward);
     free(needle_data);
   }
 
@@ -1122,13 +1180,12 @@ void IndexOfBuffer(const FunctionCallbackInfo<Value>& args) {
         is_forward);
     result *= 2;
   } else {
-    result = SearchString(
-        reinterpret_cast<const uint8_t*>(haystack),
-        haystack_length,
-        reinterpret_cast<const uint8_t*>(needle),
-        needle_length,
-        offset,
-        is_forward);
+    result = SearchBytes(haystack,
+                         haystack_length,
+                         needle,
+                         needle_length,
+                         offset,
+                         is_forward);
   }
 
   args.GetReturnValue().Set(
@@ -0,0 +1,244 @@
+#include "node_code_cache.h"
+#include "node.h"
+#include "node_mutex.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+namespace code_cache {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Object;
+using v8::Script;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::String;
+using v8::TryCatch;
+using v8::UnboundScript;
+using v8::Value;
+
+typedef std::vector<uint8_t> Data;
+
+// Wrapped source of a module file, stored as Latin-1 when it fits and as
+// UTF-16 otherwise so that strings can be backed by it directly.
+struct ModuleSource {
+  std::string version;
+  bool one_byte;
+  std::shared_ptr<Data> data;
+};
+
+static Mutex mutex;
+static std::unordered_map<std::string, std::shared_ptr<Data>> entries;
+static std::unordered_map<std::string, ModuleSource> modules;
+
+
+static std::string ModuleKey(const std::string& path,
+                             const std::string& version) {
+  return path + '\0' + version;
+}
+
+
+static std::shared_ptr<Data> Lookup(const std::string& key) {
+  Mutex::ScopedLock lock(mutex);
+  auto it = entries.find(key);
+  if (it == entries.end())
+    return std::shared_ptr<Data>();
+  return it->second;
+}
+
+
+MaybeLocal<Script> Compile(Environment* env,
+                           Local<String> source,
+                           ScriptOrigin* origin,
+                           const char* key) {
+  std::shared_ptr<Data> data = Lookup(key);
+
+  // The entry is kept alive by |data| for as long as V8 reads from it, even
+  // if another thread drops it in the meantime.
+  ScriptCompiler::CachedData* cached_data = nullptr;
+  ScriptCompiler::CompileOptions options = ScriptCompiler::kProduceCodeCache;
+  if (data) {
+    cached_data = new ScriptCompiler::CachedData(data->data(), data->size());
+    options = ScriptCompiler::kConsumeCodeCache;
+  }
+
+  ScriptCompiler::Source script_source(source, *origin, cached_data);
+  MaybeLocal<UnboundScript> script =
+      ScriptCompiler::CompileUnboundScript(env->isolate(),
+                                           &script_source,
+                                           options);
+  if (script.IsEmpty())
+    return MaybeLocal<Script>();
+
+  const ScriptCompiler::CachedData* result = script_source.GetCachedData();
+  if (options == ScriptCompiler::kConsumeCodeCache) {
+    // Produced under different V8 flags or from a different source; drop it
+    // so that the next script to be compiled under this name produces a new
+    // one.
+    if (result->rejected) {
+      Mutex::ScopedLock lock(mutex);
+      auto it = entries.find(key);
+      if (it != entries.end() && it->second == data)
+        entries.erase(it);
+    }
+  } else if (result != nullptr) {
+    std::shared_ptr<Data> produced =
+        std::make_shared<Data>(result->data, result->data + result->length);
+    Mutex::ScopedLock lock(mutex);
+    // Keep the first one when several threads raced to produce it.
+    entries.emplace(key, produced);
+  }
+
+  return script.ToLocalChecked()->BindToCurrentContext();
+}
+
+
+// Hands the cached source of a module to V8 without copying it. The data is
+// never modified once stored and is kept alive by the string as long as V8
+// needs it.
+template <typename ResourceType, typename TypeName>
+class SharedSource : public ResourceType {
+ public:
+  explicit SharedSource(std::shared_ptr<Data> data) : data_(data) {}
+
+  const TypeName* data() const override {
+    return reinterpret_cast<const TypeName*>(data_->data());
+  }
+  size_t length() const override { return data_->size() / sizeof(TypeName); }
+
+ private:
+  std::shared_ptr<Data> data_;
+};
+
+typedef SharedSource<String::ExternalOneByteStringResource, char>
+    SharedOneByteSource;
+typedef SharedSource<String::ExternalStringResource, uint16_t>
+    SharedTwoByteSource;
+
+
+MaybeLocal<String> GetModuleSource(Isolate* isolate,
+                                   const std::string& path,
+                                   const std::string& version) {
+  ModuleSource source;
+  {
+    Mutex::ScopedLock lock(mutex);
+    auto it = modules.find(path);
+    if (it == modules.end() || it->second.version != version)
+      return MaybeLocal<String>();
+    source = it->second;
+  }
+
+  if (source.one_byte)
+    return String::NewExternalOneByte(isolate,
+                                      new SharedOneByteSource(source.data));
+  return String::NewExternalTwoByte(isolate,
+                                    new SharedTwoByteSource(source.data));
+}
+
+
+void SetModuleSource(const std::string& path,
+                     const std::string& version,
+                     Local<String> source) {
+  ModuleSource entry;
+  entry.version = version;
+  entry.one_byte = source->ContainsOnlyOneByte();
+  if (entry.one_byte) {
+    entry.data = std::make_shared<Data>(source->Length());
+    source->WriteOneByte(entry.data->data(),
+                         0,
+                         -1,
+                         String::NO_NULL_TERMINATION);
+  } else {
+    entry.data = std::make_shared<Data>(source->Length() * sizeof(uint16_t));
+    source->Write(reinterpret_cast<uint16_t*>(entry.data->data()),
+                  0,
+                  -1,
+                  String::NO_NULL_TERMINATION);
+  }
+
+  Mutex::ScopedLock lock(mutex);
+  auto it = modules.find(path);
+  if (it != modules.end()) {
+    if (it->second.version == version)
+      return;
+    entries.erase(ModuleKey(path, it->second.version));
+  }
+  modules[path] = entry;
+}
+
+
+MaybeLocal<Script> CompileModule(Environment* env,
+                                 const std::string& path,
+                                 const std::string& version,
+                                 Local<String> source,
+                                 ScriptOrigin* origin) {
+  return Compile(env, source, origin, ModuleKey(path, version).c_str());
+}
+
+
+size_t Trim(bool all) {
+  size_t freed = 0;
+  Mutex::ScopedLock lock(mutex);
+  for (const auto& it : modules)
+    freed += it.second.data->size();
+  modules.clear();
+  if (all) {
+    for (const auto& it : entries)
+      freed += it.second->size();
+    entries.clear();
+  }
+  return freed;
+}
+
+
+// Compiles and runs a core library module, as runInThisContext() does, but
+// through the shared code cache. Used by NativeModule in bootstrap_node.js.
+static void RunInThisContext(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  Local<String> source = args[0].As<String>();
+  Local<String> filename = args[1].As<String>();
+  node::Utf8Value key(env->isolate(), filename);
+
+  TryCatch try_catch(env->isolate());
+  ScriptOrigin origin(filename);
+  MaybeLocal<Script> script = Compile(env, source, &origin, *key);
+  if (script.IsEmpty()) {
+    try_catch.ReThrow();
+    return;
+  }
+
+  MaybeLocal<Value> result = script.ToLocalChecked()->Run(env->context());
+  if (result.IsEmpty()) {
+    try_catch.ReThrow();
+    return;
+  }
+  args.GetReturnValue().Set(result.ToLocalChecked());
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "runInThisContext", RunInThisContext);
+}
+
+}  // namespace code_cache
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(code_cache, node::code_cache::Initialize)
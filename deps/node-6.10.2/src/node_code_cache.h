@@ -0,0 +1,63 @@
+#ifndef SRC_NODE_CODE_CACHE_H_
+#define SRC_NODE_CODE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "env.h"
+#include "v8.h"
+
+#include <string>
+
+namespace node {
+namespace code_cache {
+
+// Process-wide V8 code cache for the core library.
+//
+// Every isolate in the process bootstraps from the same bootstrap_node.js and
+// lib/*.js sources, so the code cache produced by the first environment to
+// compile a script can be consumed by all the ones started after it. Entries
+// are keyed by script name and shared across threads.
+
+// Compiles |source| as a script, consuming the cached data stored under |key|
+// or producing it if there is none yet.
+v8::MaybeLocal<v8::Script> Compile(Environment* env,
+                                   v8::Local<v8::String> source,
+                                   v8::ScriptOrigin* origin,
+                                   const char* key);
+
+// Module files loaded by require() are cached the same way, along with their
+// wrapped source, so that environments loading the same package neither read
+// nor compile it again. Entries are keyed by the file's real path and only
+// used while |version|, which identifies the file's size and modification
+// time, still matches. Storing a new version of a file drops the old one.
+
+// Returns the cached source of |path| or an empty handle if there is none
+// for |version|.
+v8::MaybeLocal<v8::String> GetModuleSource(v8::Isolate* isolate,
+                                           const std::string& path,
+                                           const std::string& version);
+
+// Stores |source|, the wrapped source of |path|, for |version|.
+void SetModuleSource(const std::string& path,
+                     const std::string& version,
+                     v8::Local<v8::String> source);
+
+// Compiles the wrapped source of |path| through the code cache.
+v8::MaybeLocal<v8::Script> CompileModule(Environment* env,
+                                         const std::string& path,
+                                         const std::string& version,
+                                         v8::Local<v8::String> source,
+                                         v8::ScriptOrigin* origin);
+
+// Frees memory under pressure: drops the cached module sources, which are
+// read again when needed, and the code cache too if |all|. Returns the number
+// of bytes dropped; data still in use by a string or a compile is freed once
+// it is done with it.
+size_t Trim(bool all);
+
+}  // namespace code_cache
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CODE_CACHE_H_
@@ -44,6 +44,9 @@ void InitConfig(Local<Object> target,
 
   if (config_preserve_symlinks)
     READONLY_BOOLEAN_PROPERTY("preserveSymlinks");
+
+  if (config_timer_wheel)
+    READONLY_BOOLEAN_PROPERTY("timerWheel");
 }  // InitConfig
 
 }  // namespace node
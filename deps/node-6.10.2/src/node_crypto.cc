@@ -28,6 +28,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <string>
+#include <vector>
+
 #define THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(val, prefix)                  \
   do {                                                                         \
     if (!Buffer::HasInstance(val) && !val->IsString()) {                       \
@@ -5633,6 +5636,287 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Digest contexts reused by HashMany(), shared by every thread in the process.
+// EVP_DigestInit_ex() keeps the state buffer of a context that last computed
+// the same digest, so a batch allocates nothing once the pool is warm.
+class DigestContextPool {
+ public:
+  static EVP_MD_CTX* Acquire() {
+    {
+      Mutex::ScopedLock scoped_lock(mutex_);
+      if (!idle_.empty()) {
+        EVP_MD_CTX* ctx = idle_.back();
+        idle_.pop_back();
+        return ctx;
+      }
+    }
+    return EVP_MD_CTX_create();
+  }
+
+  static void Release(EVP_MD_CTX* ctx) {
+    {
+      Mutex::ScopedLock scoped_lock(mutex_);
+      if (idle_.size() < kMaxIdle) {
+        idle_.push_back(ctx);
+        return;
+      }
+    }
+    EVP_MD_CTX_destroy(ctx);
+  }
+
+ private:
+  static const size_t kMaxIdle = 8;
+
+  static Mutex mutex_;
+  static std::vector<EVP_MD_CTX*> idle_;
+};
+
+Mutex DigestContextPool::mutex_;
+std::vector<EVP_MD_CTX*> DigestContextPool::idle_;
+
+
+// Only instantiate within a valid HandleScope.
+class HashManyRequest : public AsyncWrap {
+ public:
+  HashManyRequest(Environment* env,
+                  Local<Object> object,
+                  const EVP_MD* md,
+                  enum encoding encoding)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        md_(md),
+        encoding_(encoding),
+        size_(0),
+        error_(0) {
+    Wrap(object, this);
+  }
+
+  ~HashManyRequest() override {
+    ClearWrap(object());
+    persistent().Reset();
+  }
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+  // Adds a string or Buffer to the current input. Buffers are not copied, the
+  // caller keeps them alive until the work is done; see HashMany().
+  bool Append(Local<Value> value) {
+    Piece piece;
+    if (value->IsString()) {
+      node::Utf8Value string(env()->isolate(), value);
+      piece.data = nullptr;
+      piece.offset = strings_.size();
+      piece.length = string.length();
+      strings_.append(*string, string.length());
+    } else if (Buffer::HasInstance(value)) {
+      piece.data = Buffer::Data(value);
+      piece.offset = 0;
+      piece.length = Buffer::Length(value);
+    } else {
+      return false;
+    }
+    pieces_.push_back(piece);
+    size_ += piece.length;
+    return true;
+  }
+
+  // Ends the current input; the pieces added since the last call are hashed
+  // as if they were concatenated.
+  void EndInput() {
+    ends_.push_back(pieces_.size());
+  }
+
+  void Work() {
+    const unsigned int md_size = EVP_MD_size(md_);
+    digests_.resize(ends_.size() * md_size);
+
+    EVP_MD_CTX* ctx = DigestContextPool::Acquire();
+    if (ctx == nullptr) {
+      SetError();
+      return;
+    }
+
+    size_t piece = 0;
+    for (size_t i = 0; i < ends_.size() && error_ == 0; i++) {
+      if (EVP_DigestInit_ex(ctx, md_, nullptr) <= 0) {
+        SetError();
+        break;
+      }
+      for (; piece < ends_[i]; piece++) {
+        const Piece& p = pieces_[piece];
+        const char* data = p.data != nullptr ? p.data : &strings_[p.offset];
+        if (EVP_DigestUpdate(ctx, data, p.length) <= 0) {
+          SetError();
+          break;
+        }
+      }
+      unsigned int md_len;
+      if (error_ == 0 &&
+          EVP_DigestFinal_ex(ctx, &digests_[i * md_size], &md_len) <= 0) {
+        SetError();
+      }
+    }
+
+    DigestContextPool::Release(ctx);
+  }
+
+  // don't call this function without a valid HandleScope
+  void Check(Local<Value> argv[2]) {
+    Isolate* isolate = env()->isolate();
+
+    if (error_ != 0) {
+      char errmsg[256] = "Digest failed";
+      if (error_ != static_cast<unsigned long>(-1))  // NOLINT(runtime/int)
+        ERR_error_string_n(error_, errmsg, sizeof errmsg);
+      argv[0] = Exception::Error(OneByteString(isolate, errmsg));
+      argv[1] = Null(isolate);
+      return;
+    }
+
+    const size_t md_size = EVP_MD_size(md_);
+    Local<Array> digests = Array::New(isolate, ends_.size());
+    for (size_t i = 0; i < ends_.size(); i++) {
+      const char* digest =
+          reinterpret_cast<const char*>(&digests_[i * md_size]);
+      digests->Set(i, StringBytes::Encode(isolate, digest, md_size,
+                                          encoding_));
+    }
+    argv[0] = Null(isolate);
+    argv[1] = digests;
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  uv_work_t work_req_;
+
+ private:
+  void SetError() {
+    error_ = ERR_get_error();
+    if (error_ == 0)
+      error_ = static_cast<unsigned long>(-1);  // NOLINT(runtime/int)
+  }
+
+  // Either borrowed Buffer memory or, for strings, an offset into strings_.
+  struct Piece {
+    const char* data;
+    size_t offset;
+    size_t length;
+  };
+
+  const EVP_MD* md_;
+  const enum encoding encoding_;
+  std::vector<Piece> pieces_;
+  // One past the last piece of every input.
+  std::vector<size_t> ends_;
+  std::string strings_;
+  std::vector<unsigned char> digests_;
+  size_t size_;
+  unsigned long error_;  // NOLINT(runtime/int)
+};
+
+
+void HashManyWork(uv_work_t* work_req) {
+  HashManyRequest* req = ContainerOf(&HashManyRequest::work_req_, work_req);
+  req->Work();
+}
+
+
+void HashManyAfter(uv_work_t* work_req, int status) {
+  CHECK_EQ(status, 0);
+  HashManyRequest* req = ContainerOf(&HashManyRequest::work_req_, work_req);
+  Environment* env = req->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> argv[2];
+  req->Check(argv);
+  req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+  delete req;
+}
+
+
+static const size_t kHashManyAsyncSize = 64 * 1024;
+
+// hashMany(algorithm, inputs, encoding[, callback])
+// Every input is a string, a Buffer or an array of those. With a callback,
+// batches of kHashManyAsyncSize bytes and more are hashed on the thread pool
+// and the request object is returned; smaller ones are hashed right away and
+// the array of digests is returned, as without a callback.
+void HashMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsArray());
+
+  const node::Utf8Value hash_type(env->isolate(), args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*hash_type);
+  if (md == nullptr)
+    return env->ThrowError("Digest method not supported");
+
+  enum encoding encoding = ParseEncoding(env->isolate(), args[2], BUFFER);
+
+  Local<Array> inputs = args[1].As<Array>();
+  Local<Object> obj = env->NewInternalFieldObject();
+  HashManyRequest* req = new HashManyRequest(env, obj, md, encoding);
+  // Every Buffer the request borrows from, including the parts of nested
+  // arrays. The caller may empty or reuse its own arrays while the work is
+  // queued, so only this one, which nothing else can reach, keeps them alive.
+  Local<Array> buffers = Array::New(env->isolate());
+  auto append = [&](Local<Value> value) {
+    if (!req->Append(value))
+      return false;
+    if (Buffer::HasInstance(value))
+      buffers->Set(buffers->Length(), value);
+    return true;
+  };
+
+  for (uint32_t i = 0; i < inputs->Length(); i++) {
+    Local<Value> input = inputs->Get(i);
+    bool ok = true;
+    if (input->IsArray()) {
+      Local<Array> parts = input.As<Array>();
+      for (uint32_t j = 0; ok && j < parts->Length(); j++)
+        ok = append(parts->Get(j));
+    } else {
+      ok = append(input);
+    }
+    if (!ok) {
+      delete req;
+      return env->ThrowTypeError("Data must be a string or a buffer");
+    }
+    req->EndInput();
+  }
+
+  if (args[3]->IsFunction() && req->size() >= kHashManyAsyncSize) {
+    obj->Set(FIXED_ONE_BYTE_STRING(args.GetIsolate(), "ondone"), args[3]);
+    // Keeps the Buffers alive while they are hashed.
+    obj->Set(FIXED_ONE_BYTE_STRING(args.GetIsolate(), "buffers"), buffers);
+
+    if (env->in_domain())
+      obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    uv_queue_work(env->event_loop(),
+                  req->work_req(),
+                  HashManyWork,
+                  HashManyAfter);
+    args.GetReturnValue().Set(obj);
+  } else {
+    Local<Value> argv[2];
+    req->Work();
+    req->Check(argv);
+    delete req;
+
+    if (!argv[0]->IsNull())
+      env->isolate()->ThrowException(argv[0]);
+    else
+      args.GetReturnValue().Set(argv[1]);
+  }
+}
+
+
 void GetSSLCiphers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -6057,6 +6341,7 @@ void InitCrypto(Local<Object> target,
   env->SetMethod(target, "setFipsCrypto", SetFipsCrypto);
   env->SetMethod(target, "PBKDF2", PBKDF2);
   env->SetMethod(target, "randomBytes", RandomBytes);
+  env->SetMethod(target, "hashMany", HashMany);
   env->SetMethod(target, "timingSafeEqual", TimingSafeEqual);
   env->SetMethod(target, "getSSLCiphers", GetSSLCiphers);
   env->SetMethod(target, "getCiphers", GetCiphers);
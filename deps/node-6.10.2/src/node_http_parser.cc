@@ -40,6 +40,9 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::NewStringType;
+using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Uint32;
@@ -69,6 +72,115 @@ const uint32_t kOnExecute = 4;
   int name##_(const char* at, size_t length)
 
 
+// Well-known header names, as they are usually spelled on the wire and in
+// lower case. Header fields spelled exactly either way are handed to JS land
+// as internalized strings: V8 finds those in its string table instead of
+// allocating a new string for every request, and they need no further
+// internalizing when used as property keys of IncomingMessage#headers.
+// Other fields are not interned so that peers cannot grow the string table.
+#define HTTP_KNOWN_HEADERS(V)                                                 \
+  V("Accept", "accept")                                                       \
+  V("Accept-Charset", "accept-charset")                                       \
+  V("Accept-Encoding", "accept-encoding")                                     \
+  V("Accept-Language", "accept-language")                                     \
+  V("Accept-Ranges", "accept-ranges")                                         \
+  V("Access-Control-Allow-Origin", "access-control-allow-origin")             \
+  V("Age", "age")                                                             \
+  V("Authorization", "authorization")                                         \
+  V("Cache-Control", "cache-control")                                         \
+  V("Connection", "connection")                                               \
+  V("Content-Disposition", "content-disposition")                             \
+  V("Content-Encoding", "content-encoding")                                   \
+  V("Content-Language", "content-language")                                   \
+  V("Content-Length", "content-length")                                       \
+  V("Content-Location", "content-location")                                   \
+  V("Content-Range", "content-range")                                         \
+  V("Content-Type", "content-type")                                           \
+  V("Cookie", "cookie")                                                       \
+  V("Date", "date")                                                           \
+  V("DNT", "dnt")                                                             \
+  V("ETag", "etag")                                                           \
+  V("Expect", "expect")                                                       \
+  V("Expires", "expires")                                                     \
+  V("From", "from")                                                           \
+  V("Host", "host")                                                           \
+  V("If-Match", "if-match")                                                   \
+  V("If-Modified-Since", "if-modified-since")                                 \
+  V("If-None-Match", "if-none-match")                                         \
+  V("If-Range", "if-range")                                                   \
+  V("If-Unmodified-Since", "if-unmodified-since")                             \
+  V("Keep-Alive", "keep-alive")                                               \
+  V("Last-Modified", "last-modified")                                         \
+  V("Link", "link")                                                           \
+  V("Location", "location")                                                   \
+  V("Max-Forwards", "max-forwards")                                           \
+  V("Origin", "origin")                                                       \
+  V("Pragma", "pragma")                                                       \
+  V("Proxy-Authenticate", "proxy-authenticate")                               \
+  V("Proxy-Authorization", "proxy-authorization")                             \
+  V("Range", "range")                                                         \
+  V("Referer", "referer")                                                     \
+  V("Retry-After", "retry-after")                                             \
+  V("Server", "server")                                                       \
+  V("Set-Cookie", "set-cookie")                                               \
+  V("TE", "te")                                                               \
+  V("Trailer", "trailer")                                                     \
+  V("Transfer-Encoding", "transfer-encoding")                                 \
+  V("Upgrade", "upgrade")                                                     \
+  V("Upgrade-Insecure-Requests", "upgrade-insecure-requests")                 \
+  V("User-Agent", "user-agent")                                               \
+  V("Vary", "vary")                                                           \
+  V("Via", "via")                                                             \
+  V("Warning", "warning")                                                     \
+  V("WWW-Authenticate", "www-authenticate")                                   \
+  V("X-Forwarded-For", "x-forwarded-for")                                     \
+  V("X-Forwarded-Host", "x-forwarded-host")                                   \
+  V("X-Forwarded-Proto", "x-forwarded-proto")                                 \
+  V("X-Requested-With", "x-requested-with")                                   \
+
+
+struct KnownHeader {
+  const char* name;
+  const char* lower;
+  size_t length;
+};
+
+static const KnownHeader known_headers[] = {
+#define V(name, lower) { name, lower, sizeof(name) - 1 },
+  HTTP_KNOWN_HEADERS(V)
+#undef V
+};
+
+
+// Returns the spelling of a well-known header name that |str| matches
+// exactly, or nullptr.
+static const char* FindKnownHeader(const char* str, size_t size) {
+  if (size == 0)
+    return nullptr;
+
+  const char first = str[0] | 0x20;  // Lower case, for ASCII letters.
+  for (const KnownHeader& header : known_headers) {
+    if (header.length != size || header.lower[0] != first)
+      continue;
+    if (memcmp(str, header.lower, size) == 0)
+      return header.lower;
+    if (memcmp(str, header.name, size) == 0)
+      return header.name;
+  }
+  return nullptr;
+}
+
+
+static inline Local<String> InternalizedString(Environment* env,
+                                               const char* str,
+                                               size_t size) {
+  return String::NewFromOneByte(env->isolate(),
+                                reinterpret_cast<const uint8_t*>(str),
+                                NewStringType::kInternalized,
+                                size).ToLocalChecked();
+}
+
+
 // helper class for the Parser
 struct StringPtr {
   StringPtr() {
@@ -135,6 +247,15 @@ struct StringPtr {
   }
 
 
+  // Like ToString(), but well-known header names are internalized.
+  Local<String> ToHeaderName(Environment* env) const {
+    const char* known = FindKnownHeader(str_, size_);
+    if (known != nullptr)
+      return InternalizedString(env, known, size_);
+    return ToString(env);
+  }
+
+
   const char* str_;
   bool on_heap_;
   size_t size_;
@@ -235,6 +356,7 @@ class Parser : public AsyncWrap {
       A_STATUS_MESSAGE,
       A_UPGRADE,
       A_SHOULD_KEEP_ALIVE,
+      A_CONTENT_LENGTH,
       A_MAX
     };
 
@@ -284,6 +406,14 @@ class Parser : public AsyncWrap {
 
     argv[A_UPGRADE] = Boolean::New(env()->isolate(), parser_.upgrade);
 
+    // http_parser has already parsed and validated Content-Length; until the
+    // body is read, content_length holds its value.
+    if (parser_.flags & F_CONTENTLENGTH) {
+      argv[A_CONTENT_LENGTH] =
+          Number::New(env()->isolate(),
+                      static_cast<double>(parser_.content_length));
+    }
+
     Environment::AsyncCallbackScope callback_scope(env());
 
     Local<Value> head_response =
@@ -647,7 +777,7 @@ class Parser : public AsyncWrap {
     do {
       size_t j = 0;
       while (i < num_values_ && j < arraysize(argv) / 2) {
-        argv[j * 2] = fields_[i].ToString(env());
+        argv[j * 2] = fields_[i].ToHeaderName(env());
         argv[j * 2 + 1] = values_[i].ToString(env());
         i++;
         j++;
@@ -763,6 +893,17 @@ void InitHttpParser(Local<Object> target,
 #undef V
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "methods"), methods);
 
+  // Maps both spellings of every well-known header name to the lower case
+  // one, and keeps the internalized strings alive.
+  Local<Object> known = Object::New(env->isolate());
+  known->SetPrototype(env->context(), Null(env->isolate())).FromJust();
+  for (const KnownHeader& header : known_headers) {
+    Local<String> lower = InternalizedString(env, header.lower, header.length);
+    known->Set(InternalizedString(env, header.name, header.length), lower);
+    known->Set(lower, lower);
+  }
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "knownHeaders"), known);
+
   env->SetProtoMethod(t, "close", Parser::Close);
   env->SetProtoMethod(t, "execute", Parser::Execute);
   env->SetProtoMethod(t, "finish", Parser::Finish);
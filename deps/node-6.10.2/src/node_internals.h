@@ -41,6 +41,11 @@ extern const char* openssl_config;
 // that is used by lib/module.js
 extern bool config_preserve_symlinks;
 
+// Set in node.cc by ParseArgs when --timer-wheel is used.
+// Used in node_config.cc to set a constant on process.binding('config')
+// that is used by lib/timers.js
+extern bool config_timer_wheel;
+
 // Forward declaration
 class Environment;
 
@@ -187,6 +192,11 @@ class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
     { return node::Malloc(size); }
   virtual void Free(void* data, size_t) { free(data); }
 
+ protected:
+  // Whether Allocate() must zero fill.  Consumes the fill flag set by
+  // Buffer.allocUnsafe().  Defined in src/node.cc
+  bool ZeroFill();
+
  private:
   Environment* env_;
 };
@@ -5,6 +5,9 @@
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
+#include "node_mutex.h"
+#include "req-wrap.h"
+#include "req-wrap-inl.h"
 #include "util.h"
 #include "util-inl.h"
 
@@ -16,6 +19,9 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace node {
 
 using v8::Array;
@@ -25,8 +31,10 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::Null;
 using v8::Number;
 using v8::Object;
+using v8::Undefined;
 using v8::Value;
 
 enum node_zlib_mode {
@@ -649,6 +657,447 @@ class ZCtx : public AsyncWrap {
 };
 
 
+/**
+ * One-shot Deflate/Inflate of a whole buffer
+ */
+struct ZStreamParams {
+  bool deflate;
+  int window_bits;
+  int level;
+  int mem_level;
+  int strategy;
+
+  bool operator==(const ZStreamParams& other) const {
+    return deflate == other.deflate &&
+           window_bits == other.window_bits &&
+           level == other.level &&
+           mem_level == other.mem_level &&
+           strategy == other.strategy;
+  }
+};
+
+
+// Idle streams for the one-shot functions, shared by every Environment in the
+// process. A stream is reset when it is returned, so the next request with
+// the same parameters skips deflateInit2()/inflateInit2() and the window and
+// hash allocations they make. Streams are allocated on the heap because zlib
+// remembers their address.
+class ZStreamPool {
+ public:
+  // Returns a stream ready for use, or nullptr with the zlib error in |*err|.
+  static z_stream* Acquire(const ZStreamParams& params, int* err);
+  // Keeps |strm| for later, or frees it if it cannot be reset or the pool is
+  // full.
+  static void Release(const ZStreamParams& params, z_stream* strm);
+
+ private:
+  static void Free(const ZStreamParams& params, z_stream* strm);
+
+  static const size_t kMaxIdle = 8;
+
+  static Mutex mutex_;
+  static std::vector<std::pair<ZStreamParams, z_stream*>> idle_;
+};
+
+Mutex ZStreamPool::mutex_;
+std::vector<std::pair<ZStreamParams, z_stream*>> ZStreamPool::idle_;
+
+
+z_stream* ZStreamPool::Acquire(const ZStreamParams& params, int* err) {
+  {
+    Mutex::ScopedLock scoped_lock(mutex_);
+    // Most recently returned last.
+    for (size_t i = idle_.size(); i > 0; i--) {
+      if (idle_[i - 1].first == params) {
+        z_stream* strm = idle_[i - 1].second;
+        idle_.erase(idle_.begin() + (i - 1));
+        *err = Z_OK;
+        return strm;
+      }
+    }
+  }
+
+  z_stream* strm = new z_stream();
+  strm->zalloc = Z_NULL;
+  strm->zfree = Z_NULL;
+  strm->opaque = Z_NULL;
+
+  if (params.deflate) {
+    *err = deflateInit2(strm,
+                        params.level,
+                        Z_DEFLATED,
+                        params.window_bits,
+                        params.mem_level,
+                        params.strategy);
+  } else {
+    *err = inflateInit2(strm, params.window_bits);
+  }
+
+  if (*err != Z_OK) {
+    delete strm;
+    return nullptr;
+  }
+  return strm;
+}
+
+
+void ZStreamPool::Release(const ZStreamParams& params, z_stream* strm) {
+  const int err = params.deflate ? deflateReset(strm) : inflateReset(strm);
+  if (err != Z_OK)
+    return Free(params, strm);
+
+  std::pair<ZStreamParams, z_stream*> evicted(params, nullptr);
+  {
+    Mutex::ScopedLock scoped_lock(mutex_);
+    if (idle_.size() == kMaxIdle) {
+      evicted = idle_.front();
+      idle_.erase(idle_.begin());
+    }
+    idle_.push_back(std::make_pair(params, strm));
+  }
+
+  if (evicted.second != nullptr)
+    Free(evicted.first, evicted.second);
+}
+
+
+void ZStreamPool::Free(const ZStreamParams& params, z_stream* strm) {
+  if (params.deflate)
+    (void)deflateEnd(strm);
+  else
+    (void)inflateEnd(strm);
+  delete strm;
+}
+
+
+// Compresses or decompresses a whole buffer with Z_FINISH. Run() does not
+// touch V8 and may be called on the thread pool.
+class ZlibBufferJob {
+ public:
+  ZlibBufferJob() : out_(nullptr) {}
+
+  ~ZlibBufferJob() {
+    free(out_);
+  }
+
+  void Init(node_zlib_mode mode, int window_bits, int level, int mem_level,
+            int strategy, const char* in, size_t in_len,
+            const char* dictionary, size_t dictionary_len) {
+    mode_ = mode;
+    in_ = reinterpret_cast<const Bytef*>(in);
+    in_len_ = in_len;
+    dictionary_.assign(dictionary, dictionary + dictionary_len);
+
+    // Same as ZCtx::Init().
+    if (mode == GZIP || mode == GUNZIP)
+      window_bits += 16;
+    if (mode == UNZIP)
+      window_bits += 32;
+    if (mode == DEFLATERAW || mode == INFLATERAW)
+      window_bits *= -1;
+
+    params_.deflate = mode == DEFLATE || mode == GZIP || mode == DEFLATERAW;
+    params_.window_bits = window_bits;
+    // Inflate streams only differ by their window.
+    params_.level = params_.deflate ? level : 0;
+    params_.mem_level = params_.deflate ? mem_level : 0;
+    params_.strategy = params_.deflate ? strategy : 0;
+  }
+
+  void Run() {
+    z_stream* strm = ZStreamPool::Acquire(params_, &err_);
+    if (strm == nullptr) {
+      message_ = "Init error";
+      return;
+    }
+
+    Process(strm);
+    if (message_ != nullptr && strm->msg != nullptr)
+      message_ = strm->msg;
+
+    ZStreamPool::Release(params_, strm);
+  }
+
+  // Returns the output as a Buffer, or an empty handle after a failure.
+  Local<Value> Result(Environment* env) {
+    if (message_ != nullptr || too_large_)
+      return Local<Value>();
+
+    char* data = out_;
+    out_ = nullptr;
+    if (length_ == 0) {
+      free(data);
+      data = nullptr;
+    } else if (length_ < capacity_) {
+      char* shrunk = static_cast<char*>(realloc(data, length_));
+      if (shrunk != nullptr)
+        data = shrunk;
+    }
+    return Buffer::New(env, data, length_).ToLocalChecked();
+  }
+
+  // The arguments of the 'oncomplete' callback: message, errno and output.
+  // A null message without output means it would not fit in a Buffer.
+  void Results(Environment* env, Local<Value> argv[3]) {
+    Local<Value> buffer = Result(env);
+    if (!buffer.IsEmpty()) {
+      argv[0] = Null(env->isolate());
+      argv[1] = Integer::New(env->isolate(), Z_OK);
+      argv[2] = buffer;
+      return;
+    }
+    if (message_ != nullptr)
+      argv[0] = OneByteString(env->isolate(), message_);
+    else
+      argv[0] = Null(env->isolate());
+    argv[1] = Integer::New(env->isolate(), err_);
+    argv[2] = Undefined(env->isolate());
+  }
+
+ private:
+  bool Grow(z_stream* strm) {
+    if (capacity_ == Buffer::kMaxLength) {
+      too_large_ = true;
+      return false;
+    }
+
+    const size_t capacity = std::min<size_t>(
+        std::max<size_t>(capacity_ * 2, 1024), Buffer::kMaxLength);
+    char* out = static_cast<char*>(realloc(out_, capacity));
+    if (out == nullptr) {
+      err_ = Z_MEM_ERROR;
+      message_ = "Zlib error";
+      return false;
+    }
+
+    out_ = out;
+    capacity_ = capacity;
+    strm->next_out = reinterpret_cast<Bytef*>(out_ + length_);
+    strm->avail_out = capacity_ - length_;
+    return true;
+  }
+
+  void Process(z_stream* strm) {
+    // Members after the first are only decoded for gzip input, as
+    // ZCtx::Process() does.
+    const bool multi_member =
+        mode_ == GUNZIP ||
+        (mode_ == UNZIP && in_len_ >= 2 &&
+         in_[0] == GZIP_HEADER_ID1 && in_[1] == GZIP_HEADER_ID2);
+
+    if (!dictionary_.empty() &&
+        (mode_ == DEFLATE || mode_ == DEFLATERAW || mode_ == INFLATERAW)) {
+      if (mode_ == INFLATERAW)
+        err_ = inflateSetDictionary(strm, dictionary_.data(),
+                                    dictionary_.size());
+      else
+        err_ = deflateSetDictionary(strm, dictionary_.data(),
+                                    dictionary_.size());
+      if (err_ != Z_OK) {
+        message_ = "Failed to set dictionary";
+        return;
+      }
+    }
+
+    strm->next_in = const_cast<Bytef*>(in_);
+    strm->avail_in = in_len_;
+    if (params_.deflate)
+      capacity_ = deflateBound(strm, in_len_);
+    else
+      capacity_ = std::max<size_t>(in_len_ * 4, 1024);
+    capacity_ = std::min<size_t>(capacity_, Buffer::kMaxLength);
+    out_ = static_cast<char*>(malloc(capacity_));
+    if (out_ == nullptr) {
+      capacity_ = 0;
+      err_ = Z_MEM_ERROR;
+      message_ = "Zlib error";
+      return;
+    }
+    strm->next_out = reinterpret_cast<Bytef*>(out_);
+    strm->avail_out = capacity_;
+
+    for (;;) {
+      if (strm->avail_out == 0 && !Grow(strm))
+        return;
+
+      if (params_.deflate) {
+        err_ = deflate(strm, Z_FINISH);
+      } else {
+        err_ = inflate(strm, Z_FINISH);
+
+        if (mode_ != INFLATERAW && err_ == Z_NEED_DICT &&
+            !dictionary_.empty()) {
+          err_ = inflateSetDictionary(strm, dictionary_.data(),
+                                      dictionary_.size());
+          if (err_ == Z_OK)
+            err_ = inflate(strm, Z_FINISH);
+          else if (err_ == Z_DATA_ERROR)
+            err_ = Z_NEED_DICT;
+        }
+
+        while (multi_member &&
+               err_ == Z_STREAM_END &&
+               strm->avail_in > 0 &&
+               strm->next_in[0] != 0x00) {
+          err_ = inflateReset(strm);
+          if (err_ == Z_OK)
+            err_ = inflate(strm, Z_FINISH);
+        }
+      }
+
+      length_ = reinterpret_cast<char*>(strm->next_out) - out_;
+
+      switch (err_) {
+        case Z_STREAM_END:
+          return;
+        case Z_OK:
+        case Z_BUF_ERROR:
+          // Out of room, or else out of input.
+          if (strm->avail_out == 0)
+            continue;
+          message_ = "unexpected end of file";
+          return;
+        case Z_NEED_DICT:
+          message_ = dictionary_.empty() ? "Missing dictionary" :
+                                           "Bad dictionary";
+          return;
+        default:
+          message_ = "Zlib error";
+          return;
+      }
+    }
+  }
+
+  node_zlib_mode mode_;
+  ZStreamParams params_;
+  const Bytef* in_;
+  size_t in_len_;
+  std::vector<Bytef> dictionary_;
+
+  char* out_;
+  size_t capacity_ = 0;
+  size_t length_ = 0;
+  bool too_large_ = false;
+  int err_ = Z_OK;
+  const char* message_ = nullptr;
+};
+
+
+class ZlibBufferReq : public ReqWrap<uv_work_t> {
+ public:
+  ZlibBufferReq(Environment* env, Local<Object> req_wrap_obj)
+      : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_ZLIB) {
+    Wrap(req_wrap_obj, this);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  ZlibBufferJob job_;
+};
+
+
+// Inputs smaller than this are handled on the calling thread even when a
+// callback is wanted; queueing them would cost more than the work itself.
+static const size_t kZlibBufferInlineLimit = 1024;
+
+
+static void NewZlibBufferReq(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+}
+
+
+static void ZlibBufferWork(uv_work_t* req) {
+  static_cast<ZlibBufferReq*>(req->data)->job_.Run();
+}
+
+
+static void AfterZlibBuffer(uv_work_t* req, int status) {
+  CHECK_EQ(status, 0);
+
+  ZlibBufferReq* req_wrap = static_cast<ZlibBufferReq*>(req->data);
+  Environment* env = req_wrap->env();
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Value> argv[3];
+  req_wrap->job_.Results(env, argv);
+  req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+
+  delete req_wrap;
+}
+
+
+// zlibBuffer(req, mode, buffer, windowBits, level, memLevel, strategy,
+//            [dictionary])
+// With a |req| object, inputs of kZlibBufferInlineLimit bytes and more are
+// processed on the thread pool and the result is passed to req.oncomplete().
+// Otherwise the result is returned: a Buffer, or [message, errno] on failure.
+static void ZlibBuffer(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[1]->IsInt32());
+  node_zlib_mode mode = static_cast<node_zlib_mode>(args[1]->Int32Value());
+  CHECK(mode >= DEFLATE && mode <= UNZIP);
+  CHECK(Buffer::HasInstance(args[2]));
+
+  const char* in = Buffer::Data(args[2]);
+  const size_t in_len = Buffer::Length(args[2]);
+
+  int window_bits = args[3]->Uint32Value();
+  CHECK((window_bits >= 8 && window_bits <= 15) && "invalid windowBits");
+  int level = args[4]->Int32Value();
+  CHECK((level >= -1 && level <= 9) && "invalid compression level");
+  int mem_level = args[5]->Uint32Value();
+  CHECK((mem_level >= 1 && mem_level <= 9) && "invalid memlevel");
+  int strategy = args[6]->Uint32Value();
+  CHECK((strategy == Z_FILTERED ||
+         strategy == Z_HUFFMAN_ONLY ||
+         strategy == Z_RLE ||
+         strategy == Z_FIXED ||
+         strategy == Z_DEFAULT_STRATEGY) && "invalid strategy");
+
+  const char* dictionary = nullptr;
+  size_t dictionary_len = 0;
+  if (Buffer::HasInstance(args[7])) {
+    dictionary = Buffer::Data(args[7]);
+    dictionary_len = Buffer::Length(args[7]);
+  }
+
+  if (args[0]->IsObject() && in_len >= kZlibBufferInlineLimit) {
+    // The caller keeps the input alive on the request object.
+    ZlibBufferReq* req_wrap =
+        new ZlibBufferReq(env, args[0].As<Object>());
+    req_wrap->job_.Init(mode, window_bits, level, mem_level, strategy,
+                        in, in_len, dictionary, dictionary_len);
+    req_wrap->Dispatched();
+    uv_queue_work(env->event_loop(),
+                  req_wrap->req(),
+                  ZlibBufferWork,
+                  AfterZlibBuffer);
+    return;
+  }
+
+  if (!args[0]->IsObject())
+    env->PrintSyncTrace();
+
+  ZlibBufferJob job;
+  job.Init(mode, window_bits, level, mem_level, strategy,
+           in, in_len, dictionary, dictionary_len);
+  job.Run();
+
+  Local<Value> argv[3];
+  job.Results(env, argv);
+  if (argv[0]->IsNull() && !argv[2]->IsUndefined())
+    return args.GetReturnValue().Set(argv[2]);
+
+  Local<Array> result = Array::New(env->isolate(), 2);
+  result->Set(0, argv[0]);
+  result->Set(1, argv[1]);
+  args.GetReturnValue().Set(result);
+}
+
+
 void InitZlib(Local<Object> target,
               Local<Value> unused,
               Local<Context> context,
@@ -668,6 +1117,15 @@ void InitZlib(Local<Object> target,
   z->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"));
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"), z->GetFunction());
 
+  Local<FunctionTemplate> zbr =
+      FunctionTemplate::New(env->isolate(), NewZlibBufferReq);
+  zbr->InstanceTemplate()->SetInternalFieldCount(1);
+  zbr->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "ZlibBufferReq"));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ZlibBufferReq"),
+              zbr->GetFunction());
+
+  env->SetMethod(target, "zlibBuffer", ZlibBuffer);
+
   // valid flush values.
   NODE_DEFINE_CONSTANT(target, Z_NO_FLUSH);
   NODE_DEFINE_CONSTANT(target, Z_PARTIAL_FLUSH);
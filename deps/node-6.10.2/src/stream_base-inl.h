@@ -52,6 +52,13 @@ void StreamBase::AddMethods(Environment* env,
                                      v8::DEFAULT,
                                      attributes);
 
+  t->InstanceTemplate()->SetAccessor(env->bytes_copied_string(),
+                                     GetBytesCopied<Base>,
+                                     nullptr,
+                                     env->as_external(),
+                                     v8::DEFAULT,
+                                     attributes);
+
   env->SetProtoMethod(t, "readStart", JSMethod<Base, &StreamBase::ReadStart>);
   env->SetProtoMethod(t, "readStop", JSMethod<Base, &StreamBase::ReadStop>);
   if ((flags & kFlagNoShutdown) == 0)
@@ -110,6 +117,20 @@ void StreamBase::GetBytesRead(Local<String> key,
 }
 
 
+template <class Base>
+void StreamBase::GetBytesCopied(Local<String> key,
+                                const PropertyCallbackInfo<Value>& args) {
+  Base* handle = Unwrap<Base>(args.Holder());
+
+  ASSIGN_OR_RETURN_UNWRAP(&handle,
+                          args.Holder(),
+                          args.GetReturnValue().Set(0));
+
+  StreamBase* wrap = static_cast<StreamBase*>(handle);
+  args.GetReturnValue().Set(static_cast<double>(wrap->bytes_copied_));
+}
+
+
 template <class Base>
 void StreamBase::GetExternal(Local<String> key,
                              const PropertyCallbackInfo<Value>& args) {
@@ -8,6 +8,7 @@
 #include "env-inl.h"
 #include "js_stream.h"
 #include "string_bytes.h"
+#include "string_bytes_simd.h"
 #include "util.h"
 #include "util-inl.h"
 #include "v8.h"
@@ -21,6 +22,7 @@ using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Number;
 using v8::Object;
@@ -89,6 +91,57 @@ void StreamBase::AfterShutdown(ShutdownWrap* req_wrap, int status) {
 }
 
 
+// Strings at least this long are made external by Writev() when they are not
+// already, so that this write and any later one of the same string can go
+// out without copying it. Shorter ones are cheaper to copy.
+static const size_t kExternalizeThreshold = 64 * 1024;
+
+
+// Points |buf| at the bytes |string| is written as in |encoding| if they are
+// the contents of an external string as they are, which don't move and stay
+// valid for as long as the string is alive.
+static bool ExternalChunk(Isolate* isolate,
+                          Local<String> string,
+                          enum encoding encoding,
+                          uv_buf_t* buf) {
+  if (string->IsOneByte() &&
+      !string->IsExternalOneByte() &&
+      static_cast<size_t>(string->Length()) >= kExternalizeThreshold &&
+      (encoding == LATIN1 || encoding == ASCII || encoding == UTF8)) {
+    StringBytes::Externalize(isolate, string);
+  }
+
+  const char* data;
+  size_t length;
+  if (!StringBytes::GetExternalParts(isolate, string, &data, &length) ||
+      length == 0) {
+    return false;
+  }
+
+  switch (encoding) {
+    case LATIN1:
+    case ASCII:
+      // Written as the raw one-byte contents, see StringBytes::Write().
+      if (!string->IsExternalOneByte())
+        return false;
+      break;
+    case UTF8:
+      if (!string->IsExternalOneByte() || !simd::IsAscii(data, length))
+        return false;
+      break;
+    case UCS2:
+      if (string->IsExternalOneByte() || IsBigEndian())
+        return false;
+      break;
+    default:
+      return false;
+  }
+
+  *buf = uv_buf_init(const_cast<char*>(data), length);
+  return true;
+}
+
+
 int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -102,10 +155,14 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 
   MaybeStackBuffer<uv_buf_t, 16> bufs(count);
 
-  // Determine storage size first
+  // Determine storage size first. String chunks written straight from an
+  // external string need none and are pointed at by |bufs| right away. Like
+  // Buffer chunks, they are kept alive by the caller, which holds on to
+  // |chunks| until the write is done, see Socket#_writeGeneric() in net.js.
   size_t storage_size = 0;
   for (size_t i = 0; i < count; i++) {
     storage_size = ROUND_UP(storage_size, WriteWrap::kAlignSize);
+    bufs[i] = uv_buf_init(nullptr, 0);
 
     Local<Value> chunk = chunks->Get(i * 2);
 
@@ -117,6 +174,11 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
     Local<String> string = chunk->ToString(env->isolate());
     enum encoding encoding = ParseEncoding(env->isolate(),
                                            chunks->Get(i * 2 + 1));
+    if (chunk->IsString() &&
+        ExternalChunk(env->isolate(), string, encoding, &bufs[i])) {
+      continue;
+    }
+
     size_t chunk_size;
     if (encoding == UTF8 && string->Length() > 65535)
       chunk_size = StringBytes::Size(env->isolate(), string, encoding);
@@ -138,6 +200,12 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   uint32_t bytes = 0;
   size_t offset = 0;
   for (size_t i = 0; i < count; i++) {
+    // External string, already set up above
+    if (bufs[i].base != nullptr) {
+      bytes += bufs[i].len;
+      continue;
+    }
+
     Local<Value> chunk = chunks->Get(i * 2);
 
     // Write buffer
@@ -166,6 +234,7 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
     bufs[i].len = str_size;
     offset += str_size;
     bytes += str_size;
+    bytes_copied_ += str_size;
   }
 
   int err = DoWrite(req_wrap, *bufs, count, nullptr);
@@ -274,6 +343,7 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
                                    storage_size,
                                    string,
                                    enc);
+    bytes_copied_ += data_size;
     buf = uv_buf_init(stack_storage, data_size);
 
     uv_buf_t* bufs = &buf;
@@ -307,6 +377,7 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
                                    storage_size,
                                    string,
                                    enc);
+    bytes_copied_ += data_size;
   }
 
   CHECK_LE(data_size, storage_size);
@@ -235,7 +235,8 @@ class StreamBase : public StreamResource {
                 v8::Local<v8::Object> handle);
 
  protected:
-  explicit StreamBase(Environment* env) : env_(env), consumed_(false) {
+  explicit StreamBase(Environment* env)
+      : env_(env), consumed_(false), bytes_copied_(0) {
   }
 
   virtual ~StreamBase() = default;
@@ -269,6 +270,10 @@ class StreamBase : public StreamResource {
   static void GetBytesRead(v8::Local<v8::String> key,
                            const v8::PropertyCallbackInfo<v8::Value>& args);
 
+  template <class Base>
+  static void GetBytesCopied(v8::Local<v8::String> key,
+                             const v8::PropertyCallbackInfo<v8::Value>& args);
+
   template <class Base,
             int (StreamBase::*Method)(
       const v8::FunctionCallbackInfo<v8::Value>& args)>
@@ -277,6 +282,9 @@ class StreamBase : public StreamResource {
  private:
   Environment* env_;
   bool consumed_;
+  // Bytes of string data copied into write requests, as opposed to written
+  // straight from Buffers and external strings.
+  uint64_t bytes_copied_;
 };
 
 }  // namespace node
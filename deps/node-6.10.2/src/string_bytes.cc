@@ -3,6 +3,7 @@
 #include "base64.h"
 #include "node.h"
 #include "node_buffer.h"
+#include "string_bytes_simd.h"
 #include "v8.h"
 
 #include <limits.h>
@@ -88,6 +89,23 @@ class ExternString: public ResourceType {
     return scope.Escape(str.ToLocalChecked());
   }
 
+  // Makes |str| external in place, backed by |data|, a copy of its contents
+  // that is free'd on gc. Takes ownership of |data| even on failure.
+  static bool MakeExternal(Isolate* isolate,
+                           Local<String> str,
+                           const TypeName* data,
+                           size_t length) {
+    ExternString* h_str = new ExternString<ResourceType, TypeName>(isolate,
+                                                                   data,
+                                                                   length);
+    isolate->AdjustAmountOfExternalAllocatedMemory(h_str->byte_length());
+    if (!str->MakeExternal(h_str)) {
+      delete h_str;
+      return false;
+    }
+    return true;
+  }
+
   inline Isolate* isolate() const { return isolate_; }
 
  private:
@@ -166,13 +184,32 @@ static const int8_t unhex_table[256] =
   static_cast<unsigned>(unhex_table[static_cast<uint8_t>(x)])
 
 
+// Decodes the bulk of one-byte input with vector instructions.
+static size_t hex_decode_blocks(char* buf,
+                                size_t len,
+                                const char* src,
+                                const size_t srcLen) {
+  return simd::HexDecode(buf, len, src, srcLen);
+}
+
+template <typename TypeName>
+static size_t hex_decode_blocks(char* buf,
+                                size_t len,
+                                const TypeName* src,
+                                const size_t srcLen) {
+  return 0;
+}
+
+
 template <typename TypeName>
 size_t hex_decode(char* buf,
                   size_t len,
                   const TypeName* src,
                   const size_t srcLen) {
   size_t i;
-  for (i = 0; i < len && i * 2 + 1 < srcLen; ++i) {
+  for (i = hex_decode_blocks(buf, len, src, srcLen);
+       i < len && i * 2 + 1 < srcLen;
+       ++i) {
     unsigned a = unhex(src[i * 2 + 0]);
     unsigned b = unhex(src[i * 2 + 1]);
     if (!~a || !~b)
@@ -218,6 +255,24 @@ bool StringBytes::GetExternalParts(Isolate* isolate,
 }
 
 
+bool StringBytes::Externalize(Isolate* isolate, Local<String> str) {
+  if (!str->IsOneByte() || str->IsExternalOneByte() || !str->CanMakeExternal())
+    return false;
+
+  const size_t length = str->Length();
+  if (length == 0)
+    return false;
+  char* data = static_cast<char*>(node::Malloc(length));
+  if (data == nullptr)
+    return false;
+  str->WriteOneByte(reinterpret_cast<uint8_t*>(data),
+                    0,
+                    length,
+                    String::NO_NULL_TERMINATION);
+  return ExternOneByteString::MakeExternal(isolate, str, data, length);
+}
+
+
 size_t StringBytes::WriteUCS2(char* buf,
                               size_t buflen,
                               size_t nbytes,
@@ -353,6 +408,18 @@ size_t StringBytes::Write(Isolate* isolate,
 }
 
 
+size_t StringBytes::Utf8Length(Local<String> str) {
+  // Every byte of a Latin-1 string above 0x7f takes two bytes in UTF-8.  Only
+  // external strings expose their characters without a copy.
+  if (str->IsExternalOneByte()) {
+    const String::ExternalOneByteStringResource* ext =
+        str->GetExternalOneByteStringResource();
+    return ext->length() + simd::CountNonAscii(ext->data(), ext->length());
+  }
+  return str->Utf8Length();
+}
+
+
 bool StringBytes::IsValidString(Isolate* isolate,
                                 Local<String> string,
                                 enum encoding enc) {
@@ -439,7 +506,7 @@ size_t StringBytes::Size(Isolate* isolate,
 
     case BUFFER:
     case UTF8:
-      data_size = str->Utf8Length();
+      data_size = Utf8Length(str);
       break;
 
     case UCS2:
@@ -467,116 +534,14 @@ size_t StringBytes::Size(Isolate* isolate,
 
 
 
-static bool contains_non_ascii_slow(const char* buf, size_t len) {
-  for (size_t i = 0; i < len; ++i) {
-    if (buf[i] & 0x80)
-      return true;
-  }
-  return false;
-}
-
-
-static bool contains_non_ascii(const char* src, size_t len) {
-  if (len < 16) {
-    return contains_non_ascii_slow(src, len);
-  }
-
-  const unsigned bytes_per_word = sizeof(uintptr_t);
-  const unsigned align_mask = bytes_per_word - 1;
-  const unsigned unaligned = reinterpret_cast<uintptr_t>(src) & align_mask;
-
-  if (unaligned > 0) {
-    const unsigned n = bytes_per_word - unaligned;
-    if (contains_non_ascii_slow(src, n))
-      return true;
-    src += n;
-    len -= n;
-  }
-
-
-#if defined(_WIN64) || defined(_LP64)
-  const uintptr_t mask = 0x8080808080808080ll;
-#else
-  const uintptr_t mask = 0x80808080l;
-#endif
-
-  const uintptr_t* srcw = reinterpret_cast<const uintptr_t*>(src);
-
-  for (size_t i = 0, n = len / bytes_per_word; i < n; ++i) {
-    if (srcw[i] & mask)
-      return true;
-  }
-
-  const unsigned remainder = len & align_mask;
-  if (remainder > 0) {
-    const size_t offset = len - remainder;
-    if (contains_non_ascii_slow(src + offset, remainder))
-      return true;
-  }
-
-  return false;
-}
-
-
-static void force_ascii_slow(const char* src, char* dst, size_t len) {
-  for (size_t i = 0; i < len; ++i) {
-    dst[i] = src[i] & 0x7f;
-  }
-}
-
-
-static void force_ascii(const char* src, char* dst, size_t len) {
-  if (len < 16) {
-    force_ascii_slow(src, dst, len);
-    return;
-  }
-
-  const unsigned bytes_per_word = sizeof(uintptr_t);
-  const unsigned align_mask = bytes_per_word - 1;
-  const unsigned src_unalign = reinterpret_cast<uintptr_t>(src) & align_mask;
-  const unsigned dst_unalign = reinterpret_cast<uintptr_t>(dst) & align_mask;
-
-  if (src_unalign > 0) {
-    if (src_unalign == dst_unalign) {
-      const unsigned unalign = bytes_per_word - src_unalign;
-      force_ascii_slow(src, dst, unalign);
-      src += unalign;
-      dst += unalign;
-      len -= src_unalign;
-    } else {
-      force_ascii_slow(src, dst, len);
-      return;
-    }
-  }
-
-#if defined(_WIN64) || defined(_LP64)
-  const uintptr_t mask = ~0x8080808080808080ll;
-#else
-  const uintptr_t mask = ~0x80808080l;
-#endif
-
-  const uintptr_t* srcw = reinterpret_cast<const uintptr_t*>(src);
-  uintptr_t* dstw = reinterpret_cast<uintptr_t*>(dst);
-
-  for (size_t i = 0, n = len / bytes_per_word; i < n; ++i) {
-    dstw[i] = srcw[i] & mask;
-  }
-
-  const unsigned remainder = len & align_mask;
-  if (remainder > 0) {
-    const size_t offset = len - remainder;
-    force_ascii_slow(src + offset, dst + offset, remainder);
-  }
-}
-
-
 static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
   // We know how much we'll write, just make sure that there's space.
   CHECK(dlen >= slen * 2 &&
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  uint32_t i = simd::HexEncode(src, slen, dst);
+  for (uint32_t k = i * 2; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -609,12 +574,12 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       }
 
     case ASCII:
-      if (contains_non_ascii(buf, buflen)) {
+      if (!simd::IsAscii(buf, buflen)) {
         char* out = static_cast<char*>(node::Malloc(buflen));
         if (out == nullptr) {
           return Local<String>();
         }
-        force_ascii(buf, out, buflen);
+        simd::ForceAscii(buf, out, buflen);
         if (buflen < EXTERN_APEX) {
           val = OneByteString(isolate, out, buflen);
           free(out);
@@ -630,6 +595,14 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       break;
 
     case UTF8:
+      // ASCII is valid UTF-8 that decodes to itself, skip the decoder.
+      if (simd::IsAscii(buf, buflen)) {
+        if (buflen < EXTERN_APEX)
+          val = OneByteString(isolate, buf, buflen);
+        else
+          val = ExternOneByteString::NewFromCopy(isolate, buf, buflen);
+        break;
+      }
       val = String::NewFromUtf8(isolate,
                                 buf,
                                 String::kNormalString,
@@ -64,6 +64,10 @@ class StringBytes {
                      v8::Local<v8::Value> val,
                      enum encoding enc);
 
+  // String::Utf8Length(), faster for external one-byte strings such as large
+  // ASCII payloads and mapped module sources.
+  static size_t Utf8Length(v8::Local<v8::String> str);
+
   // If the string is external then assign external properties to data and len,
   // then return true. If not return false.
   static bool GetExternalParts(v8::Isolate* isolate,
@@ -71,6 +75,12 @@ class StringBytes {
                                const char** data,
                                size_t* len);
 
+  // Moves the contents of the one-byte string |str| out of the V8 heap and
+  // into an external resource, so that they no longer move with the GC and
+  // GetExternalParts() works on it. Costs one copy. Returns false if |str|
+  // is two-byte, already external or can't be externalized.
+  static bool Externalize(v8::Isolate* isolate, v8::Local<v8::String> str);
+
   // Write the bytes from the string or buffer into the char*
   // returns the number of bytes written, which will always be
   // <= buflen.  Use StorageSize/Size first to know how much
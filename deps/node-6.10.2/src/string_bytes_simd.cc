@@ -0,0 +1,539 @@
+#include "string_bytes_simd.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+# include <tmmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define NODE_SIMD_NEON 1
+#endif
+
+namespace node {
+namespace simd {
+
+#if defined(NODE_SIMD_NEON)
+// Whether any byte of |v| has the high bit set.
+static inline bool AnyHighBit(uint8x16_t v) {
+  uint64x2_t words = vreinterpretq_u64_u8(v);
+  return ((vgetq_lane_u64(words, 0) | vgetq_lane_u64(words, 1)) &
+          0x8080808080808080ULL) != 0;
+}
+
+// Whether all bytes of the comparison result |mask| are set.
+static inline bool AllSet(uint8x16_t mask) {
+  uint64x2_t words = vreinterpretq_u64_u8(mask);
+  return (vgetq_lane_u64(words, 0) & vgetq_lane_u64(words, 1)) == ~0ULL;
+}
+#endif
+
+
+bool IsAscii(const char* src, size_t len) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 64 <= len; i += 64) {
+    const __m128i* p = reinterpret_cast<const __m128i*>(src + i);
+    __m128i bits = _mm_or_si128(
+        _mm_or_si128(_mm_loadu_si128(p + 0), _mm_loadu_si128(p + 1)),
+        _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+    if (_mm_movemask_epi8(bits) != 0)
+      return false;
+  }
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (_mm_movemask_epi8(v) != 0)
+      return false;
+  }
+#elif defined(NODE_SIMD_NEON)
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(src);
+  for (; i + 64 <= len; i += 64) {
+    uint8x16_t bits = vorrq_u8(
+        vorrq_u8(vld1q_u8(p + i), vld1q_u8(p + i + 16)),
+        vorrq_u8(vld1q_u8(p + i + 32), vld1q_u8(p + i + 48)));
+    if (AnyHighBit(bits))
+      return false;
+  }
+  for (; i + 16 <= len; i += 16) {
+    if (AnyHighBit(vld1q_u8(p + i)))
+      return false;
+  }
+#else
+  const size_t bytes_per_word = sizeof(uintptr_t);
+#if defined(_WIN64) || defined(_LP64)
+  const uintptr_t mask = 0x8080808080808080ll;
+#else
+  const uintptr_t mask = 0x80808080l;
+#endif
+  for (; i + bytes_per_word <= len; i += bytes_per_word) {
+    uintptr_t word;
+    memcpy(&word, src + i, sizeof(word));
+    if (word & mask)
+      return false;
+  }
+#endif
+  for (; i < len; ++i) {
+    if (src[i] & 0x80)
+      return false;
+  }
+  return true;
+}
+
+
+void ForceAscii(const char* src, char* dst, size_t len) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i mask = _mm_set1_epi8(0x7f);
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_and_si128(v, mask));
+  }
+#elif defined(NODE_SIMD_NEON)
+  const uint8x16_t mask = vdupq_n_u8(0x7f);
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), vandq_u8(v, mask));
+  }
+#else
+  const size_t bytes_per_word = sizeof(uintptr_t);
+#if defined(_WIN64) || defined(_LP64)
+  const uintptr_t mask = ~0x8080808080808080ll;
+#else
+  const uintptr_t mask = ~0x80808080l;
+#endif
+  for (; i + bytes_per_word <= len; i += bytes_per_word) {
+    uintptr_t word;
+    memcpy(&word, src + i, sizeof(word));
+    word &= mask;
+    memcpy(dst + i, &word, sizeof(word));
+  }
+#endif
+  for (; i < len; ++i)
+    dst[i] = src[i] & 0x7f;
+}
+
+
+size_t CountNonAscii(const char* src, size_t len) {
+  size_t count = 0;
+  size_t i = 0;
+#if defined(__SSE2__)
+  // Per-byte counters overflow after 255 blocks.
+  const __m128i zero = _mm_setzero_si128();
+  while (i + 16 <= len) {
+    size_t blocks = (len - i) / 16;
+    if (blocks > 255)
+      blocks = 255;
+    __m128i counters = zero;
+    for (size_t end = i + blocks * 16; i < end; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      counters = _mm_sub_epi8(counters, _mm_cmplt_epi8(v, zero));
+    }
+    __m128i sums = _mm_sad_epu8(counters, zero);
+    count += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+  }
+#elif defined(NODE_SIMD_NEON)
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(src);
+  while (i + 16 <= len) {
+    size_t blocks = (len - i) / 16;
+    if (blocks > 255)
+      blocks = 255;
+    uint8x16_t counters = vdupq_n_u8(0);
+    for (size_t end = i + blocks * 16; i < end; i += 16)
+      counters = vaddq_u8(counters, vshrq_n_u8(vld1q_u8(p + i), 7));
+    uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(counters)));
+    count += vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1);
+  }
+#endif
+  for (; i < len; ++i)
+    count += static_cast<uint8_t>(src[i]) >> 7;
+  return count;
+}
+
+
+size_t HexEncode(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i low_nibble = _mm_set1_epi8(0x0f);
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+  for (; i + 16 <= slen; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble);
+    __m128i lo = _mm_and_si128(v, low_nibble);
+    hi = _mm_add_epi8(_mm_add_epi8(hi, zero),
+                      _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, zero),
+                      _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter));
+    __m128i* out = reinterpret_cast<__m128i*>(dst + i * 2);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(hi, lo));
+  }
+#elif defined(NODE_SIMD_NEON)
+  const uint8x16_t low_nibble = vdupq_n_u8(0x0f);
+  const uint8x16_t nine = vdupq_n_u8(9);
+  const uint8x16_t zero = vdupq_n_u8('0');
+  const uint8x16_t letter = vdupq_n_u8('a' - '0' - 10);
+  for (; i + 16 <= slen; i += 16) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    uint8x16_t hi = vshrq_n_u8(v, 4);
+    uint8x16_t lo = vandq_u8(v, low_nibble);
+    uint8x16x2_t out;
+    out.val[0] = vaddq_u8(vaddq_u8(hi, zero),
+                          vandq_u8(vcgtq_u8(hi, nine), letter));
+    out.val[1] = vaddq_u8(vaddq_u8(lo, zero),
+                          vandq_u8(vcgtq_u8(lo, nine), letter));
+    vst2q_u8(reinterpret_cast<uint8_t*>(dst + i * 2), out);
+  }
+#endif
+  return i;
+}
+
+
+#if defined(__SSE2__)
+// Value of each hex digit in |c|; clears the lanes of |*valid| that are not
+// hex digits.
+static inline __m128i UnhexBlock(__m128i c, __m128i* valid) {
+  const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+  const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                                      _mm_set1_epi8('a'));
+  const __m128i is_digit =
+      _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+  const __m128i is_letter =
+      _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+  *valid = _mm_and_si128(*valid, _mm_or_si128(is_digit, is_letter));
+  return _mm_or_si128(
+      _mm_and_si128(is_digit, digit),
+      _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+#elif defined(NODE_SIMD_NEON)
+static inline uint8x16_t UnhexBlock(uint8x16_t c, uint8x16_t* valid) {
+  const uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+  const uint8x16_t letter = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)),
+                                     vdupq_n_u8('a'));
+  const uint8x16_t is_digit = vcleq_u8(digit, vdupq_n_u8(9));
+  const uint8x16_t is_letter = vcleq_u8(letter, vdupq_n_u8(5));
+  *valid = vandq_u8(*valid, vorrq_u8(is_digit, is_letter));
+  return vorrq_u8(vandq_u8(is_digit, digit),
+                  vandq_u8(is_letter, vaddq_u8(letter, vdupq_n_u8(10))));
+}
+#endif
+
+
+size_t HexDecode(char* dst, size_t dstlen, const char* src, size_t srclen) {
+  size_t k = 0;
+#if defined(__SSE2__)
+  const __m128i low_byte = _mm_set1_epi16(0x00ff);
+  for (; k + 16 <= dstlen && k * 2 + 32 <= srclen; k += 16) {
+    const __m128i* in = reinterpret_cast<const __m128i*>(src + k * 2);
+    __m128i a = _mm_loadu_si128(in + 0);
+    __m128i b = _mm_loadu_si128(in + 1);
+    __m128i even = _mm_packus_epi16(_mm_and_si128(a, low_byte),
+                                    _mm_and_si128(b, low_byte));
+    __m128i odd = _mm_packus_epi16(_mm_srli_epi16(a, 8),
+                                   _mm_srli_epi16(b, 8));
+    __m128i valid = _mm_set1_epi8(-1);
+    __m128i hi = UnhexBlock(even, &valid);
+    __m128i lo = UnhexBlock(odd, &valid);
+    if (_mm_movemask_epi8(valid) != 0xffff)
+      break;
+    // |hi| is at most 15 per byte, so the 16-bit shift does not carry.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     _mm_or_si128(_mm_slli_epi16(hi, 4), lo));
+  }
+#elif defined(NODE_SIMD_NEON)
+  for (; k + 16 <= dstlen && k * 2 + 32 <= srclen; k += 16) {
+    uint8x16x2_t in = vld2q_u8(reinterpret_cast<const uint8_t*>(src + k * 2));
+    uint8x16_t valid = vdupq_n_u8(0xff);
+    uint8x16_t hi = UnhexBlock(in.val[0], &valid);
+    uint8x16_t lo = UnhexBlock(in.val[1], &valid);
+    if (!AllSet(valid))
+      break;
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + k),
+             vorrq_u8(vshlq_n_u8(hi, 4), lo));
+  }
+#endif
+  return k;
+}
+
+
+#if defined(NODE_SIMD_NEON)
+// Maps 6-bit values to the base64 alphabet.
+static inline uint8x16_t Base64Chars(uint8x16_t v) {
+  uint8x16_t shift = vdupq_n_u8('A');
+  shift = vbslq_u8(vcgeq_u8(v, vdupq_n_u8(26)),
+                   vdupq_n_u8('a' - 26), shift);
+  shift = vbslq_u8(vcgeq_u8(v, vdupq_n_u8(52)),
+                   vdupq_n_u8(static_cast<uint8_t>('0' - 52)), shift);
+  shift = vbslq_u8(vceqq_u8(v, vdupq_n_u8(62)),
+                   vdupq_n_u8(static_cast<uint8_t>('+' - 62)), shift);
+  shift = vbslq_u8(vceqq_u8(v, vdupq_n_u8(63)),
+                   vdupq_n_u8(static_cast<uint8_t>('/' - 63)), shift);
+  return vaddq_u8(v, shift);
+}
+
+// Maps base64 characters to their 6-bit values; clears the lanes of |*valid|
+// that are not in the standard alphabet.
+static inline uint8x16_t Base64Values(uint8x16_t c, uint8x16_t* valid) {
+  const uint8x16_t upper = vsubq_u8(c, vdupq_n_u8('A'));
+  const uint8x16_t lower = vsubq_u8(c, vdupq_n_u8('a'));
+  const uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+  const uint8x16_t is_upper = vcltq_u8(upper, vdupq_n_u8(26));
+  const uint8x16_t is_lower = vcltq_u8(lower, vdupq_n_u8(26));
+  const uint8x16_t is_digit = vcltq_u8(digit, vdupq_n_u8(10));
+  const uint8x16_t is_plus = vceqq_u8(c, vdupq_n_u8('+'));
+  const uint8x16_t is_slash = vceqq_u8(c, vdupq_n_u8('/'));
+  *valid = vandq_u8(*valid,
+                    vorrq_u8(vorrq_u8(is_upper, is_lower),
+                             vorrq_u8(is_digit, vorrq_u8(is_plus, is_slash))));
+  uint8x16_t v = vandq_u8(is_upper, upper);
+  v = vorrq_u8(v, vandq_u8(is_lower, vaddq_u8(lower, vdupq_n_u8(26))));
+  v = vorrq_u8(v, vandq_u8(is_digit, vaddq_u8(digit, vdupq_n_u8(52))));
+  v = vorrq_u8(v, vandq_u8(is_plus, vdupq_n_u8(62)));
+  v = vorrq_u8(v, vandq_u8(is_slash, vdupq_n_u8(63)));
+  return v;
+}
+#endif
+
+
+size_t Base64Encode(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+#if defined(__SSSE3__)
+  // Spreads 12 bytes over 16 lanes of 6 bits each (W. Mula and D. Lemire,
+  // "Faster Base64 Encoding and Decoding Using AVX2 Instructions", 2018).
+  // Reads 16 bytes per block of 12.
+  const __m128i spread =
+      _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  const __m128i shift_lut = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  for (size_t k = 0; i + 16 <= slen; i += 12, k += 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    in = _mm_shuffle_epi8(in, spread);
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i values = _mm_or_si128(t1, t3);
+
+    __m128i index = _mm_subs_epu8(values, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+    index = _mm_or_si128(index, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const __m128i chars =
+        _mm_add_epi8(_mm_shuffle_epi8(shift_lut, index), values);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), chars);
+  }
+#elif defined(NODE_SIMD_NEON)
+  const uint8x16_t mask2 = vdupq_n_u8(0x03);
+  const uint8x16_t mask4 = vdupq_n_u8(0x0f);
+  const uint8x16_t mask6 = vdupq_n_u8(0x3f);
+  for (size_t k = 0; i + 48 <= slen; i += 48, k += 64) {
+    uint8x16x3_t in = vld3q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    uint8x16x4_t out;
+    out.val[0] = vshrq_n_u8(in.val[0], 2);
+    out.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[0], mask2), 4),
+                          vshrq_n_u8(in.val[1], 4));
+    out.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[1], mask4), 2),
+                          vshrq_n_u8(in.val[2], 6));
+    out.val[3] = vandq_u8(in.val[2], mask6);
+    out.val[0] = Base64Chars(out.val[0]);
+    out.val[1] = Base64Chars(out.val[1]);
+    out.val[2] = Base64Chars(out.val[2]);
+    out.val[3] = Base64Chars(out.val[3]);
+    vst4q_u8(reinterpret_cast<uint8_t*>(dst + k), out);
+  }
+#endif
+  return i;
+}
+
+
+size_t Base64Decode(char* dst, size_t dstlen,
+                    const char* src, size_t srclen,
+                    size_t* consumed) {
+  size_t i = 0;
+  size_t k = 0;
+#if defined(__SSSE3__)
+  // Validation and translation through nibble lookups, same source as above.
+  const __m128i lut_lo = _mm_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi = _mm_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll = _mm_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i gather = _mm_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m128i low_nibble = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= srclen && k + 12 <= dstlen; i += 16, k += 12) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi_nibbles =
+        _mm_and_si128(_mm_srli_epi32(in, 4), low_nibble);
+    const __m128i lo_nibbles = _mm_and_si128(in, low_nibble);
+    const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                         _mm_setzero_si128())) != 0)
+      break;
+
+    const __m128i is_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+    const __m128i roll =
+        _mm_shuffle_epi8(lut_roll, _mm_add_epi8(is_slash, hi_nibbles));
+    const __m128i values = _mm_add_epi8(in, roll);
+
+    const __m128i pairs =
+        _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i out = _mm_shuffle_epi8(words, gather);
+    // Stores exactly 12 bytes, |dst| may be part of a larger buffer.
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k), out);
+    const int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+    memcpy(dst + k + 8, &tail, sizeof(tail));
+  }
+#elif defined(NODE_SIMD_NEON)
+  for (; i + 64 <= srclen && k + 48 <= dstlen; i += 64, k += 48) {
+    uint8x16x4_t in = vld4q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    uint8x16_t valid = vdupq_n_u8(0xff);
+    const uint8x16_t a = Base64Values(in.val[0], &valid);
+    const uint8x16_t b = Base64Values(in.val[1], &valid);
+    const uint8x16_t c = Base64Values(in.val[2], &valid);
+    const uint8x16_t d = Base64Values(in.val[3], &valid);
+    if (!AllSet(valid))
+      break;
+    uint8x16x3_t out;
+    out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+    out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+    vst3q_u8(reinterpret_cast<uint8_t*>(dst + k), out);
+  }
+#endif
+  *consumed = i;
+  return k;
+}
+
+
+#if defined(__SSE2__) || defined(NODE_SIMD_NEON)
+// Candidate filter for substring search: compares 16 haystack positions at
+// once against the first and the last byte of the needle, so that only the
+// positions matching both are compared in full. The resulting mask has
+// kMaskBits bits per position.
+#if defined(__SSE2__)
+typedef __m128i Block;
+static const int kMaskBits = 1;
+
+static inline Block Splat(char c) {
+  return _mm_set1_epi8(c);
+}
+
+static inline uint64_t Candidates(const char* p, size_t last_offset,
+                                  Block first, Block last) {
+  const __m128i a = _mm_cmpeq_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), first);
+  const __m128i b = _mm_cmpeq_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + last_offset)),
+      last);
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(a, b)));
+}
+#else
+typedef uint8x16_t Block;
+static const int kMaskBits = 4;
+
+static inline Block Splat(char c) {
+  return vdupq_n_u8(static_cast<uint8_t>(c));
+}
+
+static inline uint64_t Candidates(const char* p, size_t last_offset,
+                                  Block first, Block last) {
+  const uint8_t* q = reinterpret_cast<const uint8_t*>(p);
+  const uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(q), first),
+                                 vceqq_u8(vld1q_u8(q + last_offset), last));
+  // NEON has no movemask; narrowing each 16-bit lane by 4 leaves one nibble
+  // per byte.
+  const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+}
+#endif
+
+static const uint64_t kPositionMask = (1ULL << kMaskBits) - 1;
+#endif
+
+
+static inline bool MatchesAt(const char* haystack, size_t pos,
+                             const char* needle, size_t nlen) {
+  return haystack[pos] == needle[0] &&
+         haystack[pos + nlen - 1] == needle[nlen - 1] &&
+         memcmp(haystack + pos + 1, needle + 1, nlen - 2) == 0;
+}
+
+
+size_t IndexOf(const char* haystack, size_t hlen,
+               const char* needle, size_t nlen,
+               size_t start) {
+  if (nlen < 2 || nlen > hlen || start > hlen - nlen)
+    return hlen;
+  const size_t last = hlen - nlen;
+  size_t i = start;
+#if defined(__SSE2__) || defined(NODE_SIMD_NEON)
+  const Block first_block = Splat(needle[0]);
+  const Block last_block = Splat(needle[nlen - 1]);
+  for (; i + 16 <= last + 1; i += 16) {
+    uint64_t mask = Candidates(haystack + i, nlen - 1, first_block, last_block);
+    while (mask != 0) {
+      const size_t offset = __builtin_ctzll(mask) / kMaskBits;
+      if (memcmp(haystack + i + offset + 1, needle + 1, nlen - 2) == 0)
+        return i + offset;
+      mask &= ~(kPositionMask << (offset * kMaskBits));
+    }
+  }
+#endif
+  while (i <= last) {
+    const void* p = memchr(haystack + i, needle[0], last - i + 1);
+    if (p == nullptr)
+      break;
+    i = static_cast<const char*>(p) - haystack;
+    if (MatchesAt(haystack, i, needle, nlen))
+      return i;
+    i++;
+  }
+  return hlen;
+}
+
+
+size_t LastIndexOf(const char* haystack, size_t hlen,
+                   const char* needle, size_t nlen,
+                   size_t start) {
+  if (nlen < 2 || nlen > hlen)
+    return hlen;
+  // One past the next position to look at.
+  size_t i = (start < hlen - nlen ? start : hlen - nlen) + 1;
+#if defined(__SSE2__) || defined(NODE_SIMD_NEON)
+  const Block first_block = Splat(needle[0]);
+  const Block last_block = Splat(needle[nlen - 1]);
+  for (; i >= 16; i -= 16) {
+    const size_t base = i - 16;
+    uint64_t mask =
+        Candidates(haystack + base, nlen - 1, first_block, last_block);
+    while (mask != 0) {
+      const size_t offset = (63 - __builtin_clzll(mask)) / kMaskBits;
+      if (memcmp(haystack + base + offset + 1, needle + 1, nlen - 2) == 0)
+        return base + offset;
+      mask &= ~(kPositionMask << (offset * kMaskBits));
+    }
+  }
+#endif
+  while (i > 0) {
+    i--;
+    if (MatchesAt(haystack, i, needle, nlen))
+      return i;
+  }
+  return hlen;
+}
+
+}  // namespace simd
+}  // namespace node
@@ -0,0 +1,76 @@
+#ifndef SRC_STRING_BYTES_SIMD_H_
+#define SRC_STRING_BYTES_SIMD_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "node.h"
+
+#include <stddef.h>
+
+namespace node {
+namespace simd {
+
+// Vectorized kernels behind StringBytes and base64.h, for one-byte data.
+//
+// They use SSE2 and SSSE3 on x86 and NEON on ARM, as enabled by the compiler
+// for the target: the Android ABIs guarantee SSSE3 on x86 and x86_64 and NEON
+// on arm64, and armeabi-v7a gets NEON when built with it. Every other target
+// uses scalar code. The codecs only handle whole blocks from the start of the
+// input and return how much of it they consumed, leaving the rest (padding,
+// whitespace, invalid input, short tails) to the scalar code of the caller.
+
+// Whether all |len| bytes at |src| are 7-bit ASCII. Exported for the native
+// code of embedders and addons.
+NODE_EXTERN bool IsAscii(const char* src, size_t len);
+
+// Copies |len| bytes from |src| to |dst| with the high bit cleared.
+void ForceAscii(const char* src, char* dst, size_t len);
+
+// Number of bytes at |src| with the high bit set. The UTF-8 length of a
+// Latin-1 string is its length plus this.
+size_t CountNonAscii(const char* src, size_t len);
+
+// Writes two lowercase hex digits per byte of |src| to |dst|. Returns the
+// number of bytes encoded.
+size_t HexEncode(const char* src, size_t slen, char* dst);
+
+// Decodes pairs of hex digits from |src| into at most |dstlen| bytes,
+// stopping before the first block with an invalid digit in it. Returns the
+// number of bytes written.
+size_t HexDecode(char* dst, size_t dstlen, const char* src, size_t srclen);
+
+// Encodes |src| as base64 into |dst|, four characters per three bytes.
+// Returns the number of bytes encoded, a multiple of 3.
+size_t Base64Encode(const char* src, size_t slen, char* dst);
+
+// Decodes base64 from |src| into at most |dstlen| bytes, stopping before the
+// first block with anything but the 64 standard characters in it. Returns
+// the number of bytes written and stores the number of characters consumed,
+// a multiple of 4, in |*consumed|.
+size_t Base64Decode(char* dst, size_t dstlen,
+                    const char* src, size_t srclen,
+                    size_t* consumed);
+
+// Substring search for needles of at least 2 bytes, filtering candidate
+// positions on the first and last byte of the needle 16 at a time before
+// comparing the rest. Meant for short needles, where Boyer-Moore-Horspool
+// cannot skip far enough to pay for its tables.
+
+// Returns the first position at or after |start| where |needle| occurs in
+// |haystack|, or |hlen| if there is none.
+size_t IndexOf(const char* haystack, size_t hlen,
+               const char* needle, size_t nlen,
+               size_t start);
+
+// Returns the last position at or before |start| where |needle| occurs in
+// |haystack|, or |hlen| if there is none.
+size_t LastIndexOf(const char* haystack, size_t hlen,
+                   const char* needle, size_t nlen,
+                   size_t start);
+
+}  // namespace simd
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_STRING_BYTES_SIMD_H_
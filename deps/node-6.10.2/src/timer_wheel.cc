@@ -0,0 +1,438 @@
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "handle_wrap.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+namespace {
+
+const uint32_t kOnTimeout = 0;
+
+// Hierarchical timing wheel with a resolution of one millisecond.
+//
+// Level n has kSlots slots that each cover kSlots^n milliseconds, so four
+// levels span 2^32 ms, enough for any delay up to TIMEOUT_MAX.  An entry is
+// linked into the lowest level whose range holds its delay; when level 0
+// wraps around, the next slot of level 1 is cascaded down, and so on up the
+// levels.  Adding and removing an entry is O(1); expiring costs O(1) per
+// entry plus at most kLevels - 1 cascades over its lifetime.
+//
+// Entries live in a vector and are addressed by index.  Their ids are
+// recycled once they expire or are removed.
+class Wheel {
+ public:
+  static const uint32_t kNone = 0xffffffff;
+
+  explicit Wheel(uint64_t now) : current_(now), free_(kNone), size_(0),
+                                 refed_(0) {
+    for (size_t i = 0; i < arraysize(heads_); i++)
+      heads_[i] = tails_[i] = kNone;
+    memset(occupied_, 0, sizeof(occupied_));
+  }
+
+  // Schedules an entry to expire at |expiry| and returns its id.  |now| is
+  // the current loop time.
+  uint32_t Add(uint64_t now, uint64_t expiry, bool refed) {
+    // Nothing is scheduled, so nothing needs cascading: catch up directly.
+    if (size_ == 0 && now > current_)
+      current_ = now;
+
+    uint32_t id;
+    if (free_ != kNone) {
+      id = free_;
+      free_ = entries_[id].next;
+    } else {
+      id = static_cast<uint32_t>(entries_.size());
+      entries_.push_back(Entry());
+    }
+
+    Entry& entry = entries_[id];
+    entry.expiry = expiry < current_ ? current_ : expiry;
+    entry.refed = refed;
+    Link(id);
+
+    size_++;
+    if (refed)
+      refed_++;
+    return id;
+  }
+
+  void Remove(uint32_t id) {
+    CHECK_LT(id, entries_.size());
+    CHECK_NE(entries_[id].bucket, kNone);
+    Unlink(id);
+    Release(id);
+  }
+
+  uint64_t expiry(uint32_t id) const { return entries_[id].expiry; }
+  size_t size() const { return size_; }
+  size_t refed() const { return refed_; }
+
+  // Expires every entry that is due at or before |now| and appends their
+  // ids to |expired|, earliest first.
+  void Advance(uint64_t now, std::vector<uint32_t>* expired) {
+    while (current_ <= now) {
+      if (size_ == 0) {
+        current_ = now + 1;
+        break;
+      }
+
+      const uint32_t index = current_ & kMask;
+      const int slot = FindSlot(0, index);
+      if (slot >= 0 && current_ - index + slot <= now) {
+        current_ = current_ - index + slot;
+        Expire(slot, expired);
+        current_ += 1;
+      } else {
+        // Nothing due in this turn of level 0: skip straight to the next
+        // slot or cascade that holds anything, but no further than |now|.
+        uint64_t next = now + 1;
+        if (slot < 0) {
+          CHECK(NextEvent(&next));
+          if (next > now)
+            next = now + 1;
+        }
+        current_ = next;
+      }
+
+      if ((current_ & kMask) == 0)
+        Cascade();
+    }
+  }
+
+  // Returns the time by which Advance() must be called next: the earliest
+  // expiry in level 0, or the earliest cascade of a higher level, which
+  // may turn out to have nothing due yet.  False when the wheel is empty.
+  bool NextEvent(uint64_t* when) const {
+    if (size_ == 0)
+      return false;
+
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < kLevels; level++) {
+      const int shift = kBits * level;
+      const uint64_t turn = static_cast<uint64_t>(1) << (shift + kBits);
+      const uint64_t base = current_ & ~(turn - 1);
+      const uint32_t index = (current_ >> shift) & kMask;
+
+      // Slots past the current one come up in this turn of the level, the
+      // others in the next one.  Level 0 has not processed its current slot
+      // yet; higher levels cascaded theirs when they reached it.
+      const uint32_t first = level == 0 ? index : index + 1;
+      int slot = first < kSlots ? FindSlot(level, first) : -1;
+      uint64_t time;
+      if (slot >= 0) {
+        time = base + (static_cast<uint64_t>(slot) << shift);
+      } else {
+        slot = FindSlot(level, 0);
+        if (slot < 0)
+          continue;
+        time = base + turn + (static_cast<uint64_t>(slot) << shift);
+      }
+
+      if (time < next)
+        next = time;
+      // Everything in higher levels is due after this.
+      if (level == 0 && time < base + turn)
+        break;
+    }
+
+    *when = next;
+    return true;
+  }
+
+ private:
+  static const int kBits = 8;
+  static const int kLevels = 4;
+  static const uint32_t kSlots = 1 << kBits;
+  static const uint32_t kMask = kSlots - 1;
+  static const uint64_t kMaxDelay =
+      (static_cast<uint64_t>(1) << (kBits * kLevels)) - 1;
+
+  struct Entry {
+    uint64_t expiry;
+    uint32_t prev;
+    uint32_t next;  // Also links the free list.
+    uint32_t bucket;
+    bool refed;
+  };
+
+  void Link(uint32_t id) {
+    Entry& entry = entries_[id];
+    // Clamp delays the wheel cannot represent.  Such an entry expires early
+    // and lib/timers.js schedules it again for the remainder.
+    if (entry.expiry - current_ > kMaxDelay)
+      entry.expiry = current_ + kMaxDelay;
+
+    const uint64_t delay = entry.expiry - current_;
+    int level = 0;
+    while (level < kLevels - 1 &&
+           delay >= static_cast<uint64_t>(1) << (kBits * (level + 1))) {
+      level++;
+    }
+    const uint32_t slot = (entry.expiry >> (kBits * level)) & kMask;
+    const uint32_t bucket = level * kSlots + slot;
+
+    entry.bucket = bucket;
+    entry.next = kNone;
+    entry.prev = tails_[bucket];
+    if (tails_[bucket] != kNone)
+      entries_[tails_[bucket]].next = id;
+    else
+      heads_[bucket] = id;
+    tails_[bucket] = id;
+    occupied_[bucket / 64] |= static_cast<uint64_t>(1) << (bucket % 64);
+  }
+
+  void Unlink(uint32_t id) {
+    Entry& entry = entries_[id];
+    const uint32_t bucket = entry.bucket;
+    if (entry.prev != kNone)
+      entries_[entry.prev].next = entry.next;
+    else
+      heads_[bucket] = entry.next;
+    if (entry.next != kNone)
+      entries_[entry.next].prev = entry.prev;
+    else
+      tails_[bucket] = entry.prev;
+    if (heads_[bucket] == kNone)
+      occupied_[bucket / 64] &= ~(static_cast<uint64_t>(1) << (bucket % 64));
+    entry.bucket = kNone;
+  }
+
+  void Release(uint32_t id) {
+    Entry& entry = entries_[id];
+    if (entry.refed)
+      refed_--;
+    size_--;
+    entry.next = free_;
+    free_ = id;
+  }
+
+  // Detaches the list in |bucket| and returns its head.
+  uint32_t Take(uint32_t bucket) {
+    const uint32_t head = heads_[bucket];
+    heads_[bucket] = tails_[bucket] = kNone;
+    occupied_[bucket / 64] &= ~(static_cast<uint64_t>(1) << (bucket % 64));
+    return head;
+  }
+
+  void Expire(uint32_t slot, std::vector<uint32_t>* expired) {
+    for (uint32_t id = Take(slot); id != kNone;) {
+      const uint32_t next = entries_[id].next;
+      entries_[id].bucket = kNone;
+      Release(id);
+      expired->push_back(id);
+      id = next;
+    }
+  }
+
+  // Called when level 0 wraps around: moves the slot that has come up in
+  // level 1 into level 0, and likewise up the levels that wrapped as well.
+  void Cascade() {
+    for (int level = 1; level < kLevels; level++) {
+      const uint32_t index = (current_ >> (kBits * level)) & kMask;
+      for (uint32_t id = Take(level * kSlots + index); id != kNone;) {
+        const uint32_t next = entries_[id].next;
+        Link(id);
+        id = next;
+      }
+      if (index != 0)
+        break;
+    }
+  }
+
+  // Returns the first occupied slot of |level| at or after |first|, or -1.
+  int FindSlot(int level, uint32_t first) const {
+    const uint32_t begin = level * kSlots + first;
+    const uint32_t end = (level + 1) * kSlots;
+    uint32_t word = begin / 64;
+    uint64_t bits =
+        occupied_[word] & (~static_cast<uint64_t>(0) << (begin % 64));
+    for (;;) {
+      if (bits != 0) {
+        const uint32_t bucket = word * 64 + __builtin_ctzll(bits);
+        return bucket < end ? static_cast<int>(bucket - level * kSlots) : -1;
+      }
+      if (++word * 64 >= end)
+        return -1;
+      bits = occupied_[word];
+    }
+  }
+
+  // The next millisecond to process; everything before it has expired.
+  uint64_t current_;
+  std::vector<Entry> entries_;
+  uint32_t free_;
+  size_t size_;
+  size_t refed_;
+  uint32_t heads_[kLevels * kSlots];
+  uint32_t tails_[kLevels * kSlots];
+  uint64_t occupied_[kLevels * kSlots / 64];
+};
+
+}  // anonymous namespace
+
+
+// Drives every timer in a Wheel with a single uv timer and reports the
+// entries that expire on a tick to JS in one callback.  The handle is only
+// referenced while it holds entries that were added as referenced.
+class TimerWheel : public HandleWrap {
+ public:
+  static void Initialize(Local<Object> target,
+                         Local<Value> unused,
+                         Local<Context> context) {
+    Environment* env = Environment::GetCurrent(context);
+    Local<FunctionTemplate> constructor = env->NewFunctionTemplate(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"));
+    constructor->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnTimeout"),
+                     Integer::New(env->isolate(), kOnTimeout));
+
+    env->SetProtoMethod(constructor, "close", HandleWrap::Close);
+
+    env->SetProtoMethod(constructor, "add", Add);
+    env->SetProtoMethod(constructor, "remove", Remove);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"),
+                constructor->GetFunction());
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    // This constructor should not be exposed to public javascript.
+    // Therefore we assert that we are not trying to call this as a
+    // normal function.
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+    new TimerWheel(env, args.This());
+  }
+
+  TimerWheel(Environment* env, Local<Object> object)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&handle_),
+                   AsyncWrap::PROVIDER_TIMERWRAP),
+        wheel_(uv_now(env->event_loop())),
+        armed_(false),
+        armed_at_(0) {
+    int r = uv_timer_init(env->event_loop(), &handle_);
+    CHECK_EQ(r, 0);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&handle_));
+  }
+
+  // add(msecs, refed) schedules an entry and returns its id.
+  static void Add(const FunctionCallbackInfo<Value>& args) {
+    TimerWheel* wrap = Unwrap<TimerWheel>(args.Holder());
+
+    CHECK(HandleWrap::IsAlive(wrap));
+
+    int64_t timeout = args[0]->IntegerValue();
+    if (timeout < 0)
+      timeout = 0;
+    const uint64_t now = uv_now(wrap->env()->event_loop());
+    const uint32_t id = wrap->wheel_.Add(now, now + timeout, args[1]->IsTrue());
+
+    // Only an earlier expiry moves the uv timer.  Removals leave it alone;
+    // firing with nothing due is cheaper than rearming on every removal.
+    const uint64_t expiry = wrap->wheel_.expiry(id);
+    if (!wrap->armed_ || expiry < wrap->armed_at_)
+      wrap->Arm(now, expiry);
+    wrap->UpdateRef();
+
+    args.GetReturnValue().Set(id);
+  }
+
+  // remove(id) cancels an entry that has not expired yet.
+  static void Remove(const FunctionCallbackInfo<Value>& args) {
+    TimerWheel* wrap = Unwrap<TimerWheel>(args.Holder());
+
+    CHECK(HandleWrap::IsAlive(wrap));
+
+    wrap->wheel_.Remove(args[0]->Uint32Value());
+    if (wrap->wheel_.size() == 0) {
+      uv_timer_stop(&wrap->handle_);
+      wrap->armed_ = false;
+    }
+    wrap->UpdateRef();
+  }
+
+  static void OnTimeout(uv_timer_t* handle) {
+    TimerWheel* wrap = static_cast<TimerWheel*>(handle->data);
+    Environment* env = wrap->env();
+    wrap->armed_ = false;
+
+    std::vector<uint32_t> expired;
+    wrap->wheel_.Advance(uv_now(env->event_loop()), &expired);
+
+    if (!expired.empty()) {
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      Local<Array> ids = Array::New(env->isolate(), expired.size());
+      for (size_t i = 0; i < expired.size(); i++)
+        ids->Set(i, Integer::NewFromUnsigned(env->isolate(), expired[i]));
+      Local<Value> argv[] = { ids };
+      wrap->MakeCallback(kOnTimeout, arraysize(argv), argv);
+      if (!HandleWrap::IsAlive(wrap))
+        return;
+    }
+
+    // The callback may have added entries and armed the timer already.
+    uint64_t when;
+    if (wrap->wheel_.NextEvent(&when)) {
+      if (!wrap->armed_ || when < wrap->armed_at_)
+        wrap->Arm(uv_now(env->event_loop()), when);
+    } else if (wrap->armed_) {
+      uv_timer_stop(&wrap->handle_);
+      wrap->armed_ = false;
+    }
+    wrap->UpdateRef();
+  }
+
+  void Arm(uint64_t now, uint64_t when) {
+    int err = uv_timer_start(&handle_, OnTimeout, when > now ? when - now : 0,
+                             0);
+    CHECK_EQ(err, 0);
+    armed_ = true;
+    armed_at_ = when;
+  }
+
+  void UpdateRef() {
+    uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(&handle_);
+    if (wheel_.refed() > 0)
+      uv_ref(handle);
+    else
+      uv_unref(handle);
+  }
+
+  uv_timer_t handle_;
+  Wheel wheel_;
+  bool armed_;
+  uint64_t armed_at_;
+};
+
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(timer_wheel, node::TimerWheel::Initialize)
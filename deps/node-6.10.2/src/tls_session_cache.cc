@@ -0,0 +1,145 @@
+#include "tls_session_cache.h"
+#include "node_mutex.h"
+
+#include <openssl/sha.h>
+#include <time.h>
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+namespace crypto {
+
+namespace {
+
+struct Entry {
+  std::string digest;
+  std::vector<unsigned char> session;
+  time_t expires;
+};
+
+typedef std::list<Entry> EntryList;
+
+Mutex cache_mutex;
+// Most recently used first.
+EntryList entries;
+std::unordered_map<std::string, EntryList::iterator> index;
+
+size_t max_entries = 256;
+
+uint64_t hits;
+uint64_t misses;
+
+void Erase(EntryList::iterator it) {
+  index.erase(it->digest);
+  entries.erase(it);
+}
+
+void Trim() {
+  while (entries.size() > max_entries)
+    Erase(--entries.end());
+}
+
+}  // anonymous namespace
+
+
+std::string ClientSessionCache::Digest(const char* key, size_t length) {
+  unsigned char md[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const unsigned char*>(key), length, md);
+  return std::string(reinterpret_cast<char*>(md), sizeof(md));
+}
+
+
+SSL_SESSION* ClientSessionCache::Get(const std::string& digest) {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  auto found = index.find(digest);
+  if (found == index.end()) {
+    misses++;
+    return nullptr;
+  }
+
+  EntryList::iterator it = found->second;
+  if (it->expires <= time(nullptr)) {
+    Erase(it);
+    misses++;
+    return nullptr;
+  }
+
+  const unsigned char* p = it->session.data();
+  SSL_SESSION* session =
+      d2i_SSL_SESSION(nullptr, &p, static_cast<long>(it->session.size()));
+  if (session == nullptr) {
+    Erase(it);
+    misses++;
+    return nullptr;
+  }
+
+  entries.splice(entries.begin(), entries, it);
+  hits++;
+  return session;
+}
+
+
+void ClientSessionCache::Put(const std::string& digest, SSL_SESSION* session) {
+  int size = i2d_SSL_SESSION(session, nullptr);
+  if (size <= 0)
+    return;
+
+  std::vector<unsigned char> serialized(size);
+  unsigned char* p = serialized.data();
+  i2d_SSL_SESSION(session, &p);
+
+  const time_t expires =
+      SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session);
+
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  if (max_entries == 0)
+    return;
+
+  auto found = index.find(digest);
+  if (found != index.end())
+    Erase(found->second);
+
+  entries.push_front(Entry());
+  entries.front().digest = digest;
+  entries.front().session.swap(serialized);
+  entries.front().expires = expires;
+  index[digest] = entries.begin();
+  Trim();
+}
+
+
+void ClientSessionCache::Remove(const std::string& digest) {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  auto found = index.find(digest);
+  if (found != index.end())
+    Erase(found->second);
+}
+
+
+void ClientSessionCache::Configure(size_t max) {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  max_entries = max;
+  Trim();
+}
+
+
+void ClientSessionCache::Clear() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  entries.clear();
+  index.clear();
+}
+
+
+ClientSessionCache::Stats ClientSessionCache::GetStats() {
+  Mutex::ScopedLock scoped_lock(cache_mutex);
+  Stats stats;
+  stats.hits = hits;
+  stats.misses = misses;
+  stats.entries = entries.size();
+  return stats;
+}
+
+}  // namespace crypto
+}  // namespace node
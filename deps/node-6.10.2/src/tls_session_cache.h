@@ -0,0 +1,50 @@
+#ifndef SRC_TLS_SESSION_CACHE_H_
+#define SRC_TLS_SESSION_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <openssl/ssl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace node {
+namespace crypto {
+
+// Process-wide cache of client TLS sessions, shared by every Environment
+// (and so every thread running one) in the process and guarded by a mutex.
+// Sessions are stored serialized, so that any SSL_CTX can resume them, under
+// the SHA-256 of a key describing the peer and the context options, see
+// tls.connect(). They are dropped when they expire and least recently used
+// first once there are more than the configured maximum; a maximum of 0 turns
+// the cache off.
+class ClientSessionCache {
+ public:
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t entries;
+  };
+
+  static std::string Digest(const char* key, size_t length);
+
+  // Returns a new session for |digest| that the caller must free with
+  // SSL_SESSION_free(), or nullptr.
+  static SSL_SESSION* Get(const std::string& digest);
+
+  static void Put(const std::string& digest, SSL_SESSION* session);
+  static void Remove(const std::string& digest);
+
+  static void Configure(size_t max);
+  static void Clear();
+  static Stats GetStats();
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_TLS_SESSION_CACHE_H_
@@ -10,11 +10,13 @@
 #include "node_internals.h"
 #include "stream_base.h"
 #include "stream_base-inl.h"
+#include "tls_session_cache.h"
 #include "util.h"
 #include "util-inl.h"
 
 namespace node {
 
+using crypto::ClientSessionCache;
 using crypto::SecureContext;
 using crypto::SSLWrap;
 using v8::Context;
@@ -24,6 +26,7 @@ using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -800,6 +803,84 @@ void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// setSessionCacheKey(key) makes a client resume the session cached for |key|
+// if there is one, and cacheSession() stores the session of the connection
+// there once it is trusted. Returns whether a session was found.
+void TLSWrap::SetSessionCacheKey(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (args.Length() < 1 || !args[0]->IsString())
+    return env->ThrowTypeError("First argument should be a string");
+
+  if (wrap->started_)
+    return env->ThrowError("Already started.");
+
+  if (!wrap->is_client() || wrap->ssl_ == nullptr)
+    return args.GetReturnValue().Set(false);
+
+  node::Utf8Value key(env->isolate(), args[0]);
+  wrap->session_cache_key_ = ClientSessionCache::Digest(*key, key.length());
+
+  SSL_SESSION* session = ClientSessionCache::Get(wrap->session_cache_key_);
+  if (session == nullptr)
+    return args.GetReturnValue().Set(false);
+
+  int r = SSL_set_session(wrap->ssl_, session);
+  SSL_SESSION_free(session);
+  args.GetReturnValue().Set(r == 1);
+}
+
+
+void TLSWrap::CacheSession(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (wrap->session_cache_key_.empty() || wrap->ssl_ == nullptr)
+    return;
+
+  SSL_SESSION* session = SSL_get_session(wrap->ssl_);
+  if (session != nullptr)
+    ClientSessionCache::Put(wrap->session_cache_key_, session);
+}
+
+
+static void EvictSession(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  node::Utf8Value key(env->isolate(), args[0]);
+  ClientSessionCache::Remove(ClientSessionCache::Digest(*key, key.length()));
+}
+
+
+static void SetSessionCacheSize(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsNumber());
+  ClientSessionCache::Configure(static_cast<size_t>(args[0]->NumberValue()));
+}
+
+
+static void GetSessionCacheStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ClientSessionCache::Stats stats = ClientSessionCache::GetStats();
+
+  Local<Object> info = Object::New(env->isolate());
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "hits"),
+            Number::New(env->isolate(), static_cast<double>(stats.hits)));
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "misses"),
+            Number::New(env->isolate(), static_cast<double>(stats.misses)));
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "entries"),
+            Number::New(env->isolate(), static_cast<double>(stats.entries)));
+  args.GetReturnValue().Set(info);
+}
+
+
+static void ClearSessionCache(const FunctionCallbackInfo<Value>& args) {
+  ClientSessionCache::Clear();
+}
+
+
 void TLSWrap::EnableCertCb(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
@@ -898,6 +979,10 @@ void TLSWrap::Initialize(Local<Object> target,
   Environment* env = Environment::GetCurrent(context);
 
   env->SetMethod(target, "wrap", TLSWrap::Wrap);
+  env->SetMethod(target, "setSessionCacheSize", SetSessionCacheSize);
+  env->SetMethod(target, "getSessionCacheStats", GetSessionCacheStats);
+  env->SetMethod(target, "clearSessionCache", ClearSessionCache);
+  env->SetMethod(target, "evictSession", EvictSession);
 
   auto constructor = [](const FunctionCallbackInfo<Value>& args) {
     args.This()->SetAlignedPointerInInternalField(0, nullptr);
@@ -912,6 +997,8 @@ void TLSWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "enableSessionCallbacks", EnableSessionCallbacks);
   env->SetProtoMethod(t, "destroySSL", DestroySSL);
   env->SetProtoMethod(t, "enableCertCb", EnableCertCb);
+  env->SetProtoMethod(t, "setSessionCacheKey", SetSessionCacheKey);
+  env->SetProtoMethod(t, "cacheSession", CacheSession);
 
   StreamBase::AddMethods<TLSWrap>(env, t, StreamBase::kFlagHasWritev);
   SSLWrap<TLSWrap>::AddMethods(env, t);
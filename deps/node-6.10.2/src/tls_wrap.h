@@ -14,6 +14,8 @@
 
 #include <openssl/ssl.h>
 
+#include <string>
+
 namespace node {
 
 // Forward-declarations
@@ -137,6 +139,9 @@ class TLSWrap : public AsyncWrap,
   static void EnableCertCb(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DestroySSL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSessionCacheKey(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void CacheSession(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -158,6 +163,8 @@ class TLSWrap : public AsyncWrap,
   bool shutdown_;
   const char* error_;
   int cycle_depth_;
+  // Digest of the key of this client's session in ClientSessionCache.
+  std::string session_cache_key_;
 
   // If true - delivered EOF to the js-land, either after `close_notify`, or
   // after the `UV_EOF` on socket.
@@ -64,12 +64,19 @@ UDPWrap::UDPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      mmsg_slab_(nullptr),
+      mmsg_slab_size_(0) {
   int r = uv_udp_init(env->event_loop(), &handle_);
   CHECK_EQ(r, 0);  // can't fail anyway
 }
 
 
+UDPWrap::~UDPWrap() {
+  free(mmsg_slab_);
+}
+
+
 void UDPWrap::Initialize(Local<Object> target,
                          Local<Value> unused,
                          Local<Context> context) {
@@ -103,6 +110,7 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "setMulticastLoopback", SetMulticastLoopback);
   env->SetProtoMethod(t, "setBroadcast", SetBroadcast);
   env->SetProtoMethod(t, "setTTL", SetTTL);
+  env->SetProtoMethod(t, "setMmsg", SetMmsg);
 
   env->SetProtoMethod(t, "ref", HandleWrap::Ref);
   env->SetProtoMethod(t, "unref", HandleWrap::Unref);
@@ -354,6 +362,41 @@ void UDPWrap::RecvStop(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// setMmsg(count, size) switches the handle to reading up to |count|
+// datagrams of at most |size| bytes per system call, delivered to
+// onmessages() as one array, and to sending queued datagrams together.
+// Passing 0 switches back. Returns UV_ENOSYS where recvmmsg() is missing.
+void UDPWrap::SetMmsg(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK_EQ(args.Length(), 2);
+
+  const uint32_t count = args[0]->Uint32Value();
+  const uint32_t size = args[1]->Uint32Value();
+
+  int err = uv_udp_set_mmsg(&wrap->handle_, count, size);
+  if (err == 0) {
+    free(wrap->mmsg_slab_);
+    wrap->mmsg_slab_ = nullptr;
+    wrap->mmsg_slab_size_ = static_cast<size_t>(count) * size;
+    wrap->mmsg_chunks_.clear();
+    if (wrap->mmsg_slab_size_ > 0) {
+      wrap->mmsg_slab_ =
+          static_cast<char*>(node::Malloc(wrap->mmsg_slab_size_));
+      if (wrap->mmsg_slab_ == nullptr) {
+        FatalError("node::UDPWrap::SetMmsg()", "Out Of Memory");
+      }
+      wrap->mmsg_chunks_.reserve(count);
+    }
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+
 void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
   SendWrap* req_wrap = static_cast<SendWrap*>(req->data);
   if (req_wrap->have_callback()) {
@@ -373,6 +416,13 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  if (wrap->mmsg_slab_ != nullptr) {
+    buf->base = wrap->mmsg_slab_;
+    buf->len = wrap->mmsg_slab_size_;
+    return;
+  }
+
   buf->base = static_cast<char*>(node::Malloc(suggested_size));
   buf->len = suggested_size;
 
@@ -388,13 +438,39 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  const bool in_slab =
+      buf->base != nullptr && buf->base == wrap->mmsg_slab_;
+
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    MmsgChunk chunk;
+    chunk.offset = buf->base - wrap->mmsg_slab_;
+    chunk.length = nread;
+    if (addr != nullptr)
+      memcpy(&chunk.addr,
+             addr,
+             addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6)
+                                         : sizeof(sockaddr_in));
+    else
+      chunk.addr.ss_family = AF_UNSPEC;
+    wrap->mmsg_chunks_.push_back(chunk);
+    return;
+  }
+
+  if (flags & UV_UDP_MMSG_FREE) {
+    if (!wrap->mmsg_chunks_.empty())
+      wrap->OnRecvBatch();
+    if (!in_slab)
+      free(buf->base);
+    return;
+  }
+
   if (nread == 0 && addr == nullptr) {
-    if (buf->base != nullptr)
+    if (buf->base != nullptr && !in_slab)
       free(buf->base);
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
   Environment* env = wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -409,19 +485,53 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != nullptr)
+    if (buf->base != nullptr && !in_slab)
       free(buf->base);
     wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
     return;
   }
 
-  char* base = static_cast<char*>(node::Realloc(buf->base, nread));
-  argv[2] = Buffer::New(env, base, nread).ToLocalChecked();
+  if (in_slab) {
+    argv[2] = Buffer::Copy(env, buf->base, nread).ToLocalChecked();
+  } else {
+    char* base = static_cast<char*>(node::Realloc(buf->base, nread));
+    argv[2] = Buffer::New(env, base, nread).ToLocalChecked();
+  }
   argv[3] = AddressToJS(env, addr);
   wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
 }
 
 
+// Hands the datagrams of one recvmmsg() call to JS as an array of
+// [buffer, rinfo] pairs. The slab is reused, so each datagram is copied out.
+void UDPWrap::OnRecvBatch() {
+  Environment* env = this->env();
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  const size_t count = mmsg_chunks_.size();
+  Local<Array> messages = Array::New(env->isolate(), count);
+  for (size_t i = 0; i < count; i++) {
+    const MmsgChunk& chunk = mmsg_chunks_[i];
+    const sockaddr* addr = reinterpret_cast<const sockaddr*>(&chunk.addr);
+    Local<Array> pair = Array::New(env->isolate(), 2);
+    pair->Set(0, Buffer::Copy(env,
+                              mmsg_slab_ + chunk.offset,
+                              chunk.length).ToLocalChecked());
+    pair->Set(1, AddressToJS(env, addr));
+    messages->Set(i, pair);
+  }
+  mmsg_chunks_.clear();
+
+  Local<Value> argv[] = {
+    object(),
+    messages
+  };
+  MakeCallback(env->onmessages_string(), arraysize(argv), argv);
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env, AsyncWrap* parent) {
   EscapableHandleScope scope(env->isolate());
   // If this assert fires then Initialize hasn't been called yet.
@@ -11,6 +11,8 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <vector>
+
 namespace node {
 
 class UDPWrap: public HandleWrap {
@@ -34,6 +36,7 @@ class UDPWrap: public HandleWrap {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetBroadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTTL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetMmsg(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static v8::Local<v8::Object> Instantiate(Environment* env, AsyncWrap* parent);
   uv_udp_t* UVHandle();
@@ -47,7 +50,15 @@ class UDPWrap: public HandleWrap {
             int (*F)(const typename T::HandleType*, sockaddr*, int*)>
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
 
+  // A datagram received into the slab, see SetMmsg().
+  struct MmsgChunk {
+    size_t offset;
+    size_t length;
+    sockaddr_storage addr;
+  };
+
   UDPWrap(Environment* env, v8::Local<v8::Object> object, AsyncWrap* parent);
+  ~UDPWrap() override;
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
@@ -66,7 +77,13 @@ class UDPWrap: public HandleWrap {
                      const struct sockaddr* addr,
                      unsigned int flags);
 
+  void OnRecvBatch();
+
   uv_udp_t handle_;
+  // Receive buffer reused for every batch in multi-message mode.
+  char* mmsg_slab_;
+  size_t mmsg_slab_size_;
+  std::vector<MmsgChunk> mmsg_chunks_;
 };
 
 }  // namespace node
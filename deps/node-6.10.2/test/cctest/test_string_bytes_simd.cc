@@ -0,0 +1,101 @@
+#include "string_bytes_simd.h"
+#include "gtest/gtest.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace {
+
+using node::simd::CountNonAscii;
+using node::simd::ForceAscii;
+using node::simd::IsAscii;
+
+// Covers the 64-byte and 16-byte loops, the scalar tail and every edge
+// between them, from every alignment of the start within a 16-byte block.
+static const size_t kMaxLength = 200;
+static const size_t kMaxOffset = 16;
+
+static size_t ScalarCountNonAscii(const char* src, size_t len) {
+  size_t count = 0;
+  for (size_t i = 0; i < len; i++)
+    count += static_cast<uint8_t>(src[i]) >> 7;
+  return count;
+}
+
+static std::vector<char> AsciiBuffer(size_t size) {
+  std::vector<char> buffer(size);
+  for (size_t i = 0; i < size; i++)
+    buffer[i] = static_cast<char>(' ' + i % 95);
+  return buffer;
+}
+
+TEST(StringBytesSimdTest, IsAsciiAllAscii) {
+  std::vector<char> buffer = AsciiBuffer(kMaxOffset + kMaxLength);
+  for (size_t offset = 0; offset < kMaxOffset; offset++) {
+    for (size_t len = 0; len <= kMaxLength; len++)
+      EXPECT_TRUE(IsAscii(&buffer[offset], len)) << offset << " " << len;
+  }
+}
+
+TEST(StringBytesSimdTest, IsAsciiFindsEveryHighByte) {
+  std::vector<char> buffer = AsciiBuffer(kMaxOffset + kMaxLength + 1);
+  for (size_t offset = 0; offset < kMaxOffset; offset++) {
+    for (size_t len = 1; len <= kMaxLength; len++) {
+      for (size_t pos = 0; pos < len; pos++) {
+        const char saved = buffer[offset + pos];
+        buffer[offset + pos] = static_cast<char>(0x80 | pos);
+        EXPECT_FALSE(IsAscii(&buffer[offset], len))
+            << offset << " " << len << " " << pos;
+        // Just past the end does not count.
+        EXPECT_TRUE(IsAscii(&buffer[offset], pos)) << offset << " " << pos;
+        buffer[offset + pos] = saved;
+      }
+    }
+  }
+}
+
+TEST(StringBytesSimdTest, CountNonAscii) {
+  std::vector<char> buffer(kMaxOffset + kMaxLength);
+  for (size_t i = 0; i < buffer.size(); i++)
+    buffer[i] = static_cast<char>(i * 37);
+  for (size_t offset = 0; offset < kMaxOffset; offset++) {
+    for (size_t len = 0; len <= kMaxLength; len++) {
+      EXPECT_EQ(ScalarCountNonAscii(&buffer[offset], len),
+                CountNonAscii(&buffer[offset], len))
+          << offset << " " << len;
+    }
+  }
+}
+
+TEST(StringBytesSimdTest, CountNonAsciiCounterOverflow) {
+  // The per-byte counters of the vector loop are flushed every 255 blocks.
+  const size_t lengths[] = { 255 * 16 - 1, 255 * 16, 255 * 16 + 1,
+                             256 * 16, 256 * 16 + 15, 1024 * 16 + 7 };
+  for (size_t len : lengths) {
+    std::vector<char> buffer(len, static_cast<char>(0xff));
+    EXPECT_EQ(len, CountNonAscii(buffer.data(), len)) << len;
+  }
+}
+
+TEST(StringBytesSimdTest, ForceAscii) {
+  std::vector<char> buffer(kMaxOffset + kMaxLength);
+  for (size_t i = 0; i < buffer.size(); i++)
+    buffer[i] = static_cast<char>(i * 37);
+  for (size_t offset = 0; offset < kMaxOffset; offset++) {
+    for (size_t len = 0; len <= kMaxLength; len++) {
+      // One guard byte on either side, which must be left alone.
+      std::vector<char> out(len + 2, static_cast<char>(0xff));
+      ForceAscii(&buffer[offset], &out[1], len);
+      EXPECT_EQ(static_cast<char>(0xff), out[0]);
+      EXPECT_EQ(static_cast<char>(0xff), out[len + 1]);
+      for (size_t i = 0; i < len; i++) {
+        EXPECT_EQ(buffer[offset + i] & 0x7f, out[i + 1])
+            << offset << " " << len << " " << i;
+      }
+    }
+  }
+}
+
+}  // anonymous namespace
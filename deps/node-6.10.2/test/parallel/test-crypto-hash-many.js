@@ -0,0 +1,88 @@
+// Flags: --expose-gc
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+function hash(algorithm, input, encoding) {
+  const hash = crypto.createHash(algorithm);
+  [].concat(input).forEach((part) => hash.update(part, 'utf8'));
+  return hash.digest(encoding);
+}
+
+const inputs = [
+  'cache-key',
+  'Ünïcödé',
+  '',
+  Buffer.from([0, 1, 2, 3]),
+  Buffer.alloc(0),
+  ['concatenated ', Buffer.from('parts'), ''],
+  []
+];
+
+['md5', 'sha1', 'sha256', 'sha512'].forEach((algorithm) => {
+  const expected = inputs.map((input) => hash(algorithm, input));
+  assert.deepStrictEqual(crypto.hashMany(algorithm, inputs), expected);
+
+  ['hex', 'base64', 'latin1'].forEach((encoding) => {
+    assert.deepStrictEqual(
+      crypto.hashMany(algorithm, inputs, encoding),
+      inputs.map((input) => hash(algorithm, input, encoding)));
+  });
+});
+
+assert.deepStrictEqual(crypto.hashMany('sha256', []), []);
+
+// Small batches are hashed right away, large ones on the thread pool; the
+// callback is asynchronous either way.
+{
+  const large = [];
+  for (let i = 0; i < 64; i++)
+    large.push(Buffer.alloc(4096, i));
+
+  [inputs, large].forEach((batch) => {
+    let sync = true;
+    crypto.hashMany('sha256', batch, 'hex', common.mustCall((err, digests) => {
+      assert.ifError(err);
+      assert.strictEqual(sync, false);
+      const expected = batch.map((input) => hash('sha256', input, 'hex'));
+      assert.deepStrictEqual(digests, expected);
+    }));
+    sync = false;
+  });
+}
+
+// The Buffers stay alive while they are hashed even when the caller empties
+// its arrays, including nested ones, right after queueing the work.
+{
+  const batch = [];
+  for (let i = 0; i < 32; i++)
+    batch.push([Buffer.alloc(2048, i), Buffer.alloc(2048, 255 - i)]);
+  const expected = batch.map((input) => hash('sha1', input, 'hex'));
+
+  crypto.hashMany('sha1', batch, 'hex', common.mustCall((err, digests) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(digests, expected);
+  }));
+  batch.forEach((parts) => parts.length = 0);
+  batch.length = 0;
+  global.gc();
+}
+
+assert.throws(() => crypto.hashMany('sha256', 'data'),
+              /^TypeError: "data" argument must be an array$/);
+assert.throws(() => crypto.hashMany(256, []),
+              /^TypeError: "algorithm" argument must be a string$/);
+assert.throws(() => crypto.hashMany('sha256', [1]),
+              /^TypeError: Data must be a string or a buffer$/);
+assert.throws(() => crypto.hashMany('sha256', [[{}]]),
+              /^TypeError: Data must be a string or a buffer$/);
+assert.throws(() => crypto.hashMany('sha256', [], 'hex', 'callback'),
+              /^TypeError: "callback" argument must be a function$/);
+assert.throws(() => crypto.hashMany('no-such-digest', []),
+              /^Error: Digest method not supported$/);
@@ -0,0 +1,88 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+// Datagrams read in batches still come out one 'message' each, in order,
+// when nothing listens for 'messages'. Platforms without recvmmsg() ignore
+// the option altogether.
+const count = 20;
+const socket = dgram.createSocket({
+  type: 'udp4',
+  batch: { count: 8, size: 64 }
+});
+const received = [];
+
+socket.on('message', common.mustCall((msg, rinfo) => {
+  assert.strictEqual(rinfo.address, common.localhostIPv4);
+  assert.strictEqual(rinfo.port, socket.address().port);
+  assert.strictEqual(rinfo.size, msg.length);
+  received.push(msg.toString());
+
+  if (received.length === count) {
+    const expected = [];
+    for (let i = 0; i < count; i++)
+      expected.push('datagram ' + i);
+    assert.deepStrictEqual(received, expected);
+    socket.close();
+  }
+}, count));
+
+socket.bind(0, common.localhostIPv4, common.mustCall(() => {
+  for (let i = 0; i < count; i++)
+    socket.send('datagram ' + i, socket.address().port, common.localhostIPv4);
+}));
+
+// With a 'messages' listener, each read comes out as one array of
+// [msg, rinfo] pairs. All datagrams are sent before the loop gets to poll the
+// receiver, so every read finds more than one of them waiting.
+if (common.isLinux) {
+  const receiver = dgram.createSocket({
+    type: 'udp4',
+    batch: { count: 8, size: 64 }
+  });
+  const sender = dgram.createSocket('udp4');
+  const batched = [];
+
+  receiver.on('message', common.fail);
+  receiver.on('messages', common.mustCall((messages) => {
+    assert(Array.isArray(messages));
+    assert(messages.length > 1, `${messages.length} datagram(s) in a batch`);
+    assert(messages.length <= 8);
+    for (const pair of messages) {
+      assert.strictEqual(pair.length, 2);
+      const msg = pair[0];
+      const rinfo = pair[1];
+      assert(msg instanceof Buffer);
+      assert.strictEqual(rinfo.address, common.localhostIPv4);
+      assert.strictEqual(rinfo.port, sender.address().port);
+      assert.strictEqual(rinfo.size, msg.length);
+      batched.push(msg.toString());
+    }
+
+    if (batched.length === count) {
+      const expected = [];
+      for (let i = 0; i < count; i++)
+        expected.push('batched ' + i);
+      assert.deepStrictEqual(batched, expected);
+      receiver.close();
+      sender.close();
+    }
+  }, Math.ceil(count / 8)));
+
+  receiver.bind(0, common.localhostIPv4, common.mustCall(() => {
+    for (let i = 0; i < count; i++) {
+      sender.send('batched ' + i, receiver.address().port,
+                  common.localhostIPv4);
+    }
+  }));
+}
+
+assert.throws(() => {
+  dgram.createSocket({ type: 'udp4', batch: { count: 0, size: 64 } });
+}, /^RangeError: "batch.count" must be an integer from 1 to 32$/);
+
+assert.throws(() => {
+  dgram.createSocket({ type: 'udp4', batch: { count: 8, size: 0 } });
+}, /^RangeError: "batch.size" must be an integer from 1 to 65536$/);
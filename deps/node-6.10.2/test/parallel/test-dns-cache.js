@@ -0,0 +1,169 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+const dns = require('dns');
+
+// A stub resolver on loopback answering A queries from this table, and
+// NXDOMAIN for every other name. It counts the queries it gets per name.
+const answers = {
+  'cached.test': { address: [1, 2, 3, 4], ttl: 60 },
+  'uncached.test': { address: [5, 6, 7, 8], ttl: 0 }
+};
+const queries = {};
+
+function questionEnd(msg) {
+  let offset = 12;
+  while (msg[offset] !== 0)
+    offset += msg[offset] + 1;
+  return offset + 5;  // Root label, type and class.
+}
+
+function questionName(msg) {
+  const labels = [];
+  let offset = 12;
+  while (msg[offset] !== 0) {
+    labels.push(msg.toString('latin1', offset + 1, offset + 1 + msg[offset]));
+    offset += msg[offset] + 1;
+  }
+  return labels.join('.');
+}
+
+function reply(query) {
+  const name = questionName(query);
+  const answer = answers[name];
+  const question = query.slice(12, questionEnd(query));
+  const header = Buffer.alloc(12);
+
+  queries[name] = (queries[name] || 0) + 1;
+
+  query.copy(header, 0, 0, 2);  // ID
+  header.writeUInt16BE(answer ? 0x8180 : 0x8183, 2);  // NXDOMAIN if unknown
+  header.writeUInt16BE(1, 4);
+  header.writeUInt16BE(answer ? 1 : 0, 6);
+
+  if (!answer)
+    return Buffer.concat([header, question]);
+
+  const record = Buffer.alloc(16);
+  record.writeUInt16BE(0xc00c, 0);  // Pointer to the name in the question.
+  record.writeUInt16BE(1, 2);  // A
+  record.writeUInt16BE(1, 4);  // IN
+  record.writeUInt32BE(answer.ttl, 6);
+  record.writeUInt16BE(4, 10);
+  Buffer.from(answer.address).copy(record, 12);
+  return Buffer.concat([header, question, record]);
+}
+
+function resolveTwice(name, callback) {
+  dns.resolve4(name, common.mustCall((err1, first) => {
+    dns.resolve4(name, common.mustCall((err2, second) => {
+      callback(err1, first, err2, second);
+    }));
+  }));
+}
+
+// Concurrent lookups of the same name share one getaddrinfo() request, and
+// later ones are answered from the cache.
+function testLookup() {
+  const before = dns.getCacheStats();
+  const addresses = [];
+  const done = common.mustCall(() => {
+    assert.strictEqual(addresses[1], addresses[0]);
+    assert.strictEqual(addresses[2], addresses[0]);
+    assert.strictEqual(dns.getCacheStats().coalesced - before.coalesced, 2);
+
+    dns.lookup('localhost', 4, common.mustCall((err, address) => {
+      assert.ifError(err);
+      assert.strictEqual(address, addresses[0]);
+      assert.strictEqual(dns.getCacheStats().hits - before.hits, 1);
+    }));
+  });
+
+  for (let i = 0; i < 3; i++) {
+    dns.lookup('localhost', 4, common.mustCall((err, address) => {
+      assert.ifError(err);
+      addresses.push(address);
+      if (addresses.length === 3)
+        done();
+    }));
+  }
+}
+
+// Answers are cached per set of servers: switching to another server asks
+// it, and switching back finds the first server's answer still cached.
+function testServerSets(server, callback) {
+  const other = dgram.createSocket('udp4');
+  other.on('message', (msg, rinfo) => {
+    other.send(reply(msg), rinfo.port, rinfo.address);
+  });
+
+  other.bind(0, common.localhostIPv4, common.mustCall(() => {
+    dns.setServers([`${common.localhostIPv4}:${other.address().port}`]);
+    dns.resolve4('cached.test', common.mustCall((err, addresses) => {
+      assert.ifError(err);
+      assert.deepStrictEqual(addresses, ['1.2.3.4']);
+      assert.strictEqual(queries['cached.test'], 2);
+      other.close();
+
+      dns.setServers([`${common.localhostIPv4}:${server.address().port}`]);
+      dns.resolve4('cached.test', common.mustCall((err, addresses) => {
+        assert.ifError(err);
+        assert.deepStrictEqual(addresses, ['1.2.3.4']);
+        assert.strictEqual(queries['cached.test'], 2);
+        callback();
+      }));
+    }));
+  }));
+}
+
+const server = dgram.createSocket('udp4');
+
+server.on('message', (msg, rinfo) => {
+  server.send(reply(msg), rinfo.port, rinfo.address);
+});
+
+server.bind(0, common.localhostIPv4, common.mustCall(() => {
+  dns.setServers([`${common.localhostIPv4}:${server.address().port}`]);
+  dns.clearCache();
+
+  const before = dns.getCacheStats();
+
+  // Answered once, then from the cache for its TTL.
+  resolveTwice('cached.test', common.mustCall((err1, first, err2, second) => {
+    assert.ifError(err1);
+    assert.ifError(err2);
+    assert.deepStrictEqual(first, ['1.2.3.4']);
+    assert.deepStrictEqual(second, ['1.2.3.4']);
+    assert.strictEqual(queries['cached.test'], 1);
+
+    // A TTL of 0 is not cached.
+    resolveTwice('uncached.test', common.mustCall((err1, first, err2) => {
+      assert.ifError(err1);
+      assert.ifError(err2);
+      assert.deepStrictEqual(first, ['5.6.7.8']);
+      assert.strictEqual(queries['uncached.test'], 2);
+
+      // Names that do not exist are cached for the negative TTL.
+      resolveTwice('missing.test', common.mustCall((err1, first, err2) => {
+        assert.strictEqual(err1.code, 'ENOTFOUND');
+        assert.strictEqual(err2.code, 'ENOTFOUND');
+        assert.strictEqual(queries['missing.test'], 1);
+
+        const after = dns.getCacheStats();
+        assert.strictEqual(after.hits - before.hits, 2);
+        assert.strictEqual(after.misses - before.misses, 4);
+        testServerSets(server, common.mustCall(() => {
+          server.close();
+          testLookup();
+        }));
+      }));
+    }));
+  }));
+}));
+
+assert.throws(() => dns.setCacheOptions({ ttl: -1 }),
+              /^TypeError: "ttl" option must be a non-negative number$/);
+assert.throws(() => dns.setCacheOptions({ maxEntries: 1.5 }),
+              /^TypeError: "maxEntries" option must be a non-negative/);
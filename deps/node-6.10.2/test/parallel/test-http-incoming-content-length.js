@@ -0,0 +1,42 @@
+'use strict';
+// IncomingMessage#contentLength is the Content-Length header as parsed by the
+// HTTP parser, and undefined for messages without one.
+
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+
+const server = http.createServer(common.mustCall((req, res) => {
+  if (req.url === '/body') {
+    assert.strictEqual(req.contentLength, 5);
+    assert.strictEqual(req.headers['content-length'], '5');
+    req.resume();
+    req.on('end', common.mustCall(() => res.end('hello')));
+  } else {
+    assert.strictEqual(req.contentLength, undefined);
+    res.write('chunked');
+    res.end();
+  }
+}, 2));
+
+server.listen(0, common.mustCall(() => {
+  const port = server.address().port;
+  const req = http.request({
+    port: port,
+    method: 'POST',
+    path: '/body',
+    headers: { 'Content-Length': 5 }
+  }, common.mustCall((res) => {
+    assert.strictEqual(res.contentLength, 5);
+    res.resume();
+    res.on('end', common.mustCall(() => {
+      http.get({ port: port, path: '/chunked' }, common.mustCall((res) => {
+        assert.strictEqual(res.headers['transfer-encoding'], 'chunked');
+        assert.strictEqual(res.contentLength, undefined);
+        res.resume();
+        res.on('end', common.mustCall(() => server.close()));
+      }));
+    }));
+  }));
+  req.end('hello');
+}));
@@ -0,0 +1,57 @@
+'use strict';
+// Well-known header names come out of the parser interned. Whatever their
+// spelling, rawHeaders keeps it and headers uses the lower case name.
+
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+const knownHeaders = process.binding('http_parser').knownHeaders;
+
+assert.strictEqual(Object.getPrototypeOf(knownHeaders), null);
+assert.strictEqual(knownHeaders['Content-Type'], 'content-type');
+assert.strictEqual(knownHeaders['content-type'], 'content-type');
+assert.strictEqual(knownHeaders.ETag, 'etag');
+assert.strictEqual(knownHeaders['CONTENT-TYPE'], undefined);
+assert.strictEqual(knownHeaders['X-Custom'], undefined);
+
+const server = http.createServer(common.mustCall((req, res) => {
+  assert.deepStrictEqual(req.rawHeaders, [
+    'Host', 'localhost',
+    'content-type', 'text/plain',
+    'CONTENT-TYPE', 'text/html',
+    'Set-Cookie', 'a=1',
+    'set-cookie', 'b=2',
+    'X-Custom', 'one',
+    'x-custom', 'two',
+    'Content-Length', '0',
+    'Connection', 'close'
+  ]);
+  assert.deepStrictEqual(req.headers, {
+    host: 'localhost',
+    'content-type': 'text/plain',
+    'set-cookie': ['a=1', 'b=2'],
+    'x-custom': 'one, two',
+    'content-length': '0',
+    connection: 'close'
+  });
+  res.end();
+  server.close();
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port, () => {
+    client.end('GET / HTTP/1.1\r\n' +
+               'Host: localhost\r\n' +
+               'content-type: text/plain\r\n' +
+               'CONTENT-TYPE: text/html\r\n' +
+               'Set-Cookie: a=1\r\n' +
+               'set-cookie: b=2\r\n' +
+               'X-Custom: one\r\n' +
+               'x-custom: two\r\n' +
+               'Content-Length: 0\r\n' +
+               'Connection: close\r\n\r\n');
+  });
+  client.resume();
+}));
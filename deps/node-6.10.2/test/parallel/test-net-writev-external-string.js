@@ -0,0 +1,48 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// Large one-byte strings written through writev() go out from the string
+// itself rather than a copy, unless their encoding changes the bytes.
+const ascii = 'x'.repeat(100000);
+const latin1 = 'é'.repeat(100000);
+const utf8 = 'è'.repeat(100000);
+
+const expected = Buffer.concat([
+  Buffer.from('head'),
+  Buffer.from(ascii),
+  Buffer.from(latin1, 'latin1'),
+  Buffer.from(utf8, 'utf8'),
+  Buffer.from('tail')
+]);
+
+const server = net.createServer(common.mustCall((connection) => {
+  const writev = connection._writev.bind(connection);
+  connection._writev = common.mustCall(writev);
+
+  const before = connection._handle.bytesCopied;
+  connection.cork();
+  connection.write('head');
+  connection.write(ascii);
+  connection.write(latin1, 'latin1');
+  connection.write(utf8, 'utf8');
+  connection.write('tail');
+  connection.end();
+
+  // Only the short strings and the one re-encoded as UTF-8 were copied.
+  assert.strictEqual(connection._handle.bytesCopied - before,
+                     'head'.length + 2 * utf8.length + 'tail'.length);
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port);
+  const received = [];
+
+  client.on('data', (data) => received.push(data));
+  client.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(Buffer.concat(received), expected);
+    server.close();
+  }));
+}));
@@ -0,0 +1,59 @@
+// Flags: --timer-wheel
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+assert.strictEqual(process.binding('config').timerWheel, true);
+
+const order = [];
+const start = Date.now();
+
+const last = setTimeout(common.mustCall(() => {
+  order.push(30);
+  assert.deepStrictEqual(order, [10, 20, 30]);
+}), 30);
+assert(last._wheelId >= 0);
+setTimeout(common.mustCall(() => order.push(10)), 10);
+setTimeout(common.mustCall(() => order.push(20)), 20);
+clearTimeout(setTimeout(common.fail, 15));
+
+// Long enough to be cascaded down from the second level of the wheel.
+setTimeout(common.mustCall(() => {
+  assert(Date.now() - start >= 299);
+}), 300);
+
+let count = 0;
+const interval = setInterval(common.mustCall(() => {
+  if (++count === 3)
+    clearInterval(interval);
+}, 3), 5);
+
+// Timers that expire on the same tick still run after one of them throws.
+process.once('uncaughtException', common.mustCall((err) => {
+  assert.strictEqual(err.message, 'boom');
+}));
+setTimeout(common.mustCall(() => { throw new Error('boom'); }), 50);
+setTimeout(common.mustCall(), 50);
+
+// unref()'d timers do not keep the process alive, ref() brings them back.
+setTimeout(common.fail, 1e6).unref();
+setTimeout(common.mustCall(), 100).unref().ref();
+
+const server = net.createServer((socket) => socket.resume());
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port, common.mustCall(() => {
+    let wroteAt;
+    client.setTimeout(50, common.mustCall(() => {
+      // Activity re-arms the timeout rather than letting it fire early.
+      assert(Date.now() - wroteAt >= 49);
+      client.destroy();
+      server.close();
+    }));
+    setTimeout(() => {
+      wroteAt = Date.now();
+      client.write('ping');
+    }, 30);
+  }));
+}));
@@ -0,0 +1,86 @@
+'use strict';
+// Connections to the same server with the same options resume the session of
+// the previous one from the process-wide cache, unless they opt out of it or
+// verify the server identity themselves.
+
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+const ca = fs.readFileSync(common.fixturesDir + '/keys/ca1-cert.pem');
+const clientKey = fs.readFileSync(common.fixturesDir + '/keys/agent2-key.pem');
+const clientCert =
+    fs.readFileSync(common.fixturesDir + '/keys/agent2-cert.pem');
+
+const server = tls.createServer(options, common.mustCall((socket) => {
+  socket.end('Goodbye');
+}, 6));
+
+function connect(extra, callback) {
+  const client = tls.connect(Object.assign({
+    port: server.address().port,
+    ca: ca,
+    servername: 'agent1'
+  }, extra), common.mustCall(() => {
+    const reused = client.isSessionReused();
+    client.resume();
+    client.on('end', common.mustCall(() => callback(reused)));
+  }));
+}
+
+server.listen(0, common.mustCall(() => {
+  tls.clearSessionCache();
+  const before = tls.getSessionCacheStats();
+
+  connect({}, common.mustCall((reused) => {
+    assert.strictEqual(reused, false);
+
+    connect({}, common.mustCall((reused) => {
+      assert.strictEqual(reused, true);
+      assert.strictEqual(tls.getSessionCacheStats().hits - before.hits, 1);
+
+      connect({ sessionCache: false }, common.mustCall((reused) => {
+        assert.strictEqual(reused, false);
+        assert.strictEqual(tls.getSessionCacheStats().hits - before.hits, 1);
+        checkIdentity();
+      }));
+    }));
+  }));
+}));
+
+// A resumed session skips checkServerIdentity(), so one of the caller's own
+// must see every connection.
+function checkIdentity() {
+  const extra = {
+    checkServerIdentity: common.mustCall(() => undefined)
+  };
+  connect(extra, common.mustCall((reused) => {
+    assert.strictEqual(reused, false);
+    clientKeyObjects();
+  }));
+}
+
+// Keys given as {pem, passphrase} objects are told apart by their contents.
+function clientKeyObjects() {
+  const extra = { key: [{ pem: clientKey }], cert: clientCert };
+  connect(extra, common.mustCall((reused) => {
+    assert.strictEqual(reused, false);
+    connect(extra, common.mustCall((reused) => {
+      assert.strictEqual(reused, true);
+      server.close();
+    }));
+  }));
+}
+
+assert.throws(() => tls.setSessionCacheOptions({ maxEntries: -1 }),
+              /^TypeError: "maxEntries" option must be a non-negative/);
@@ -0,0 +1,74 @@
+'use strict';
+// The convenience methods compress and decompress whole buffers without a
+// stream object. Their output must match what a stream produces, whatever
+// pooled zlib state they happen to reuse.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const small = Buffer.from('hello world');
+const large = Buffer.alloc(64 * 1024);
+for (let i = 0; i < large.length; i++)
+  large[i] = (i * 7) % 61;
+
+const pairs = [
+  [ 'deflate', 'inflate', zlib.Deflate ],
+  [ 'gzip', 'gunzip', zlib.Gzip ],
+  [ 'deflateRaw', 'inflateRaw', zlib.DeflateRaw ],
+  [ 'gzip', 'unzip', zlib.Gzip ]
+];
+
+pairs.forEach(([compress, decompress, Stream]) => {
+  [small, large, Buffer.alloc(0)].forEach((input) => {
+    // Different levels in turn, so that pooled streams are not mixed up.
+    [1, 9, zlib.Z_DEFAULT_COMPRESSION].forEach((level) => {
+      const opts = { level: level };
+      const expected = new Stream(opts)._processChunk(input, zlib.Z_FINISH);
+      const compressed = zlib[compress + 'Sync'](input, opts);
+      assert.deepStrictEqual(compressed, expected);
+      assert.deepStrictEqual(zlib[decompress + 'Sync'](compressed), input);
+
+      let sync = true;
+      zlib[compress](input, opts, common.mustCall((err, result) => {
+        assert.ifError(err);
+        assert.strictEqual(sync, false);
+        assert.deepStrictEqual(result, expected);
+
+        zlib[decompress](result, common.mustCall((err, result) => {
+          assert.ifError(err);
+          assert.deepStrictEqual(result, input);
+        }));
+      }));
+      sync = false;
+    });
+  });
+});
+
+// Dictionaries are applied after the stream is taken from the pool.
+{
+  const dictionary = Buffer.from('hello');
+  const compressed = zlib.deflateSync(small, { dictionary: dictionary });
+  assert.deepStrictEqual(zlib.inflateSync(compressed, {
+    dictionary: dictionary
+  }), small);
+  assert.throws(() => zlib.inflateSync(compressed),
+                /^Error: Missing dictionary$/);
+}
+
+// Errors carry the zlib error code, synchronously and asynchronously.
+{
+  const compressed = zlib.gzipSync(large);
+  const truncated = compressed.slice(0, compressed.length / 2);
+  assert.throws(() => zlib.gunzipSync(truncated),
+                /^Error: unexpected end of file$/);
+
+  [Buffer.from('not compressed'), Buffer.alloc(4096, 'x')].forEach((input) => {
+    zlib.inflate(input, common.mustCall((err, result) => {
+      assert(err instanceof Error);
+      assert.strictEqual(err.code, 'Z_DATA_ERROR');
+      assert.strictEqual(err.message, 'incorrect header check');
+      assert.strictEqual(result, undefined);
+    }));
+  });
+}
@@ -0,0 +1,59 @@
+// Measures how many rows per second each() delivers to JavaScript with 1, 4
+// and 16 iterators running concurrently on the same database.
+//
+//     node benchmark/each.js [rows]
+
+var sqlite3 = require('../lib/sqlite3');
+
+var rows = parseInt(process.argv[2], 10) || 100000;
+var concurrency = [ 1, 4, 16 ];
+
+function setup(callback) {
+    var db = new sqlite3.Database('');
+    db.serialize(function() {
+        db.run("CREATE TABLE foo (id INT, txt TEXT)");
+        db.run("BEGIN");
+        var stmt = db.prepare("INSERT INTO foo VALUES (?, ?)");
+        for (var i = 0; i < rows; i++) {
+            stmt.run(i, 'Row ' + i);
+        }
+        stmt.finalize();
+        db.run("COMMIT", function(err) {
+            if (err) throw err;
+            callback(db);
+        });
+    });
+}
+
+function run(db, iterators, callback) {
+    var remaining = iterators;
+    var delivered = 0;
+    var start = process.hrtime();
+
+    db.parallelize(function() {
+        for (var i = 0; i < iterators; i++) {
+            db.each("SELECT id, txt FROM foo", function(err, row) {
+                if (err) throw err;
+                delivered++;
+            }, function(err) {
+                if (err) throw err;
+                if (--remaining) return;
+
+                var elapsed = process.hrtime(start);
+                var seconds = elapsed[0] + elapsed[1] / 1e9;
+                console.log('%d iterator(s): %d rows in %sms, %d rows/s',
+                    iterators, delivered, (seconds * 1000).toFixed(1),
+                    Math.round(delivered / seconds));
+                callback();
+            });
+        }
+    });
+}
+
+setup(function(db) {
+    var i = 0;
+    (function next() {
+        if (i < concurrency.length) return run(db, concurrency[i++], next);
+        db.close();
+    })();
+});
@@ -0,0 +1,99 @@
+// Compares KeyValueStore with the same key-value access pattern implemented on
+// top of Database#run/get and JSON.
+//
+//     node benchmark/kv.js [keys]
+
+var sqlite3 = require('../lib/sqlite3');
+
+var keys = parseInt(process.argv[2], 10) || 10000;
+var value = { user: 'someone', visits: 12, tags: [ 'a', 'b', 'c' ] };
+
+function time(label, count, start) {
+    var elapsed = process.hrtime(start);
+    var ms = elapsed[0] * 1000 + elapsed[1] / 1e6;
+    console.log('%s: %d ops in %sms, %d ops/s', label, count, ms.toFixed(1),
+        Math.round(count / ms * 1000));
+}
+
+function repeat(count, op, callback) {
+    var remaining = count;
+    for (var i = 0; i < count; i++) {
+        op(i, function(err) {
+            if (err) throw err;
+            if (!--remaining) callback();
+        });
+    }
+}
+
+var benchmarks = [
+    function database(done) {
+        var db = new sqlite3.Database('');
+        db.run("CREATE TABLE kv (key TEXT PRIMARY KEY, value TEXT)", function(err) {
+            if (err) throw err;
+
+            var start = process.hrtime();
+            repeat(keys, function(i, cb) {
+                db.run("INSERT OR REPLACE INTO kv VALUES (?, ?)", 'key:' + i, JSON.stringify(value), cb);
+            }, function() {
+                time('sqlite3 put', keys, start);
+
+                start = process.hrtime();
+                repeat(keys, function(i, cb) {
+                    db.get("SELECT value FROM kv WHERE key = ?", 'key:' + i, function(err, row) {
+                        JSON.parse(row.value);
+                        cb(err);
+                    });
+                }, function() {
+                    time('sqlite3 get', keys, start);
+                    db.close(done);
+                });
+            });
+        });
+    },
+
+    function keyValueStore(done) {
+        var store = new sqlite3.KeyValueStore('', { cacheSize: keys }, function(err) {
+            if (err) throw err;
+
+            var start = process.hrtime();
+            repeat(keys, function(i, cb) {
+                store.put('key:' + i, JSON.stringify(value), cb);
+            }, function() {
+                time('kv put', keys, start);
+
+                start = process.hrtime();
+                repeat(keys, function(i, cb) {
+                    store.get('key:' + i, function(err, text) {
+                        JSON.parse(text);
+                        cb(err);
+                    });
+                }, function() {
+                    time('kv get (cached)', keys, start);
+
+                    // Same again with every read going to the database.
+                    var cold = new sqlite3.KeyValueStore('', { cacheSize: 0 });
+                    repeat(keys, function(i, cb) {
+                        cold.put('key:' + i, JSON.stringify(value), cb);
+                    }, function() {
+                        start = process.hrtime();
+                        repeat(keys, function(i, cb) {
+                            cold.get('key:' + i, function(err, text) {
+                                JSON.parse(text);
+                                cb(err);
+                            });
+                        }, function() {
+                            time('kv get (uncached)', keys, start);
+                            cold.close();
+                            store.close(done);
+                        });
+                    });
+                });
+            });
+        });
+    }
+];
+
+(function next() {
+    var benchmark = benchmarks.shift();
+    if (benchmark) benchmark(next);
+})();
@@ -33,7 +33,9 @@
       ],
       "cflags": [ "-include ../src/gcc-preinclude.h" ],
       "sources": [
+        "src/blob.cc",
         "src/database.cc",
+        "src/kv.cc",
         "src/node_sqlite3.cc",
         "src/statement.cc"
       ]
@@ -4,6 +4,9 @@ var binding_path = binary.find(path.resolve(path.join(__dirname,'../package.json
 var binding = require(binding_path);
 var sqlite3 = module.exports = exports = binding;
 var EventEmitter = require('events').EventEmitter;
+var Readable = require('stream').Readable;
+var Writable = require('stream').Writable;
+var util = require('util');
 
 function normalizeMethod (fn) {
     return function (sql) {
@@ -28,10 +31,11 @@ function inherits(target, source) {
 }
 
 sqlite3.cached = {
-    Database: function(file, a, b) {
+    // (file, [mode], [options], [callback])
+    Database: function(file, a, b, c) {
         if (file === '' || file === ':memory:') {
             // Don't cache special databases.
-            return new Database(file, a, b);
+            return new Database(file, a, b, c);
         }
 
         var db;
@@ -39,12 +43,14 @@ sqlite3.cached = {
         function cb() { callback.call(db, null); }
 
         if (!sqlite3.cached.objects[file]) {
-            db = sqlite3.cached.objects[file] = new Database(file, a, b);
+            db = sqlite3.cached.objects[file] = new Database(file, a, b, c);
         }
         else {
             // Make sure the callback is called.
             db = sqlite3.cached.objects[file];
-            var callback = (typeof a === 'number') ? b : a;
+            var callback = [a, b, c].filter(function(arg) {
+                return typeof arg === 'function';
+            })[0];
             if (typeof callback === 'function') {
                 if (db.open) process.nextTick(cb);
                 else db.once('open', cb);
@@ -59,9 +65,13 @@ sqlite3.cached = {
 
 var Database = sqlite3.Database;
 var Statement = sqlite3.Statement;
+var Blob = sqlite3.Blob;
+var KeyValueStore = sqlite3.KeyValueStore;
 
 inherits(Database, EventEmitter);
 inherits(Statement, EventEmitter);
+inherits(Blob, EventEmitter);
+inherits(KeyValueStore, EventEmitter);
 
 // Database#prepare(sql, [bind1, bind2, ...], [callback])
 Database.prototype.prepare = normalizeMethod(function(statement, params) {
@@ -99,6 +109,117 @@ Database.prototype.map = normalizeMethod(function(statement, params) {
     return this;
 });
 
+// Database#openBlob(table, column, rowid, [options], [callback])
+// Opens a single BLOB value for incremental I/O and returns a readable stream,
+// or a writable stream when `options.writable` is set. The size of the value
+// can't be changed through the stream; use zeroblob() to reserve space first.
+Database.prototype.openBlob = function(table, column, rowid, options, callback) {
+    if (typeof options === 'function') {
+        callback = options;
+        options = undefined;
+    }
+    options = options || {};
+
+    var writable = !!options.writable;
+    var stream;
+    var blob = new Blob(this, table, column, rowid, writable, function(err) {
+        if (err) {
+            stream.closed = true;
+            if (typeof callback === 'function') callback.call(stream, err);
+            else stream.emit('error', err);
+            return;
+        }
+        stream.emit('open', blob.length);
+        if (typeof callback === 'function') callback.call(stream, null, stream);
+    });
+
+    stream = writable
+        ? new BlobWriteStream(blob, options)
+        : new BlobReadStream(blob, options);
+    return stream;
+};
+
+function BlobReadStream(blob, options) {
+    Readable.call(this, { highWaterMark: options.highWaterMark });
+    this.blob = blob;
+    this.chunkSize = options.chunkSize || 64 * 1024;
+    this.position = options.start || 0;
+    this.closed = false;
+    // Only once the consumer has read everything, so that 'close' follows 'end'.
+    this.once('end', function() { this.close(); });
+}
+util.inherits(BlobReadStream, Readable);
+
+BlobReadStream.prototype._read = function() {
+    var self = this;
+    this.blob.read(this.position, this.chunkSize, function(err, chunk) {
+        if (err) {
+            self.emit('error', err);
+            return self.close();
+        }
+        if (!chunk.length) {
+            return self.push(null);
+        }
+        self.position += chunk.length;
+        self.push(chunk);
+    });
+};
+
+function BlobWriteStream(blob, options) {
+    Writable.call(this, { highWaterMark: options.highWaterMark });
+    this.blob = blob;
+    this.position = options.start || 0;
+    this.closed = false;
+    this.once('finish', function() { this.close(); });
+}
+util.inherits(BlobWriteStream, Writable);
+
+BlobWriteStream.prototype._write = function(chunk, encoding, callback) {
+    var self = this;
+    this.blob.write(this.position, chunk, function(err) {
+        if (err) {
+            self.close();
+            return callback(err);
+        }
+        self.position += chunk.length;
+        callback();
+    });
+};
+
+// Coalesce buffered chunks into a single sqlite3_blob_write() call.
+BlobWriteStream.prototype._writev = function(chunks, callback) {
+    var buffers = chunks.map(function(entry) { return entry.chunk; });
+    this._write(Buffer.concat(buffers), null, callback);
+};
+
+BlobReadStream.prototype.close = BlobWriteStream.prototype.close = function(callback) {
+    if (typeof callback === 'function') this.once('close', callback);
+    if (this.closed) return;
+    this.closed = true;
+    var self = this;
+    this.blob.close(function() { self.emit('close'); });
+};
+
+sqlite3.BlobReadStream = BlobReadStream;
+sqlite3.BlobWriteStream = BlobWriteStream;
+
+// KeyValueStore#get(key, callback)
+// Cached values are returned without going through the thread pool. The
+// callback receives undefined for keys that don't exist.
+KeyValueStore.prototype.get = function(key, callback) {
+    var value = this.peek(key);
+    if (value === undefined) {
+        return this.fetch(key, callback);
+    }
+    if (typeof callback === 'function') {
+        var self = this;
+        process.nextTick(function() {
+            callback.call(self, null, value === null ? undefined : value);
+        });
+    }
+    return this;
+};
+
 Statement.prototype.map = function() {
     var params = Array.prototype.slice.call(arguments);
     var callback = params.pop();
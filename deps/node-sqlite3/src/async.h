@@ -2,41 +2,52 @@
 #define NODE_SQLITE3_SRC_ASYNC_H
 
 #include "threading.h"
+#include "ring.h"
 #include <node_version.h>
 
 #if defined(NODE_SQLITE3_BOOST_THREADING)
 #include <boost/thread/mutex.hpp>
 #endif
 
+// Number of items handed over without locking before the producer starts
+// spilling into the overflow list.
+#define ASYNC_QUEUE_CAPACITY 1024
+
 
 // Generic uv_async handler.
+//
+// The trace, profile and update hooks that feed it run inside SQLite with the
+// database mutex held, which makes them a single producer.
 template <class Item, class Parent> class Async {
     typedef void (*Callback)(Parent* parent, Item* item);
 
 protected:
     uv_async_t watcher;
-    NODE_SQLITE3_MUTEX_t
-    std::vector<Item*> data;
+    HandoffQueue<Item*> data;
+    // Set by the first send() after the listener ran, so that a burst of
+    // items costs a single uv_async_send.
+    std::atomic<bool> signalled;
     Callback callback;
 public:
     Parent* parent;
 
 public:
     Async(Parent* parent_, Callback cb_, uv_loop_t *loop_)
-        : callback(cb_), parent(parent_) {
+        : data(ASYNC_QUEUE_CAPACITY), signalled(false),
+          callback(cb_), parent(parent_) {
         watcher.data = this;
-        NODE_SQLITE3_MUTEX_INIT
         uv_async_init(loop_, &watcher, reinterpret_cast<uv_async_cb>(listener));
     }
 
     static void listener(uv_async_t* handle, int status) {
         Async* async = static_cast<Async*>(handle->data);
-        std::vector<Item*> rows;
-        NODE_SQLITE3_MUTEX_LOCK(&async->mutex)
-        rows.swap(async->data);
-        NODE_SQLITE3_MUTEX_UNLOCK(&async->mutex)
-        for (unsigned int i = 0, size = rows.size(); i < size; i++) {
-            async->callback(async->parent, rows[i]);
+        // Cleared before draining, so anything added from here on triggers
+        // another wakeup instead of being missed.
+        async->signalled.store(false);
+
+        Item* item;
+        while (async->data.pop(item)) {
+            async->callback(async->parent, item);
         }
     }
 
@@ -56,23 +67,19 @@ public:
     }
 
     void add(Item* item) {
-        NODE_SQLITE3_MUTEX_LOCK(&mutex);
-        data.push_back(item);
-        NODE_SQLITE3_MUTEX_UNLOCK(&mutex)
+        data.push(item);
     }
 
     void send() {
-        uv_async_send(&watcher);
+        if (!signalled.exchange(true)) {
+            uv_async_send(&watcher);
+        }
     }
 
     void send(Item* item) {
         add(item);
         send();
     }
-
-    ~Async() {
-        NODE_SQLITE3_MUTEX_DESTROY
-    }
 };
 
 #endif
@@ -0,0 +1,410 @@
+#include <string.h>
+#include <node.h>
+#include <node_buffer.h>
+#include <node_version.h>
+
+#include "macros.h"
+#include "database.h"
+#include "blob.h"
+#include "env.h"
+#include "env-inl.h"
+
+using namespace node_sqlite3;
+
+NAN_MODULE_INIT(Blob::Init) {
+    Nan::HandleScope scope;
+
+    Local<FunctionTemplate> t = Nan::New<FunctionTemplate>(New);
+
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(Nan::New("Blob").ToLocalChecked());
+
+    Nan::SetPrototypeMethod(t, "read", Read);
+    Nan::SetPrototypeMethod(t, "write", Write);
+    Nan::SetPrototypeMethod(t, "close", Close);
+
+    NODE_SET_GETTER(t, "length", LengthGetter);
+
+    Nan::Set(target, Nan::New("Blob").ToLocalChecked(),
+        Nan::GetFunction(t).ToLocalChecked());
+}
+
+void Blob::Process() {
+    if (closed && !queue.empty()) {
+        return CleanQueue();
+    }
+
+    while (opened && !locked && !queue.empty()) {
+        Call* call = queue.front();
+        queue.pop();
+
+        call->callback(call->baton);
+        delete call;
+    }
+}
+
+void Blob::Schedule(Work_Callback callback, Baton* baton) {
+    if (closed) {
+        queue.push(new Call(callback, baton));
+        CleanQueue();
+    }
+    else if (!opened || locked) {
+        queue.push(new Call(callback, baton));
+    }
+    else {
+        callback(baton);
+    }
+}
+
+template <class T> void Blob::Error(T* baton) {
+    Nan::HandleScope scope;
+
+    Blob* blob = baton->blob;
+    // Fail hard on logic errors.
+    assert(blob->status != 0);
+    EXCEPTION(Nan::New(blob->message.c_str()).ToLocalChecked(), blob->status, exception);
+
+    Local<Function> cb = Nan::New(baton->callback);
+
+    if (!cb.IsEmpty() && cb->IsFunction()) {
+        Local<Value> argv[] = { exception };
+        TRY_CATCH_CALL(blob->handle(), cb, 1, argv);
+    }
+    else {
+        Local<Value> argv[] = { Nan::New("error").ToLocalChecked(), exception };
+        EMIT_EVENT(blob->handle(), 2, argv);
+    }
+}
+
+// { Database db, String table, String column, Number rowid, Boolean writable, Function callback }
+NAN_METHOD(Blob::New) {
+    if (!info.IsConstructCall()) {
+        return Nan::ThrowTypeError("Use the new operator to create new Blob objects");
+    }
+
+    int length = info.Length();
+
+    if (length <= 0 || !Database::HasInstance(info[0])) {
+        return Nan::ThrowTypeError("Database object expected");
+    }
+    else if (length <= 1 || !info[1]->IsString()) {
+        return Nan::ThrowTypeError("Table name expected");
+    }
+    else if (length <= 2 || !info[2]->IsString()) {
+        return Nan::ThrowTypeError("Column name expected");
+    }
+    else if (length <= 3 || !info[3]->IsNumber()) {
+        return Nan::ThrowTypeError("Row ID expected");
+    }
+    else if (length > 5 && !info[5]->IsUndefined() && !info[5]->IsFunction()) {
+        return Nan::ThrowTypeError("Callback expected");
+    }
+
+    Database* db = Nan::ObjectWrap::Unwrap<Database>(info[0].As<Object>());
+    bool writable = length > 4 && Nan::To<bool>(info[4]).FromJust();
+
+    Blob* blob = new Blob(db, writable);
+    blob->Wrap(info.This());
+
+    Environment* env = Environment::GetCurrent(info.GetIsolate());
+
+    OpenBaton* baton = new OpenBaton(db, Local<Function>::Cast(info[5]), blob, env->event_loop());
+    baton->table = std::string(*Nan::Utf8String(info[1]));
+    baton->column = std::string(*Nan::Utf8String(info[2]));
+    baton->rowid = Nan::To<int64_t>(info[3]).FromJust();
+    db->Schedule(Work_BeginOpen, baton);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+void Blob::Work_BeginOpen(Database::Baton* baton) {
+    assert(baton->db->open);
+    baton->db->pending++;
+    int status = uv_queue_work(baton->loop,
+        &baton->request, Work_Open, (uv_after_work_cb)Work_AfterOpen);
+    assert(status == 0);
+}
+
+void Blob::Work_Open(uv_work_t* req) {
+    BLOB_INIT(OpenBaton);
+
+    // In case opening fails, we use a mutex to make sure we get the associated
+    // error message.
+    sqlite3_mutex* mtx = sqlite3_db_mutex(baton->db->_handle);
+    sqlite3_mutex_enter(mtx);
+
+    blob->status = sqlite3_blob_open(
+        baton->db->_handle,
+        "main",
+        baton->table.c_str(),
+        baton->column.c_str(),
+        baton->rowid,
+        blob->writable ? 1 : 0,
+        &blob->_handle
+    );
+
+    if (blob->status != SQLITE_OK) {
+        blob->message = std::string(sqlite3_errmsg(baton->db->_handle));
+        blob->_handle = NULL;
+    }
+    else {
+        blob->length = sqlite3_blob_bytes(blob->_handle);
+    }
+
+    sqlite3_mutex_leave(mtx);
+}
+
+void Blob::Work_AfterOpen(uv_work_t* req) {
+    Nan::HandleScope scope;
+
+    BLOB_INIT(OpenBaton);
+
+    if (blob->status != SQLITE_OK) {
+        Error(baton);
+        blob->Close();
+    }
+    else {
+        blob->opened = true;
+        Local<Function> cb = Nan::New(baton->callback);
+        if (!cb.IsEmpty() && cb->IsFunction()) {
+            Local<Value> argv[] = { Nan::Null() };
+            TRY_CATCH_CALL(blob->handle(), cb, 1, argv);
+        }
+    }
+
+    BLOB_END();
+}
+
+NAN_GETTER(Blob::LengthGetter) {
+    Blob* blob = Nan::ObjectWrap::Unwrap<Blob>(info.This());
+    info.GetReturnValue().Set(blob->length);
+}
+
+// { Number offset, Number length, Function callback }
+NAN_METHOD(Blob::Read) {
+    Blob* blob = Nan::ObjectWrap::Unwrap<Blob>(info.This());
+
+    if (info.Length() <= 0 || !info[0]->IsInt32() ||
+            Nan::To<int32_t>(info[0]).FromJust() < 0) {
+        return Nan::ThrowTypeError("Offset must be a non-negative integer");
+    }
+    else if (info.Length() <= 1 || !info[1]->IsInt32() ||
+            Nan::To<int32_t>(info[1]).FromJust() < 0) {
+        return Nan::ThrowTypeError("Length must be a non-negative integer");
+    }
+    OPTIONAL_ARGUMENT_FUNCTION(2, callback);
+
+    Environment* env = Environment::GetCurrent(info.GetIsolate());
+
+    ReadBaton* baton = new ReadBaton(blob, callback, env->event_loop(),
+        Nan::To<int32_t>(info[0]).FromJust(), Nan::To<int32_t>(info[1]).FromJust());
+    blob->Schedule(Work_BeginRead, baton);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+void Blob::Work_BeginRead(Baton* baton) {
+    BLOB_BEGIN(Read);
+}
+
+void Blob::Work_Read(uv_work_t* req) {
+    BLOB_INIT(ReadBaton);
+
+    // Reads past the end are truncated rather than treated as an error so
+    // that a reader can simply stop at the first empty chunk.
+    int available = blob->length - baton->offset;
+    if (available < 0) available = 0;
+    if (baton->length > available) baton->length = available;
+
+    blob->status = SQLITE_OK;
+    if (baton->length > 0) {
+        // Allocated the same way as node's ArrayBuffer::Allocator so the
+        // chunk can be handed to a Buffer without copying.
+        baton->data = (char*)node::Malloc(baton->length);
+
+        sqlite3_mutex* mtx = sqlite3_db_mutex(blob->db->_handle);
+        sqlite3_mutex_enter(mtx);
+
+        blob->status = sqlite3_blob_read(blob->_handle, baton->data,
+            baton->length, baton->offset);
+        if (blob->status != SQLITE_OK) {
+            blob->message = std::string(sqlite3_errmsg(blob->db->_handle));
+        }
+
+        sqlite3_mutex_leave(mtx);
+    }
+}
+
+void Blob::Work_AfterRead(uv_work_t* req) {
+    Nan::HandleScope scope;
+
+    BLOB_INIT(ReadBaton);
+
+    if (blob->status != SQLITE_OK) {
+        Error(baton);
+    }
+    else {
+        Local<Function> cb = Nan::New(baton->callback);
+        if (!cb.IsEmpty() && cb->IsFunction()) {
+            Local<Value> chunk;
+            if (baton->length > 0) {
+                chunk = Nan::NewBuffer(baton->data, baton->length).ToLocalChecked();
+                baton->data = NULL;
+            }
+            else {
+                chunk = Nan::NewBuffer(0).ToLocalChecked();
+            }
+            Local<Value> argv[] = { Nan::Null(), chunk };
+            TRY_CATCH_CALL(blob->handle(), cb, 2, argv);
+        }
+    }
+
+    BLOB_END();
+}
+
+// { Number offset, Buffer data, Function callback }
+NAN_METHOD(Blob::Write) {
+    Blob* blob = Nan::ObjectWrap::Unwrap<Blob>(info.This());
+
+    if (info.Length() <= 0 || !info[0]->IsInt32() ||
+            Nan::To<int32_t>(info[0]).FromJust() < 0) {
+        return Nan::ThrowTypeError("Offset must be a non-negative integer");
+    }
+    else if (info.Length() <= 1 || !Buffer::HasInstance(info[1])) {
+        return Nan::ThrowTypeError("Buffer expected");
+    }
+    OPTIONAL_ARGUMENT_FUNCTION(2, callback);
+
+    Environment* env = Environment::GetCurrent(info.GetIsolate());
+
+    WriteBaton* baton = new WriteBaton(blob, callback, env->event_loop(),
+        Nan::To<int32_t>(info[0]).FromJust(), info[1].As<Object>());
+    blob->Schedule(Work_BeginWrite, baton);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+void Blob::Work_BeginWrite(Baton* baton) {
+    BLOB_BEGIN(Write);
+}
+
+void Blob::Work_Write(uv_work_t* req) {
+    BLOB_INIT(WriteBaton);
+
+    sqlite3_mutex* mtx = sqlite3_db_mutex(blob->db->_handle);
+    sqlite3_mutex_enter(mtx);
+
+    // Incremental I/O can't change the size of the value; writing past the
+    // end fails with SQLITE_ERROR.
+    blob->status = sqlite3_blob_write(blob->_handle, baton->data,
+        baton->length, baton->offset);
+    if (blob->status != SQLITE_OK) {
+        blob->message = std::string(sqlite3_errmsg(blob->db->_handle));
+    }
+
+    sqlite3_mutex_leave(mtx);
+}
+
+void Blob::Work_AfterWrite(uv_work_t* req) {
+    Nan::HandleScope scope;
+
+    BLOB_INIT(WriteBaton);
+
+    if (blob->status != SQLITE_OK) {
+        Error(baton);
+    }
+    else {
+        Local<Function> cb = Nan::New(baton->callback);
+        if (!cb.IsEmpty() && cb->IsFunction()) {
+            Local<Value> argv[] = { Nan::Null() };
+            TRY_CATCH_CALL(blob->handle(), cb, 1, argv);
+        }
+    }
+
+    BLOB_END();
+}
+
+NAN_METHOD(Blob::Close) {
+    Blob* blob = Nan::ObjectWrap::Unwrap<Blob>(info.This());
+    OPTIONAL_ARGUMENT_FUNCTION(0, callback);
+
+    Environment* env = Environment::GetCurrent(info.GetIsolate());
+
+    Baton* baton = new Baton(blob, callback, env->event_loop());
+    blob->Schedule(Close, baton);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+void Blob::Close(Baton* baton) {
+    Nan::HandleScope scope;
+
+    baton->blob->Close();
+
+    // Fire callback in case there was one.
+    Local<Function> cb = Nan::New(baton->callback);
+    if (!cb.IsEmpty() && cb->IsFunction()) {
+        TRY_CATCH_CALL(baton->blob->handle(), cb, 0, NULL);
+    }
+
+    delete baton;
+}
+
+void Blob::Close() {
+    assert(!closed);
+    closed = true;
+    CleanQueue();
+    // Pending writes have already been reported through their callbacks, so
+    // the status returned here carries no new information.
+    sqlite3_blob_close(_handle);
+    _handle = NULL;
+    db->Unref();
+}
+
+void Blob::CleanQueue() {
+    Nan::HandleScope scope;
+
+    if (opened && !queue.empty()) {
+        // This blob has already been opened and is now closed.
+        // Fire error for all remaining items in the queue.
+        EXCEPTION(Nan::New<String>("Blob is already closed").ToLocalChecked(), SQLITE_MISUSE, exception);
+        Local<Value> argv[] = { exception };
+        bool called = false;
+
+        // Clear out the queue so that this object can get GC'ed.
+        while (!queue.empty()) {
+            Call* call = queue.front();
+            queue.pop();
+
+            Local<Function> cb = Nan::New(call->baton->callback);
+
+            if (!cb.IsEmpty() && cb->IsFunction()) {
+                TRY_CATCH_CALL(handle(), cb, 1, argv);
+                called = true;
+            }
+
+            // We don't call the actual callback, so we have to make sure that
+            // the baton gets destroyed.
+            delete call->baton;
+            delete call;
+        }
+
+        // When we couldn't call a callback function, emit an error on the
+        // Blob object.
+        if (!called) {
+            Local<Value> info[] = { Nan::New("error").ToLocalChecked(), exception };
+            EMIT_EVENT(handle(), 2, info);
+        }
+    }
+    else while (!queue.empty()) {
+        // Just delete all items in the queue; we already fired an event when
+        // opening the blob failed.
+        Call* call = queue.front();
+        queue.pop();
+
+        // We don't call the actual callback, so we have to make sure that
+        // the baton gets destroyed.
+        delete call->baton;
+        delete call;
+    }
+}
@@ -0,0 +1,153 @@
+#ifndef NODE_SQLITE3_SRC_BLOB_H
+#define NODE_SQLITE3_SRC_BLOB_H
+
+
+#include "database.h"
+
+#include <cstdlib>
+#include <string>
+#include <queue>
+
+#include <sqlite3.h>
+#include <nan.h>
+
+using namespace v8;
+using namespace node;
+
+namespace node_sqlite3 {
+
+// Incremental I/O on a single BLOB value (sqlite3_blob_open). Reads and
+// writes are done in caller-sized chunks on the thread pool so that large
+// values never have to be materialized in one piece.
+class Blob : public Nan::ObjectWrap {
+public:
+    static NAN_MODULE_INIT(Init);
+    static NAN_METHOD(New);
+
+    struct Baton {
+        uv_work_t request;
+        Blob* blob;
+        Nan::Persistent<Function> callback;
+        uv_loop_t *loop;
+
+        Baton(Blob* blob_, Local<Function> cb_, uv_loop_t* loop_) : blob(blob_), loop(loop_) {
+            blob->Ref();
+            request.data = this;
+            callback.Reset(cb_);
+        }
+        virtual ~Baton() {
+            blob->Unref();
+            callback.Reset();
+        }
+    };
+
+    struct ReadBaton : Baton {
+        ReadBaton(Blob* blob_, Local<Function> cb_, uv_loop_t* loop_, int offset_, int length_) :
+            Baton(blob_, cb_, loop_), offset(offset_), length(length_), data(NULL) {}
+        virtual ~ReadBaton() {
+            free(data);
+        }
+        int offset;
+        int length;
+        char* data;
+    };
+
+    struct WriteBaton : Baton {
+        WriteBaton(Blob* blob_, Local<Function> cb_, uv_loop_t* loop_, int offset_, Local<Object> buffer_) :
+                Baton(blob_, cb_, loop_), offset(offset_) {
+            // Hold on to the buffer so its memory can be written from the
+            // thread pool without copying it first.
+            buffer.Reset(buffer_);
+            data = Buffer::Data(buffer_);
+            length = Buffer::Length(buffer_);
+        }
+        virtual ~WriteBaton() {
+            buffer.Reset();
+        }
+        int offset;
+        Nan::Persistent<Object> buffer;
+        const char* data;
+        int length;
+    };
+
+    struct OpenBaton : Database::Baton {
+        Blob* blob;
+        std::string table;
+        std::string column;
+        sqlite3_int64 rowid;
+        OpenBaton(Database* db_, Local<Function> cb_, Blob* blob_, uv_loop_t *loop_) :
+            Baton(db_, cb_, loop_), blob(blob_), rowid(0) {
+            blob->Ref();
+        }
+        virtual ~OpenBaton() {
+            blob->Unref();
+            // The database handle was closed before the blob could be opened.
+            // A failed open has already closed the blob in Work_AfterOpen.
+            if (!blob->closed && !db->IsOpen() && db->IsLocked()) {
+                blob->Close();
+            }
+        }
+    };
+
+    typedef void (*Work_Callback)(Baton* baton);
+
+    struct Call {
+        Call(Work_Callback cb_, Baton* baton_) : callback(cb_), baton(baton_) {};
+        Work_Callback callback;
+        Baton* baton;
+    };
+
+    Blob(Database* db_, bool writable_) : Nan::ObjectWrap(),
+            db(db_),
+            _handle(NULL),
+            status(SQLITE_OK),
+            length(0),
+            writable(writable_),
+            opened(false),
+            locked(true),
+            closed(false) {
+        db->Ref();
+    }
+
+    ~Blob() {
+        if (!closed) Close();
+    }
+
+    WORK_DEFINITION(Read);
+    WORK_DEFINITION(Write);
+
+    static NAN_METHOD(Close);
+
+protected:
+    static void Work_BeginOpen(Database::Baton* baton);
+    static void Work_Open(uv_work_t* req);
+    static void Work_AfterOpen(uv_work_t* req);
+
+    static NAN_GETTER(LengthGetter);
+
+    static void Close(Baton* baton);
+    void Close();
+
+    void Schedule(Work_Callback callback, Baton* baton);
+    void Process();
+    void CleanQueue();
+    template <class T> static void Error(T* baton);
+
+protected:
+    Database* db;
+
+    sqlite3_blob* _handle;
+    int status;
+    std::string message;
+    int length;
+
+    bool writable;
+    bool opened;
+    bool locked;
+    bool closed;
+    std::queue<Call*> queue;
+};
+
+}
+
+#endif
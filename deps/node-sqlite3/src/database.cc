@@ -1,4 +1,5 @@
 #include <string.h>
+#include <sstream>
 
 #include "macros.h"
 #include "database.h"
@@ -33,6 +34,8 @@ NAN_MODULE_INIT(Database::Init) {
     Nan::SetPrototypeMethod(t, "parallelize", Parallelize);
     Nan::SetPrototypeMethod(t, "configure", Configure);
     Nan::SetPrototypeMethod(t, "interrupt", Interrupt);
+    Nan::SetPrototypeMethod(t, "checkpoint", Checkpoint);
+    Nan::SetPrototypeMethod(t, "stats", Stats);
 
     NODE_SET_GETTER(t, "open", OpenGetter);
 
@@ -116,31 +119,38 @@ void Database::Schedule(Work_Callback callback, Baton* baton, bool exclusive) {
     }
 }
 
-#include <android/log.h>
-NAN_METHOD(Database::New) {
-    Environment* env = Environment::GetCurrent(info.GetIsolate());
-    if (!info.IsConstructCall()) {
-        return Nan::ThrowTypeError("Use the new operator to create new Database objects");
-    }
-
-    REQUIRE_ARGUMENT_STRING(0, filename);
-    const char *use_fn = *filename;
-    std::string dealiased;
-    if (strcmp(use_fn,"") && strcmp(*filename,":memory:")) {
-        Local<Value> fn = nodedroid::fs_(env, info[0], _FS_ACCESS_RD | _FS_ACCESS_WR);
+// Maps a file name given by JavaScript onto the real path in the service's
+// file system. Special names such as ":memory:" are passed through.
+std::string Database::ResolveFilename(Environment* env, Local<Value> filename) {
+    Nan::Utf8String name(filename);
+    std::string resolved(*name);
+    if (resolved != "" && resolved != ":memory:") {
+        Local<Value> fn = nodedroid::fs_(env, filename, _FS_ACCESS_RD | _FS_ACCESS_WR);
         Nan::Utf8String aliased(fn);
         if (*aliased) {
             std::string aliased_(*aliased);
             size_t found = aliased_.find_last_of("/");
             std::string path = aliased_.substr(0,found);
             std::string file = aliased_.substr(found+1);
-            fn = nodedroid::fs_(env, String::NewFromUtf8(info.GetIsolate(),path.c_str()),
+            fn = nodedroid::fs_(env, String::NewFromUtf8(env->isolate(),path.c_str()),
                 _FS_ACCESS_NONE);
             Nan::Utf8String dealiased_path(fn);
-            dealiased = std::string(*dealiased_path) + "/" + file;
-            use_fn = dealiased.c_str();
+            resolved = std::string(*dealiased_path) + "/" + file;
         }
     }
+    return resolved;
+}
+
+#include <android/log.h>
+NAN_METHOD(Database::New) {
+    Environment* env = Environment::GetCurrent(info.GetIsolate());
+    if (!info.IsConstructCall()) {
+        return Nan::ThrowTypeError("Use the new operator to create new Database objects");
+    }
+
+    REQUIRE_ARGUMENT_STRING(0, filename);
+    std::string dealiased = ResolveFilename(env, info[0]);
+    const char *use_fn = dealiased.c_str();
     if (use_fn) {
         int pos = 1;
 
@@ -151,6 +161,11 @@ NAN_METHOD(Database::New) {
             mode = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX;
         }
 
+        OpenOptions options;
+        if (info.Length() > pos && info[pos]->IsObject() && !info[pos]->IsFunction()) {
+            if (!ParseOpenOptions(info[pos++].As<Object>(), options)) return;
+        }
+
         Local<Function> callback;
         if (info.Length() >= pos && info[pos]->IsFunction()) {
             callback = Local<Function>::Cast(info[pos++]);
@@ -167,12 +182,96 @@ NAN_METHOD(Database::New) {
 
         // Start opening the database.
         OpenBaton* baton = new OpenBaton(db, callback, use_fn, mode, env->event_loop());
+        baton->options = options;
         Work_BeginOpen(baton);
 
         info.GetReturnValue().Set(info.This());
     }
 }
 
+namespace {
+
+// Looks up an optional integer in the options object. Returns 0 when the
+// option is absent, 1 when it was stored in `result`, and -1 after throwing.
+int GetIntegerOption(Local<Object> source, const char* name, int64_t* result) {
+    Local<Value> value = Nan::Get(source, Nan::New(name).ToLocalChecked()).ToLocalChecked();
+    if (value->IsUndefined()) return 0;
+    if (!value->IsNumber()) {
+        Nan::ThrowTypeError((std::string(name) + " must be an integer").c_str());
+        return -1;
+    }
+    *result = Nan::To<int64_t>(value).FromJust();
+    return 1;
+}
+
+// Like GetIntegerOption, but only accepts one of the given keywords, which
+// makes the value safe to splice into a PRAGMA statement.
+int GetKeywordOption(Local<Object> source, const char* name,
+        const char* const* keywords, std::string* result) {
+    Local<Value> value = Nan::Get(source, Nan::New(name).ToLocalChecked()).ToLocalChecked();
+    if (value->IsUndefined()) return 0;
+    if (value->IsString()) {
+        std::string keyword(*Nan::Utf8String(value));
+        for (size_t i = 0; i < keyword.size(); i++) {
+            keyword[i] = toupper(keyword[i]);
+        }
+        for (; *keywords; keywords++) {
+            if (keyword == *keywords) {
+                *result = keyword;
+                return 1;
+            }
+        }
+    }
+    Nan::ThrowTypeError((std::string(name) + " is not a valid value").c_str());
+    return -1;
+}
+
+const char* const journal_modes[] = {
+    "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF", NULL
+};
+
+const char* const synchronous_modes[] = {
+    "OFF", "NORMAL", "FULL", "EXTRA", NULL
+};
+
+}
+
+// { Number busyTimeout, Number pageSize, Number cacheSize, Number mmapSize,
+//   String journalMode, String synchronous, Number walAutocheckpoint }
+bool Database::ParseOpenOptions(Local<Object> source, OpenOptions& options) {
+    std::ostringstream pragmas;
+    int64_t number;
+    std::string keyword;
+    int found;
+
+    if ((found = GetIntegerOption(source, "busyTimeout", &number)) < 0) return false;
+    if (found) options.busy_timeout = number;
+
+    if ((found = GetIntegerOption(source, "walAutocheckpoint", &number)) < 0) return false;
+    if (found) options.wal_autocheckpoint = number < 0 ? 0 : number;
+
+    // page_size has to come before journal_mode; it can't be changed once the
+    // database is in WAL mode.
+    if ((found = GetIntegerOption(source, "pageSize", &number)) < 0) return false;
+    if (found) pragmas << "PRAGMA page_size = " << number << ";";
+
+    // Positive values are pages, negative values KiB.
+    if ((found = GetIntegerOption(source, "cacheSize", &number)) < 0) return false;
+    if (found) pragmas << "PRAGMA cache_size = " << number << ";";
+
+    if ((found = GetIntegerOption(source, "mmapSize", &number)) < 0) return false;
+    if (found) pragmas << "PRAGMA mmap_size = " << number << ";";
+
+    if ((found = GetKeywordOption(source, "journalMode", journal_modes, &keyword)) < 0) return false;
+    if (found) pragmas << "PRAGMA journal_mode = " << keyword << ";";
+
+    if ((found = GetKeywordOption(source, "synchronous", synchronous_modes, &keyword)) < 0) return false;
+    if (found) pragmas << "PRAGMA synchronous = " << keyword << ";";
+
+    options.pragmas = pragmas.str();
+    return true;
+}
+
 void Database::Work_BeginOpen(Baton* baton) {
     int status = uv_queue_work(baton->loop,
         &baton->request, Work_Open, (uv_after_work_cb)Work_AfterOpen);
@@ -199,8 +298,25 @@ void Database::Work_Open(uv_work_t* req) {
         db->_handle = NULL;
     }
     else {
-        // Set default database handle values.
-        sqlite3_busy_timeout(db->_handle, 1000);
+        const OpenOptions& options = baton->options;
+        sqlite3_busy_timeout(db->_handle, options.busy_timeout);
+        if (options.wal_autocheckpoint >= 0) {
+            sqlite3_wal_autocheckpoint(db->_handle, options.wal_autocheckpoint);
+        }
+
+        if (!options.pragmas.empty()) {
+            char* message = NULL;
+            baton->status = sqlite3_exec(db->_handle, options.pragmas.c_str(),
+                NULL, NULL, &message);
+
+            if (baton->status != SQLITE_OK) {
+                baton->message = std::string(message != NULL ?
+                    message : sqlite3_errmsg(db->_handle));
+                sqlite3_free(message);
+                sqlite3_close(db->_handle);
+                db->_handle = NULL;
+            }
+        }
     }
 }
 
@@ -617,6 +733,147 @@ void Database::Work_AfterExec(uv_work_t* req) {
     delete baton;
 }
 
+NAN_METHOD(Database::Checkpoint) {
+    Database* db = Nan::ObjectWrap::Unwrap<Database>(info.This());
+
+    int pos = 0;
+
+    int mode = SQLITE_CHECKPOINT_PASSIVE;
+    if (info.Length() > pos && info[pos]->IsInt32()) {
+        mode = Nan::To<int>(info[pos++]).FromJust();
+        if (mode < SQLITE_CHECKPOINT_PASSIVE || mode > SQLITE_CHECKPOINT_TRUNCATE) {
+            return Nan::ThrowRangeError("Invalid checkpoint mode");
+        }
+    }
+
+    Local<Function> callback;
+    if (info.Length() > pos && !info[pos]->IsUndefined()) {
+        if (!info[pos]->IsFunction()) {
+            return Nan::ThrowTypeError("Callback expected");
+        }
+        callback = Local<Function>::Cast(info[pos]);
+    }
+
+    Environment* env = Environment::GetCurrent(info.GetIsolate());
+
+    Baton* baton = new CheckpointBaton(db, callback, mode, env->event_loop());
+    db->Schedule(Work_BeginCheckpoint, baton, true);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+void Database::Work_BeginCheckpoint(Baton* baton) {
+    assert(baton->db->locked);
+    assert(baton->db->open);
+    assert(baton->db->_handle);
+    assert(baton->db->pending == 0);
+    int status = uv_queue_work(baton->loop,
+        &baton->request, Work_Checkpoint, (uv_after_work_cb)Work_AfterCheckpoint);
+    assert(status == 0);
+}
+
+void Database::Work_Checkpoint(uv_work_t* req) {
+    CheckpointBaton* baton = static_cast<CheckpointBaton*>(req->data);
+
+    sqlite3_mutex* mtx = sqlite3_db_mutex(baton->db->_handle);
+    sqlite3_mutex_enter(mtx);
+
+    baton->status = sqlite3_wal_checkpoint_v2(
+        baton->db->_handle,
+        NULL,
+        baton->mode,
+        &baton->log,
+        &baton->checkpointed
+    );
+
+    if (baton->status != SQLITE_OK) {
+        baton->message = std::string(sqlite3_errmsg(baton->db->_handle));
+    }
+
+    sqlite3_mutex_leave(mtx);
+}
+
+void Database::Work_AfterCheckpoint(uv_work_t* req) {
+    Nan::HandleScope scope;
+
+    CheckpointBaton* baton = static_cast<CheckpointBaton*>(req->data);
+    Database* db = baton->db;
+
+    Local<Function> cb = Nan::New(baton->callback);
+
+    if (baton->status != SQLITE_OK) {
+        EXCEPTION(Nan::New(baton->message.c_str()).ToLocalChecked(), baton->status, exception);
+
+        if (!cb.IsEmpty() && cb->IsFunction()) {
+            Local<Value> argv[] = { exception };
+            TRY_CATCH_CALL(db->handle(), cb, 1, argv);
+        }
+        else {
+            Local<Value> info[] = { Nan::New("error").ToLocalChecked(), exception };
+            EMIT_EVENT(db->handle(), 2, info);
+        }
+    }
+    else if (!cb.IsEmpty() && cb->IsFunction()) {
+        // Both counts are -1 when the database is not in WAL mode.
+        Local<Object> result = Nan::New<Object>();
+        Nan::Set(result, Nan::New("log").ToLocalChecked(), Nan::New(baton->log));
+        Nan::Set(result, Nan::New("checkpointed").ToLocalChecked(),
+            Nan::New(baton->checkpointed));
+
+        Local<Value> argv[] = { Nan::Null(), result };
+        TRY_CATCH_CALL(db->handle(), cb, 2, argv);
+    }
+
+    db->Process();
+
+    delete baton;
+}
+
+NAN_METHOD(Database::Stats) {
+    Database* db = Nan::ObjectWrap::Unwrap<Database>(info.This());
+
+    if (!db->open) {
+        return Nan::ThrowError("Database is not open");
+    }
+
+    if (db->closing) {
+        return Nan::ThrowError("Database is closing");
+    }
+
+    bool reset = info.Length() > 0 && Nan::To<bool>(info[0]).FromJust();
+
+    // The lookaside hit and miss counters are only reported as high-water
+    // marks; everything else is a current value.
+    static const struct {
+        int op;
+        const char* name;
+        bool highwater;
+    } counters[] = {
+        { SQLITE_DBSTATUS_CACHE_USED, "cacheUsed", false },
+        { SQLITE_DBSTATUS_CACHE_HIT, "cacheHit", false },
+        { SQLITE_DBSTATUS_CACHE_MISS, "cacheMiss", false },
+        { SQLITE_DBSTATUS_CACHE_WRITE, "cacheWrite", false },
+        { SQLITE_DBSTATUS_SCHEMA_USED, "schemaUsed", false },
+        { SQLITE_DBSTATUS_STMT_USED, "stmtUsed", false },
+        { SQLITE_DBSTATUS_LOOKASIDE_USED, "lookasideUsed", false },
+        { SQLITE_DBSTATUS_LOOKASIDE_HIT, "lookasideHit", true },
+        { SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE, "lookasideMissSize", true },
+        { SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL, "lookasideMissFull", true },
+        { SQLITE_DBSTATUS_DEFERRED_FKS, "deferredForeignKeys", false },
+    };
+
+    Local<Object> result = Nan::New<Object>();
+    for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++) {
+        int current = 0;
+        int highwater = 0;
+        sqlite3_db_status(db->_handle, counters[i].op, &current, &highwater, reset);
+        Nan::Set(result, Nan::New(counters[i].name).ToLocalChecked(),
+            Nan::New(counters[i].highwater ? highwater : current));
+    }
+
+    info.GetReturnValue().Set(result);
+}
+
 NAN_METHOD(Database::Wait) {
     Database* db = Nan::ObjectWrap::Unwrap<Database>(info.This());
     Environment* env = Environment::GetCurrent(info.GetIsolate());
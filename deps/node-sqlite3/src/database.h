@@ -54,9 +54,18 @@ public:
         }
     };
 
+    // Connection settings applied by Work_Open once the handle is open.
+    struct OpenOptions {
+        OpenOptions() : busy_timeout(1000), wal_autocheckpoint(-1) {}
+        int busy_timeout;
+        int wal_autocheckpoint;
+        std::string pragmas;
+    };
+
     struct OpenBaton : Baton {
         std::string filename;
         int mode;
+        OpenOptions options;
         OpenBaton(Database* db_, Local<Function> cb_, const char* filename_, int mode_, uv_loop_t* loop_) :
             Baton(db_, cb_, loop_), filename(filename_), mode(mode_) {}
     };
@@ -73,6 +82,14 @@ public:
             Baton(db_, cb_, loop_), filename(filename_) {}
     };
 
+    struct CheckpointBaton : Baton {
+        int mode;
+        int log;
+        int checkpointed;
+        CheckpointBaton(Database* db_, Local<Function> cb_, int mode_, uv_loop_t* loop_) :
+            Baton(db_, cb_, loop_), mode(mode_), log(-1), checkpointed(-1) {}
+    };
+
     typedef void (*Work_Callback)(Baton* baton);
 
     struct Call {
@@ -95,6 +112,8 @@ public:
         sqlite3_int64 rowid;
     };
 
+    static std::string ResolveFilename(node::Environment* env, Local<Value> filename);
+
     bool IsOpen() { return open; }
     bool IsLocked() { return locked; }
 
@@ -103,6 +122,7 @@ public:
     typedef Async<UpdateInfo, Database> AsyncUpdate;
 
     friend class Statement;
+    friend class Blob;
 
 protected:
     Database() : Nan::ObjectWrap(),
@@ -129,6 +149,8 @@ protected:
     static void Work_Open(uv_work_t* req);
     static void Work_AfterOpen(uv_work_t* req);
 
+    static bool ParseOpenOptions(Local<Object> source, OpenOptions& options);
+
     static NAN_GETTER(OpenGetter);
 
     void Schedule(Work_Callback callback, Baton* baton, bool exclusive = false);
@@ -152,6 +174,13 @@ protected:
     static void Work_LoadExtension(uv_work_t* req);
     static void Work_AfterLoadExtension(uv_work_t* req);
 
+    static NAN_METHOD(Checkpoint);
+    static void Work_BeginCheckpoint(Baton* baton);
+    static void Work_Checkpoint(uv_work_t* req);
+    static void Work_AfterCheckpoint(uv_work_t* req);
+
+    static NAN_METHOD(Stats);
+
     static NAN_METHOD(Serialize);
     static NAN_METHOD(Parallelize);
 
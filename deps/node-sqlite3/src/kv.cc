@@ -0,0 +1,616 @@
+#include <string.h>
+#include <ctype.h>
+#include <node.h>
+#include <node_buffer.h>
+#include <node_version.h>
+
+#include "macros.h"
+#include "database.h"
+#include "kv.h"
+#include "env.h"
+#include "env-inl.h"
+
+using namespace node_sqlite3;
+
+NAN_MODULE_INIT(KeyValueStore::Init) {
+    Nan::HandleScope scope;
+
+    Local<FunctionTemplate> t = Nan::New<FunctionTemplate>(New);
+
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(Nan::New("KeyValueStore").ToLocalChecked());
+
+    Nan::SetPrototypeMethod(t, "peek", Peek);
+    Nan::SetPrototypeMethod(t, "fetch", Fetch);
+    Nan::SetPrototypeMethod(t, "put", Put);
+    Nan::SetPrototypeMethod(t, "del", Del);
+    Nan::SetPrototypeMethod(t, "range", Range);
+    Nan::SetPrototypeMethod(t, "flush", Flush);
+    Nan::SetPrototypeMethod(t, "close", Close);
+
+    Nan::Set(target, Nan::New("KeyValueStore").ToLocalChecked(),
+        Nan::GetFunction(t).ToLocalChecked());
+}
+
+// { String filename, Object options, Function callback }
+NAN_METHOD(KeyValueStore::New) {
+    if (!info.IsConstructCall()) {
+        return Nan::ThrowTypeError("Use the new operator to create new KeyValueStore objects");
+    }
+
+    REQUIRE_ARGUMENT_STRING(0, filename);
+
+    int pos = 1;
+    std::string table("kv");
+    size_t capacity = 1000;
+
+    if (info.Length() > pos && info[pos]->IsObject() && !info[pos]->IsFunction()) {
+        Local<Object> options = info[pos++].As<Object>();
+
+        Local<Value> value = Nan::Get(options, Nan::New("table").ToLocalChecked()).ToLocalChecked();
+        if (!value->IsUndefined()) {
+            Nan::Utf8String name(value);
+            bool valid = value->IsString() && name.length() > 0 && !isdigit((*name)[0]);
+            for (int i = 0; valid && i < name.length(); i++) {
+                valid = isalnum((*name)[i]) || (*name)[i] == '_';
+            }
+            if (!valid) {
+                return Nan::ThrowTypeError("table must be a valid identifier");
+            }
+            table = *name;
+        }
+
+        value = Nan::Get(options, Nan::New("cacheSize").ToLocalChecked()).ToLocalChecked();
+        if (!value->IsUndefined()) {
+            if (!value->IsUint32()) {
+                return Nan::ThrowTypeError("cacheSize must be a non-negative integer");
+            }
+            capacity = Nan::To<uint32_t>(value).FromJust();
+        }
+    }
+
+    Local<Function> callback;
+    if (info.Length() > pos && info[pos]->IsFunction()) {
+        callback = Local<Function>::Cast(info[pos]);
+    }
+
+    Environment* env = Environment::GetCurrent(info.GetIsolate());
+
+    KeyValueStore* store = new KeyValueStore(env->event_loop(), table, capacity);
+    store->Wrap(info.This());
+
+    info.This()->DefineOwnProperty(info.GetIsolate()->GetCurrentContext(),
+        Nan::New("filename").ToLocalChecked(), info[0].As<String>(), ReadOnly);
+
+    Op* op = new Op(Op::OPEN, callback);
+    op->key = Database::ResolveFilename(env, info[0]);
+    store->Schedule(op);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+void KeyValueStore::Schedule(Op* op) {
+    if (closed) {
+        op->status = SQLITE_MISUSE;
+        op->message = "Store is closed";
+        Error(op);
+        delete op;
+        return;
+    }
+
+    queue.push_back(op);
+    Process();
+}
+
+void KeyValueStore::Process() {
+    if (busy || queue.empty()) {
+        return;
+    }
+
+    // Everything queued so far goes into one batch, except that opening and
+    // closing always run on their own.
+    Batch* batch = new Batch(this);
+    while (!queue.empty()) {
+        Op* op = queue.front();
+        bool alone = op->type == Op::OPEN || op->type == Op::CLOSE;
+        if (alone && !batch->ops.empty()) break;
+
+        queue.pop_front();
+        batch->ops.push_back(op);
+        if (alone) break;
+    }
+
+    busy = true;
+    int status = uv_queue_work(loop,
+        &batch->request, Work_Batch, (uv_after_work_cb)Work_AfterBatch);
+    assert(status == 0);
+}
+
+void KeyValueStore::Open(Op* op) {
+    // Only one batch runs at a time, so the connection is never shared
+    // between threads and doesn't need SQLite's mutex.
+    op->status = sqlite3_open_v2(
+        op->key.c_str(),
+        &_handle,
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+        NULL
+    );
+
+    if (op->status == SQLITE_OK) {
+        sqlite3_busy_timeout(_handle, 1000);
+
+        std::string name = "\"" + table + "\"";
+        std::string create = "CREATE TABLE IF NOT EXISTS " + name +
+            " (key TEXT PRIMARY KEY NOT NULL, value) WITHOUT ROWID";
+        std::string get = "SELECT value FROM " + name + " WHERE key = ?1";
+        std::string put = "INSERT OR REPLACE INTO " + name +
+            " (key, value) VALUES (?1, ?2)";
+        std::string del = "DELETE FROM " + name + " WHERE key = ?1";
+        std::string range = "SELECT key, value FROM " + name +
+            " WHERE key >= ?1 AND key < ?2 ORDER BY key LIMIT ?3";
+
+        op->status = sqlite3_exec(_handle, create.c_str(), NULL, NULL, NULL);
+        if (op->status == SQLITE_OK) {
+            op->status = sqlite3_prepare_v2(_handle, get.c_str(), -1, &get_stmt, NULL);
+        }
+        if (op->status == SQLITE_OK) {
+            op->status = sqlite3_prepare_v2(_handle, put.c_str(), -1, &put_stmt, NULL);
+        }
+        if (op->status == SQLITE_OK) {
+            op->status = sqlite3_prepare_v2(_handle, del.c_str(), -1, &del_stmt, NULL);
+        }
+        if (op->status == SQLITE_OK) {
+            op->status = sqlite3_prepare_v2(_handle, range.c_str(), -1, &range_stmt, NULL);
+        }
+    }
+
+    if (op->status != SQLITE_OK) {
+        op->message = std::string(sqlite3_errmsg(_handle));
+        Finalize();
+        sqlite3_close(_handle);
+        _handle = NULL;
+    }
+}
+
+void KeyValueStore::Finalize() {
+    sqlite3_finalize(get_stmt);
+    sqlite3_finalize(put_stmt);
+    sqlite3_finalize(del_stmt);
+    sqlite3_finalize(range_stmt);
+    get_stmt = put_stmt = del_stmt = range_stmt = NULL;
+}
+
+// Steps a statement that doesn't return rows and resets it for the next use.
+void KeyValueStore::Execute(sqlite3_stmt* stmt, Op* op) {
+    op->status = sqlite3_step(stmt);
+    if (op->status == SQLITE_DONE) {
+        op->status = SQLITE_OK;
+    }
+    else {
+        op->message = std::string(sqlite3_errmsg(_handle));
+    }
+    sqlite3_reset(stmt);
+}
+
+void KeyValueStore::ReadItem(sqlite3_stmt* stmt, int column, Item* item) {
+    item->type = sqlite3_column_type(stmt, column);
+    switch (item->type) {
+        case SQLITE_BLOB: {
+            const char* data = (const char*)sqlite3_column_blob(stmt, column);
+            int length = sqlite3_column_bytes(stmt, column);
+            item->data.assign(data ? data : "", length);
+        } break;
+        case SQLITE_NULL: {
+            item->data.clear();
+        } break;
+        default: {
+            // Numbers written by other clients come back as text.
+            const char* data = (const char*)sqlite3_column_text(stmt, column);
+            int length = sqlite3_column_bytes(stmt, column);
+            item->type = SQLITE_TEXT;
+            item->data.assign(data, length);
+        } break;
+    }
+}
+
+void KeyValueStore::Work_Batch(uv_work_t* req) {
+    Batch* batch = static_cast<Batch*>(req->data);
+    KeyValueStore* store = batch->store;
+
+    bool transaction = false;
+    int failed = SQLITE_OK;
+    std::string failure;
+
+    for (size_t i = 0; i < batch->ops.size(); i++) {
+        Op* op = batch->ops[i];
+
+        if (op->type == Op::OPEN) {
+            store->Open(op);
+            continue;
+        }
+        else if (op->type == Op::CLOSE) {
+            store->Finalize();
+            op->status = sqlite3_close(store->_handle);
+            if (op->status != SQLITE_OK) {
+                op->message = std::string(sqlite3_errmsg(store->_handle));
+            }
+            else {
+                store->_handle = NULL;
+            }
+            continue;
+        }
+        else if (store->_handle == NULL) {
+            op->status = SQLITE_MISUSE;
+            op->message = "Store is not open";
+            continue;
+        }
+
+        switch (op->type) {
+            case Op::PUT:
+            case Op::DEL: {
+                if (!transaction) {
+                    // Take the write lock up front rather than failing to
+                    // upgrade halfway through the batch.
+                    failed = sqlite3_exec(store->_handle, "BEGIN IMMEDIATE", NULL, NULL, NULL);
+                    if (failed != SQLITE_OK) {
+                        failure = std::string(sqlite3_errmsg(store->_handle));
+                    }
+                    transaction = true;
+                }
+                if (failed != SQLITE_OK) break;
+
+                sqlite3_stmt* stmt = op->type == Op::PUT ? store->put_stmt : store->del_stmt;
+                sqlite3_bind_text(stmt, 1, op->key.data(), op->key.size(), SQLITE_STATIC);
+                if (op->type == Op::PUT) {
+                    if (op->value.type == SQLITE_BLOB) {
+                        sqlite3_bind_blob(stmt, 2, op->value.data.data(),
+                            op->value.data.size(), SQLITE_STATIC);
+                    }
+                    else {
+                        sqlite3_bind_text(stmt, 2, op->value.data.data(),
+                            op->value.data.size(), SQLITE_STATIC);
+                    }
+                }
+                store->Execute(stmt, op);
+                sqlite3_clear_bindings(stmt);
+
+                if (op->status != SQLITE_OK) {
+                    failed = op->status;
+                    failure = op->message;
+                }
+            } break;
+
+            case Op::GET: {
+                sqlite3_stmt* stmt = store->get_stmt;
+                sqlite3_bind_text(stmt, 1, op->key.data(), op->key.size(), SQLITE_STATIC);
+                op->status = sqlite3_step(stmt);
+                if (op->status == SQLITE_ROW) {
+                    ReadItem(stmt, 0, &op->value);
+                    op->status = SQLITE_OK;
+                }
+                else if (op->status == SQLITE_DONE) {
+                    op->status = SQLITE_OK;
+                }
+                else {
+                    op->message = std::string(sqlite3_errmsg(store->_handle));
+                }
+                sqlite3_reset(stmt);
+                sqlite3_clear_bindings(stmt);
+            } break;
+
+            case Op::RANGE: {
+                sqlite3_stmt* stmt = store->range_stmt;
+                sqlite3_bind_text(stmt, 1, op->key.data(), op->key.size(), SQLITE_STATIC);
+                sqlite3_bind_text(stmt, 2, op->end.data(), op->end.size(), SQLITE_STATIC);
+                sqlite3_bind_int(stmt, 3, op->limit);
+                while ((op->status = sqlite3_step(stmt)) == SQLITE_ROW) {
+                    const char* key = (const char*)sqlite3_column_text(stmt, 0);
+                    op->rows.push_back(std::make_pair(
+                        std::string(key, sqlite3_column_bytes(stmt, 0)), Item()));
+                    ReadItem(stmt, 1, &op->rows.back().second);
+                }
+                if (op->status == SQLITE_DONE) {
+                    op->status = SQLITE_OK;
+                }
+                else {
+                    op->message = std::string(sqlite3_errmsg(store->_handle));
+                }
+                sqlite3_reset(stmt);
+                sqlite3_clear_bindings(stmt);
+            } break;
+
+            default:
+                break;
+        }
+    }
+
+    if (transaction) {
+        if (failed == SQLITE_OK) {
+            failed = sqlite3_exec(store->_handle, "COMMIT", NULL, NULL, NULL);
+            if (failed != SQLITE_OK) {
+                failure = std::string(sqlite3_errmsg(store->_handle));
+            }
+        }
+        if (failed != SQLITE_OK) {
+            // None of the writes in the batch made it to disk.
+            sqlite3_exec(store->_handle, "ROLLBACK", NULL, NULL, NULL);
+            for (size_t i = 0; i < batch->ops.size(); i++) {
+                Op* op = batch->ops[i];
+                if (op->type == Op::PUT || op->type == Op::DEL) {
+                    op->status = failed;
+                    op->message = failure;
+                }
+            }
+        }
+    }
+}
+
+void KeyValueStore::Work_AfterBatch(uv_work_t* req) {
+    Nan::HandleScope scope;
+
+    Batch* batch = static_cast<Batch*>(req->data);
+    KeyValueStore* store = batch->store;
+
+    store->busy = false;
+
+    // Bring the cache up to date before any callback can look at it.
+    for (size_t i = 0; i < batch->ops.size(); i++) {
+        Op* op = batch->ops[i];
+        if (op->type == Op::PUT || op->type == Op::DEL) {
+            LRU::iterator entry = store->index[op->key];
+            if (--entry->dirty == 0 && op->status != SQLITE_OK) {
+                // The cached value was never written.
+                store->lru.erase(entry);
+                store->index.erase(op->key);
+            }
+        }
+        else if (op->type == Op::GET && op->status == SQLITE_OK &&
+                store->index.find(op->key) == store->index.end()) {
+            // Anything already cached was written after this read was queued.
+            store->Store(op->key, op->value);
+        }
+    }
+    store->Trim();
+
+    for (size_t i = 0; i < batch->ops.size(); i++) {
+        Op* op = batch->ops[i];
+
+        if (op->status != SQLITE_OK) {
+            store->Error(op);
+            continue;
+        }
+
+        Local<Function> cb = Nan::New(op->callback);
+        if (!cb.IsEmpty() && cb->IsFunction()) {
+            if (op->type == Op::GET) {
+                Local<Value> argv[] = { Nan::Null(), ToJS(op->value) };
+                TRY_CATCH_CALL(store->handle(), cb, 2, argv);
+            }
+            else if (op->type == Op::RANGE) {
+                Local<Array> rows = Nan::New<Array>(op->rows.size());
+                for (size_t j = 0; j < op->rows.size(); j++) {
+                    Local<Object> row = Nan::New<Object>();
+                    Nan::Set(row, Nan::New("key").ToLocalChecked(),
+                        Nan::New(op->rows[j].first).ToLocalChecked());
+                    Nan::Set(row, Nan::New("value").ToLocalChecked(),
+                        ToJS(op->rows[j].second));
+                    Nan::Set(rows, j, row);
+                }
+                Local<Value> argv[] = { Nan::Null(), rows };
+                TRY_CATCH_CALL(store->handle(), cb, 2, argv);
+            }
+            else {
+                Local<Value> argv[] = { Nan::Null() };
+                TRY_CATCH_CALL(store->handle(), cb, 1, argv);
+            }
+        }
+
+        if (op->type == Op::OPEN || op->type == Op::CLOSE) {
+            Local<Value> argv[] = {
+                Nan::New(op->type == Op::OPEN ? "open" : "close").ToLocalChecked()
+            };
+            EMIT_EVENT(store->handle(), 1, argv);
+        }
+    }
+
+    store->Process();
+
+    delete batch;
+}
+
+void KeyValueStore::Error(Op* op) {
+    Nan::HandleScope scope;
+
+    EXCEPTION(Nan::New(op->message.c_str()).ToLocalChecked(), op->status, exception);
+
+    Local<Function> cb = Nan::New(op->callback);
+
+    if (!cb.IsEmpty() && cb->IsFunction()) {
+        Local<Value> argv[] = { exception };
+        TRY_CATCH_CALL(handle(), cb, 1, argv);
+    }
+    else {
+        Local<Value> argv[] = { Nan::New("error").ToLocalChecked(), exception };
+        EMIT_EVENT(handle(), 2, argv);
+    }
+}
+
+KeyValueStore::Entry* KeyValueStore::Lookup(const std::string& key) {
+    std::unordered_map<std::string, LRU::iterator>::iterator it = index.find(key);
+    if (it == index.end()) return NULL;
+    lru.splice(lru.begin(), lru, it->second);
+    return &*it->second;
+}
+
+KeyValueStore::Entry* KeyValueStore::Store(const std::string& key, const Item& item) {
+    Entry* entry = Lookup(key);
+    if (entry == NULL) {
+        Entry fresh;
+        fresh.key = key;
+        fresh.dirty = 0;
+        lru.push_front(fresh);
+        index[key] = lru.begin();
+        entry = &lru.front();
+    }
+    entry->value = item;
+    return entry;
+}
+
+void KeyValueStore::Trim() {
+    LRU::iterator it = lru.end();
+    while (index.size() > capacity && it != lru.begin()) {
+        --it;
+        if (it->dirty) continue;
+        index.erase(it->key);
+        it = lru.erase(it);
+    }
+}
+
+Local<Value> KeyValueStore::ToJS(const Item& item) {
+    Nan::EscapableHandleScope scope;
+
+    Local<Value> value;
+    if (item.type == SQLITE_BLOB) {
+        value = Nan::CopyBuffer(item.data.data(), item.data.size()).ToLocalChecked();
+    }
+    else if (item.type == SQLITE_TEXT) {
+        value = Nan::New<String>(item.data.data(), item.data.size()).ToLocalChecked();
+    }
+    else {
+        value = Nan::Undefined();
+    }
+
+    return scope.Escape(value);
+}
+
+// Returns the cached value without touching the database: undefined when the
+// key isn't cached, null when it is known not to exist.
+NAN_METHOD(KeyValueStore::Peek) {
+    KeyValueStore* store = Nan::ObjectWrap::Unwrap<KeyValueStore>(info.This());
+
+    REQUIRE_ARGUMENT_STRING(0, key);
+
+    Entry* entry = store->Lookup(std::string(*key, key.length()));
+    if (entry == NULL) {
+        return;
+    }
+    else if (entry->value.type == SQLITE_NULL) {
+        info.GetReturnValue().SetNull();
+    }
+    else {
+        info.GetReturnValue().Set(ToJS(entry->value));
+    }
+}
+
+NAN_METHOD(KeyValueStore::Fetch) {
+    KeyValueStore* store = Nan::ObjectWrap::Unwrap<KeyValueStore>(info.This());
+
+    REQUIRE_ARGUMENT_STRING(0, key);
+    OPTIONAL_ARGUMENT_FUNCTION(1, callback);
+
+    Op* op = new Op(Op::GET, callback);
+    op->key.assign(*key, key.length());
+    store->Schedule(op);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+NAN_METHOD(KeyValueStore::Put) {
+    KeyValueStore* store = Nan::ObjectWrap::Unwrap<KeyValueStore>(info.This());
+
+    REQUIRE_ARGUMENT_STRING(0, key);
+    OPTIONAL_ARGUMENT_FUNCTION(2, callback);
+
+    Op* op = new Op(Op::PUT, callback);
+    op->key.assign(*key, key.length());
+
+    if (info.Length() > 1 && Buffer::HasInstance(info[1])) {
+        Local<Object> buffer = info[1].As<Object>();
+        op->value.type = SQLITE_BLOB;
+        op->value.data.assign(Buffer::Data(buffer), Buffer::Length(buffer));
+    }
+    else if (info.Length() > 1 && info[1]->IsString()) {
+        Nan::Utf8String text(info[1]);
+        op->value.type = SQLITE_TEXT;
+        op->value.data.assign(*text, text.length());
+    }
+    else {
+        delete op;
+        return Nan::ThrowTypeError("Value must be a string or Buffer");
+    }
+
+    if (!store->closed) {
+        store->Store(op->key, op->value)->dirty++;
+        store->Trim();
+    }
+    store->Schedule(op);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+NAN_METHOD(KeyValueStore::Del) {
+    KeyValueStore* store = Nan::ObjectWrap::Unwrap<KeyValueStore>(info.This());
+
+    REQUIRE_ARGUMENT_STRING(0, key);
+    OPTIONAL_ARGUMENT_FUNCTION(1, callback);
+
+    Op* op = new Op(Op::DEL, callback);
+    op->key.assign(*key, key.length());
+
+    if (!store->closed) {
+        store->Store(op->key, op->value)->dirty++;
+        store->Trim();
+    }
+    store->Schedule(op);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+// { String start, String end, [Number limit], Function callback }
+NAN_METHOD(KeyValueStore::Range) {
+    KeyValueStore* store = Nan::ObjectWrap::Unwrap<KeyValueStore>(info.This());
+
+    REQUIRE_ARGUMENT_STRING(0, start);
+    REQUIRE_ARGUMENT_STRING(1, end);
+
+    int pos = 2;
+    int limit = -1;
+    if (info.Length() > pos && info[pos]->IsInt32()) {
+        limit = Nan::To<int32_t>(info[pos++]).FromJust();
+    }
+
+    Local<Function> callback;
+    if (info.Length() > pos && !info[pos]->IsUndefined()) {
+        if (!info[pos]->IsFunction()) {
+            return Nan::ThrowTypeError("Callback expected");
+        }
+        callback = Local<Function>::Cast(info[pos]);
+    }
+
+    Op* op = new Op(Op::RANGE, callback);
+    op->key.assign(*start, start.length());
+    op->end.assign(*end, end.length());
+    op->limit = limit;
+    store->Schedule(op);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+NAN_METHOD(KeyValueStore::Flush) {
+    KeyValueStore* store = Nan::ObjectWrap::Unwrap<KeyValueStore>(info.This());
+    OPTIONAL_ARGUMENT_FUNCTION(0, callback);
+
+    store->Schedule(new Op(Op::FLUSH, callback));
+
+    info.GetReturnValue().Set(info.This());
+}
+
+NAN_METHOD(KeyValueStore::Close) {
+    KeyValueStore* store = Nan::ObjectWrap::Unwrap<KeyValueStore>(info.This());
+    OPTIONAL_ARGUMENT_FUNCTION(0, callback);
+
+    store->Schedule(new Op(Op::CLOSE, callback));
+    store->closed = true;
+
+    info.GetReturnValue().Set(info.This());
+}
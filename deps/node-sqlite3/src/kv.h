@@ -0,0 +1,164 @@
+#ifndef NODE_SQLITE3_SRC_KV_H
+#define NODE_SQLITE3_SRC_KV_H
+
+
+#include <string>
+#include <list>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+#include <sqlite3.h>
+#include <nan.h>
+
+#include "database.h"
+
+using namespace v8;
+using namespace node;
+
+namespace node_sqlite3 {
+
+// Key-value store on its own connection, backed by a WITHOUT ROWID table.
+//
+// Recently used values are kept in an LRU cache that can be read
+// synchronously with peek(). Writes go into the cache right away and are
+// flushed from the thread pool, with everything that queued up while the
+// previous batch ran committed in a single transaction. Values are strings
+// (TEXT) or Buffers (BLOB).
+class KeyValueStore : public Nan::ObjectWrap {
+public:
+    static NAN_MODULE_INIT(Init);
+
+    // A stored value; SQLITE_NULL means the key does not exist.
+    struct Item {
+        Item() : type(SQLITE_NULL) {}
+        int type;
+        std::string data;
+    };
+
+    struct Op {
+        enum Type { OPEN, GET, PUT, DEL, RANGE, FLUSH, CLOSE };
+
+        Op(Type type_, Local<Function> cb_) :
+                type(type_), limit(-1), status(SQLITE_OK) {
+            callback.Reset(cb_);
+        }
+        ~Op() {
+            callback.Reset();
+        }
+
+        Type type;
+        // OPEN: file name; GET, PUT, DEL: key; RANGE: lower bound.
+        std::string key;
+        // RANGE: upper bound (exclusive).
+        std::string end;
+        int limit;
+        // PUT: value to store; GET: value read.
+        Item value;
+        // RANGE: rows read.
+        std::vector<std::pair<std::string, Item> > rows;
+        int status;
+        std::string message;
+        Nan::Persistent<Function> callback;
+    };
+
+    struct Batch {
+        uv_work_t request;
+        KeyValueStore* store;
+        std::vector<Op*> ops;
+
+        Batch(KeyValueStore* store_) : store(store_) {
+            store->Ref();
+            request.data = this;
+        }
+        ~Batch() {
+            for (size_t i = 0; i < ops.size(); i++) delete ops[i];
+            store->Unref();
+        }
+    };
+
+    struct Entry {
+        std::string key;
+        Item value;
+        // Writes not yet committed; dirty entries are never evicted.
+        int dirty;
+    };
+
+    typedef std::list<Entry> LRU;
+
+    KeyValueStore(uv_loop_t* loop_, const std::string& table_, size_t capacity_) :
+            Nan::ObjectWrap(),
+            loop(loop_),
+            table(table_),
+            capacity(capacity_),
+            _handle(NULL),
+            get_stmt(NULL),
+            put_stmt(NULL),
+            del_stmt(NULL),
+            range_stmt(NULL),
+            busy(false),
+            closed(false) {
+    }
+
+    ~KeyValueStore() {
+        while (!queue.empty()) {
+            delete queue.front();
+            queue.pop_front();
+        }
+        Finalize();
+        sqlite3_close(_handle);
+        _handle = NULL;
+    }
+
+protected:
+    static NAN_METHOD(New);
+    static NAN_METHOD(Peek);
+    static NAN_METHOD(Fetch);
+    static NAN_METHOD(Put);
+    static NAN_METHOD(Del);
+    static NAN_METHOD(Range);
+    static NAN_METHOD(Flush);
+    static NAN_METHOD(Close);
+
+    static void Work_Batch(uv_work_t* req);
+    static void Work_AfterBatch(uv_work_t* req);
+
+    void Schedule(Op* op);
+    void Process();
+
+    void Open(Op* op);
+    void Finalize();
+    void Execute(sqlite3_stmt* stmt, Op* op);
+    static void ReadItem(sqlite3_stmt* stmt, int column, Item* item);
+
+    Entry* Lookup(const std::string& key);
+    Entry* Store(const std::string& key, const Item& item);
+    void Trim();
+
+    static Local<Value> ToJS(const Item& item);
+    void Error(Op* op);
+
+protected:
+    uv_loop_t* loop;
+    std::string table;
+    size_t capacity;
+
+    sqlite3* _handle;
+    sqlite3_stmt* get_stmt;
+    sqlite3_stmt* put_stmt;
+    sqlite3_stmt* del_stmt;
+    sqlite3_stmt* range_stmt;
+
+    // Operations wait here, in order, until the previous batch is done.
+    std::deque<Op*> queue;
+    bool busy;
+    bool closed;
+
+    LRU lru;
+    std::unordered_map<std::string, LRU::iterator> index;
+};
+
+}
+
+#endif
@@ -140,6 +140,32 @@ const char* sqlite_authorizer_string(int type);
     stmt->db->Process();                                                       \
     delete baton;
 
+#define BLOB_BEGIN(type)                                                       \
+    assert(baton);                                                             \
+    assert(baton->blob);                                                       \
+    assert(!baton->blob->locked);                                              \
+    assert(!baton->blob->closed);                                              \
+    assert(baton->blob->opened);                                               \
+    baton->blob->locked = true;                                                \
+    baton->blob->db->pending++;                                                \
+    int status = uv_queue_work(baton->loop,                                    \
+        &baton->request,                                                       \
+        Work_##type, reinterpret_cast<uv_after_work_cb>(Work_After##type));    \
+    assert(status == 0);
+
+#define BLOB_INIT(type)                                                        \
+    type* baton = static_cast<type*>(req->data);                               \
+    Blob* blob = baton->blob;
+
+#define BLOB_END()                                                             \
+    assert(blob->locked);                                                      \
+    assert(blob->db->pending);                                                 \
+    blob->locked = false;                                                      \
+    blob->db->pending--;                                                       \
+    blob->Process();                                                           \
+    blob->db->Process();                                                       \
+    delete baton;
+
 #define DELETE_FIELD(field)                                                    \
     if (field != NULL) {                                                       \
         switch ((field)->type) {                                               \
@@ -7,6 +7,8 @@
 #include "macros.h"
 #include "database.h"
 #include "statement.h"
+#include "blob.h"
+#include "kv.h"
 
 using namespace node_sqlite3;
 
@@ -17,10 +19,16 @@ NAN_MODULE_INIT(RegisterModule) {
 
     Database::Init(target);
     Statement::Init(target);
+    Blob::Init(target);
+    KeyValueStore::Init(target);
 
     DEFINE_CONSTANT_INTEGER(target, SQLITE_OPEN_READONLY, OPEN_READONLY);
     DEFINE_CONSTANT_INTEGER(target, SQLITE_OPEN_READWRITE, OPEN_READWRITE);
     DEFINE_CONSTANT_INTEGER(target, SQLITE_OPEN_CREATE, OPEN_CREATE);
+    DEFINE_CONSTANT_INTEGER(target, SQLITE_CHECKPOINT_PASSIVE, CHECKPOINT_PASSIVE);
+    DEFINE_CONSTANT_INTEGER(target, SQLITE_CHECKPOINT_FULL, CHECKPOINT_FULL);
+    DEFINE_CONSTANT_INTEGER(target, SQLITE_CHECKPOINT_RESTART, CHECKPOINT_RESTART);
+    DEFINE_CONSTANT_INTEGER(target, SQLITE_CHECKPOINT_TRUNCATE, CHECKPOINT_TRUNCATE);
     DEFINE_CONSTANT_STRING(target, SQLITE_VERSION, VERSION);
 #ifdef SQLITE_SOURCE_ID
     DEFINE_CONSTANT_STRING(target, SQLITE_SOURCE_ID, SOURCE_ID);
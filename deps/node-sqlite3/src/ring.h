@@ -0,0 +1,114 @@
+#ifndef NODE_SQLITE3_SRC_RING_H
+#define NODE_SQLITE3_SRC_RING_H
+
+#include "threading.h"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+
+// Bounded lock-free queue between exactly one producer thread and one
+// consumer thread. The capacity is rounded up to a power of two.
+template <class T> class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : head(0), tail(0) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // Producer only. Returns false when the buffer is full.
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when the buffer is empty.
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask;
+
+    // Keep the indices on separate cache lines so the producer and consumer
+    // don't keep invalidating each other's line.
+    char pad0[64];
+    std::atomic<size_t> head;
+    char pad1[64];
+    std::atomic<size_t> tail;
+    char pad2[64];
+};
+
+
+// Hands items from a worker thread to the loop thread. The common case goes
+// through a RingBuffer without locking. The producer never waits for the
+// consumer: when the ring is full, items spill into a locked overflow list,
+// and keep going there until the consumer has caught up so that they are
+// delivered in order.
+template <class T> class HandoffQueue {
+public:
+    explicit HandoffQueue(size_t capacity) : ring(capacity), overflowed(false) {
+        NODE_SQLITE3_MUTEX_INIT
+    }
+
+    ~HandoffQueue() {
+        NODE_SQLITE3_MUTEX_DESTROY
+    }
+
+    // Producer only.
+    void push(const T& item) {
+        if (overflowed.load() || !ring.push(item)) {
+            NODE_SQLITE3_MUTEX_LOCK(&mutex)
+            overflow.push_back(item);
+            overflowed.store(true);
+            NODE_SQLITE3_MUTEX_UNLOCK(&mutex)
+        }
+    }
+
+    // Consumer only. Returns false when there is nothing left.
+    bool pop(T& item) {
+        if (!spilled.empty()) {
+            item = spilled.front();
+            spilled.pop_front();
+            return true;
+        }
+        if (ring.pop(item)) return true;
+        if (!overflowed.load()) return false;
+
+        NODE_SQLITE3_MUTEX_LOCK(&mutex)
+        // The producer doesn't touch the ring while overflowed is set, so
+        // anything still in it predates the overflow items.
+        bool found = ring.pop(item);
+        if (!found) {
+            spilled.assign(overflow.begin(), overflow.end());
+            overflow.clear();
+            overflowed.store(false);
+        }
+        NODE_SQLITE3_MUTEX_UNLOCK(&mutex)
+
+        return found || pop(item);
+    }
+
+private:
+    RingBuffer<T> ring;
+    NODE_SQLITE3_MUTEX_t
+    std::vector<T> overflow;
+    std::atomic<bool> overflowed;
+    // Overflow items taken over by the consumer; always older than the
+    // contents of the ring.
+    std::deque<T> spilled;
+};
+
+#endif
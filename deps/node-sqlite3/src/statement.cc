@@ -8,9 +8,35 @@
 #include "statement.h"
 #include "env.h"
 #include "env-inl.h"
+#include "string_bytes_simd.h"
 
 using namespace node_sqlite3;
 
+namespace {
+
+// Backs a V8 external one-byte string with a TEXT value read by GetRow.
+class ExternalText : public String::ExternalOneByteStringResource {
+public:
+    ExternalText(Isolate* isolate, char* data, size_t length) :
+            isolate_(isolate), data_(data), length_(length) {
+        isolate_->AdjustAmountOfExternalAllocatedMemory(length_);
+    }
+    ~ExternalText() {
+        free(data_);
+        isolate_->AdjustAmountOfExternalAllocatedMemory(
+            -static_cast<int64_t>(length_));
+    }
+    const char* data() const { return data_; }
+    size_t length() const { return length_; }
+
+private:
+    Isolate* isolate_;
+    char* data_;
+    size_t length_;
+};
+
+}
+
 NAN_MODULE_INIT(Statement::Init) {
     Nan::HandleScope scope;
 
@@ -26,6 +52,7 @@ NAN_MODULE_INIT(Statement::Init) {
     Nan::SetPrototypeMethod(t, "each", Each);
     Nan::SetPrototypeMethod(t, "reset", Reset);
     Nan::SetPrototypeMethod(t, "finalize", Finalize);
+    Nan::SetPrototypeMethod(t, "stats", Stats);
 
     Nan::Set(target, Nan::New("Statement").ToLocalChecked(),
         Nan::GetFunction(t).ToLocalChecked());
@@ -630,12 +657,10 @@ void Statement::Work_Each(uv_work_t* req) {
                 sqlite3_mutex_leave(mtx);
                 Row* row = new Row();
                 GetRow(row, stmt->_handle);
-                NODE_SQLITE3_MUTEX_LOCK(&async->mutex)
-                async->data.push_back(row);
+                async->data.push(row);
                 retrieved++;
-                NODE_SQLITE3_MUTEX_UNLOCK(&async->mutex)
 
-                uv_async_send(&async->watcher);
+                async->send();
             }
             else {
                 if (stmt->status != SQLITE_DONE) {
@@ -647,8 +672,8 @@ void Statement::Work_Each(uv_work_t* req) {
         }
     }
 
-    async->completed = true;
-    uv_async_send(&async->watcher);
+    async->completed.store(true);
+    async->send();
 }
 
 void Statement::CloseCallback(uv_handle_t* handle) {
@@ -663,35 +688,28 @@ void Statement::AsyncEach(uv_async_t* handle, int status) {
 
     Async* async = static_cast<Async*>(handle->data);
 
-    while (true) {
-        // Get the contents out of the data cache for us to process in the JS callback.
-        Rows rows;
-        NODE_SQLITE3_MUTEX_LOCK(&async->mutex)
-        rows.swap(async->data);
-        NODE_SQLITE3_MUTEX_UNLOCK(&async->mutex)
-
-        if (rows.empty()) {
-            break;
-        }
-
-        Local<Function> cb = Nan::New(async->item_cb);
-        if (!cb.IsEmpty() && cb->IsFunction()) {
-            Local<Value> argv[2];
-            argv[0] = Nan::Null();
-
-            Rows::const_iterator it = rows.begin();
-            Rows::const_iterator end = rows.end();
-            for (int i = 0; it < end; ++it, i++) {
-                argv[1] = RowToJS(*it);
-                async->retrieved++;
-                TRY_CATCH_CALL(async->stmt->handle(), cb, 2, argv);
-                delete *it;
-            }
+    // Cleared before draining, so rows added from here on trigger another
+    // wakeup instead of being missed. Completion is checked up front: once it
+    // is set, every row is already in the queue.
+    async->signalled.store(false);
+    bool completed = async->completed.load();
+
+    Local<Function> item_cb = Nan::New(async->item_cb);
+    bool call = !item_cb.IsEmpty() && item_cb->IsFunction();
+
+    Row* row;
+    while (async->data.pop(row)) {
+        if (call) {
+            Nan::HandleScope scope;
+            Local<Value> argv[] = { Nan::Null(), RowToJS(row) };
+            async->retrieved++;
+            TRY_CATCH_CALL(async->stmt->handle(), item_cb, 2, argv);
         }
+        delete row;
     }
 
     Local<Function> cb = Nan::New(async->completed_cb);
-    if (async->completed) {
+    if (completed) {
         if (!cb.IsEmpty() &&
                 cb->IsFunction()) {
             Local<Value> argv[] = {
@@ -775,10 +793,22 @@ Local<Object> Statement::RowToJS(Row* row) {
                 value = Nan::New<Number>(((Values::Float*)field)->value);
             } break;
             case SQLITE_TEXT: {
-                value = Nan::New<String>(((Values::Text*)field)->value.c_str(), ((Values::Text*)field)->value.size()).ToLocalChecked();
+                Values::Text* text = (Values::Text*)field;
+                if (text->external != NULL) {
+                    // V8 takes ownership of the resource and frees it on GC.
+                    ExternalText* resource = new ExternalText(
+                        Isolate::GetCurrent(), text->Release(), text->length);
+                    value = String::NewExternalOneByte(Isolate::GetCurrent(),
+                        resource).ToLocalChecked();
+                }
+                else {
+                    value = Nan::New<String>(text->value.c_str(), text->value.size()).ToLocalChecked();
+                }
             } break;
             case SQLITE_BLOB: {
-                value = Nan::CopyBuffer(((Values::Blob*)field)->value, ((Values::Blob*)field)->length).ToLocalChecked();
+                // The Buffer takes ownership of the storage; no copy is made.
+                Values::Blob* blob = (Values::Blob*)field;
+                value = Nan::NewBuffer(blob->Release(), blob->length).ToLocalChecked();
             } break;
             case SQLITE_NULL: {
                 value = Nan::Null();
@@ -809,7 +839,10 @@ void Statement::GetRow(Row* row, sqlite3_stmt* stmt) {
             case SQLITE_TEXT: {
                 const char* text = (const char*)sqlite3_column_text(stmt, i);
                 int length = sqlite3_column_bytes(stmt, i);
-                row->push_back(new Values::Text(name, length, text));
+                // 7-bit clean UTF-8 is a one-byte string without transcoding.
+                bool external = length >= EXTERNAL_TEXT_THRESHOLD &&
+                    node::simd::IsAscii(text, length);
+                row->push_back(new Values::Text(name, length, text, external));
             } break;
             case SQLITE_BLOB: {
                 const void* blob = sqlite3_column_blob(stmt, i);
@@ -825,6 +858,35 @@ void Statement::GetRow(Row* row, sqlite3_stmt* stmt) {
     }
 }
 
+NAN_METHOD(Statement::Stats) {
+    Statement* stmt = Nan::ObjectWrap::Unwrap<Statement>(info.This());
+
+    bool reset = info.Length() > 0 && Nan::To<bool>(info[0]).FromJust();
+
+    static const struct {
+        int op;
+        const char* name;
+    } counters[] = {
+        { SQLITE_STMTSTATUS_FULLSCAN_STEP, "fullscanSteps" },
+        { SQLITE_STMTSTATUS_SORT, "sorts" },
+        { SQLITE_STMTSTATUS_AUTOINDEX, "autoindexes" },
+        { SQLITE_STMTSTATUS_VM_STEP, "vmSteps" },
+    };
+
+    // Counters stay at zero until the statement is prepared and after it has
+    // been finalized.
+    bool active = stmt->prepared && !stmt->finalized;
+    Local<Object> result = Nan::New<Object>();
+    for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++) {
+        int value = active ?
+            sqlite3_stmt_status(stmt->_handle, counters[i].op, reset) : 0;
+        Nan::Set(result, Nan::New(counters[i].name).ToLocalChecked(),
+            Nan::New(value));
+    }
+
+    info.GetReturnValue().Set(result);
+}
+
 NAN_METHOD(Statement::Finalize) {
     Statement* stmt = Nan::ObjectWrap::Unwrap<Statement>(info.This());
     OPTIONAL_ARGUMENT_FUNCTION(0, callback);
@@ -4,6 +4,7 @@
 
 #include "database.h"
 #include "threading.h"
+#include "ring.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -14,6 +15,15 @@
 #include <sqlite3.h>
 #include <nan.h>
 
+// TEXT results at least this long that are pure ASCII are exposed to
+// JavaScript as external one-byte strings instead of being copied into the
+// V8 heap.
+#define EXTERNAL_TEXT_THRESHOLD (64 * 1024)
+
+// Rows each() hands to the loop thread without locking before it starts
+// spilling into the overflow list.
+#define EACH_QUEUE_CAPACITY 256
+
 using namespace v8;
 using namespace node;
 
@@ -44,20 +54,50 @@ namespace Values {
     };
 
     struct Text : Field {
-        template <class T> inline Text(T _name, size_t len, const char* val) :
-            Field(_name, SQLITE_TEXT), value(val, len) {}
+        template <class T> inline Text(T _name, size_t len, const char* val,
+                bool external_ = false) :
+                Field(_name, SQLITE_TEXT), external(NULL), length(len) {
+            if (external_) {
+                // Kept outside of `value` so that RowToJS can hand the buffer
+                // to V8 as an external string.
+                external = (char*)malloc(len);
+                memcpy(external, val, len);
+            }
+            else {
+                value.assign(val, len);
+            }
+        }
+        inline ~Text() {
+            free(external);
+        }
+        // Transfers ownership of the external storage to the caller.
+        inline char* Release() {
+            char* released = external;
+            external = NULL;
+            return released;
+        }
         std::string value;
+        char* external;
+        size_t length;
     };
 
     struct Blob : Field {
         template <class T> inline Blob(T _name, size_t len, const void* val) :
                 Field(_name, SQLITE_BLOB), length(len) {
+            // Buffers created with Nan::NewBuffer release their storage with
+            // free(), so it can be handed over without copying.
             value = (char*)malloc(len);
             memcpy(value, val, len);
         }
         inline ~Blob() {
             free(value);
         }
+        // Transfers ownership of the storage to the caller.
+        inline char* Release() {
+            char* released = value;
+            value = NULL;
+            return released;
+        }
         int length;
         char* value;
     };
@@ -158,9 +198,11 @@ public:
     struct Async {
         uv_async_t watcher;
         Statement* stmt;
-        Rows data;
-        NODE_SQLITE3_MUTEX_t;
-        bool completed;
+        HandoffQueue<Row*> data;
+        // Set by the first send() after AsyncEach ran, so that a burst of rows
+        // costs a single uv_async_send.
+        std::atomic<bool> signalled;
+        std::atomic<bool> completed;
         int retrieved;
 
         // Store the callbacks here because we don't have
@@ -169,9 +211,9 @@ public:
         Nan::Persistent<Function> completed_cb;
 
         Async(Statement* st, uv_async_cb async_cb, uv_loop_t *loop_) :
-                stmt(st), completed(false), retrieved(0) {
+                stmt(st), data(EACH_QUEUE_CAPACITY), signalled(false),
+                completed(false), retrieved(0) {
             watcher.data = this;
-            NODE_SQLITE3_MUTEX_INIT
             stmt->Ref();
             uv_async_init(loop_, &watcher, async_cb);
         }
@@ -180,7 +222,12 @@ public:
             stmt->Unref();
             item_cb.Reset();
             completed_cb.Reset();
-            NODE_SQLITE3_MUTEX_DESTROY
+        }
+
+        void send() {
+            if (!signalled.exchange(true)) {
+                uv_async_send(&watcher);
+            }
         }
     };
 
@@ -206,6 +253,7 @@ public:
     WORK_DEFINITION(Reset);
 
     static NAN_METHOD(Finalize);
+    static NAN_METHOD(Stats);
 
 protected:
     static void Work_BeginPrepare(Database::Baton* baton);
@@ -35,4 +35,25 @@ describe('each', function() {
             done();
         });
     });
+
+    it('keeps rows in order with concurrent iterators', function(done) {
+        var total = 20000;
+        var iterators = 4;
+        var remaining = iterators;
+
+        db.parallelize(function() {
+            for (var i = 0; i < iterators; i++) (function() {
+                var last = 0;
+                db.each('SELECT rowid AS id FROM foo LIMIT 0, ?', total, function(err, row) {
+                    if (err) throw err;
+                    assert.ok(row.id > last, "Row " + row.id + " delivered after " + last);
+                    last = row.id;
+                }, function(err, num) {
+                    if (err) throw err;
+                    assert.equal(num, total);
+                    if (!--remaining) done();
+                });
+            })();
+        });
+    });
 });
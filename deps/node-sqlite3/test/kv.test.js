@@ -0,0 +1,100 @@
+var sqlite3 = require('..');
+var assert = require('assert');
+var helper = require('./support/helper');
+
+describe('KeyValueStore', function() {
+    var store;
+
+    before(function(done) {
+        helper.ensureExists('test/tmp');
+        helper.deleteFile('test/tmp/kv.db');
+        store = new sqlite3.KeyValueStore('test/tmp/kv.db', { cacheSize: 2 }, done);
+    });
+
+    it('should store strings and buffers', function(done) {
+        store.put('a', 'one');
+        store.put('b', new Buffer([ 1, 2, 3 ]));
+        store.put('c', '{"json": true}', function(err) {
+            if (err) throw err;
+            done();
+        });
+    });
+
+    it('should serve recent values from the cache', function() {
+        assert.equal(store.peek('c'), '{"json": true}');
+        assert.ok(Buffer.isBuffer(store.peek('b')));
+        // Evicted, cacheSize is 2.
+        assert.equal(store.peek('a'), undefined);
+    });
+
+    it('should read values that are not cached', function(done) {
+        store.get('a', function(err, value) {
+            if (err) throw err;
+            assert.equal(value, 'one');
+            assert.equal(store.peek('a'), 'one');
+            store.get('missing', function(err, value) {
+                if (err) throw err;
+                assert.equal(value, undefined);
+                // Known not to exist.
+                assert.strictEqual(store.peek('missing'), null);
+                done();
+            });
+        });
+    });
+
+    it('should see its own writes before they are flushed', function(done) {
+        store.put('a', 'two');
+        store.del('b');
+        assert.equal(store.peek('a'), 'two');
+        assert.strictEqual(store.peek('b'), null);
+        store.get('b', function(err, value) {
+            if (err) throw err;
+            assert.equal(value, undefined);
+            done();
+        });
+    });
+
+    it('should return key ranges in order', function(done) {
+        for (var i = 0; i < 10; i++) store.put('key:' + i, 'value ' + i);
+        store.range('key:3', 'key:7', function(err, rows) {
+            if (err) throw err;
+            assert.deepEqual(rows.map(function(row) { return row.key; }),
+                [ 'key:3', 'key:4', 'key:5', 'key:6' ]);
+            assert.equal(rows[0].value, 'value 3');
+            store.range('key:', 'key;', 2, function(err, rows) {
+                if (err) throw err;
+                assert.equal(rows.length, 2);
+                done();
+            });
+        });
+    });
+
+    it('should persist writes', function(done) {
+        store.close(function(err) {
+            if (err) throw err;
+            var db = new sqlite3.Database('test/tmp/kv.db');
+            db.all("SELECT key, value FROM kv WHERE key IN ('a', 'b', 'c') ORDER BY key", function(err, rows) {
+                if (err) throw err;
+                assert.deepEqual(rows, [
+                    { key: 'a', value: 'two' },
+                    { key: 'c', value: '{"json": true}' }
+                ]);
+                db.close(done);
+            });
+        });
+    });
+
+    it('should reject use after close', function(done) {
+        store.put('d', 'four', function(err) {
+            assert.ok(err);
+            assert.equal(err.code, 'SQLITE_MISUSE');
+            done();
+        });
+    });
+
+    it('should reject other value types', function() {
+        var other = new sqlite3.KeyValueStore(':memory:');
+        assert.throws(function() { other.put('x', 42); }, /string or Buffer/);
+        other.close();
+    });
+});
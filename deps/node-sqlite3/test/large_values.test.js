@@ -0,0 +1,65 @@
+var sqlite3 = require('..');
+var assert = require('assert');
+
+describe('large values', function() {
+    var db;
+    before(function(done) {
+        db = new sqlite3.Database(':memory:');
+        db.run("CREATE TABLE docs (id INT, body TEXT, data BLOB)", done);
+    });
+
+    // Larger than the threshold above which ASCII text is handed to V8 as an
+    // external string.
+    var ascii = new Array(20000).join('{"key": "value"}\n');
+    var unicode = new Array(20000).join('{"kéy": "v☃lue"}\n');
+    var blob = new Buffer(256 * 1024);
+    for (var i = 0; i < blob.length; i++) blob[i] = i % 251;
+
+    it('should insert large values', function(done) {
+        db.serialize(function() {
+            var stmt = db.prepare("INSERT INTO docs VALUES (?, ?, ?)");
+            stmt.run(1, ascii, blob);
+            stmt.run(2, unicode, new Buffer(0));
+            stmt.run(3, 'short', blob.slice(0, 10));
+            stmt.finalize(done);
+        });
+    });
+
+    it('should retrieve large ascii text and blobs', function(done) {
+        db.get("SELECT body, data FROM docs WHERE id = 1", function(err, row) {
+            if (err) throw err;
+            assert.equal(row.body.length, ascii.length);
+            assert.equal(row.body, ascii);
+            assert.ok(Buffer.isBuffer(row.data));
+            assert.equal(row.data.length, blob.length);
+            assert.ok(row.data.equals(blob));
+            done();
+        });
+    });
+
+    it('should retrieve large non-ascii text and empty blobs', function(done) {
+        db.get("SELECT body, data FROM docs WHERE id = 2", function(err, row) {
+            if (err) throw err;
+            assert.equal(row.body, unicode);
+            assert.ok(Buffer.isBuffer(row.data));
+            assert.equal(row.data.length, 0);
+            done();
+        });
+    });
+
+    it('should retrieve many rows', function(done) {
+        db.all("SELECT id, body, data FROM docs ORDER BY id", function(err, rows) {
+            if (err) throw err;
+            assert.equal(rows.length, 3);
+            assert.equal(rows[0].body, ascii);
+            assert.equal(rows[1].body, unicode);
+            assert.equal(rows[2].body, 'short');
+            assert.ok(rows[2].data.equals(blob.slice(0, 10)));
+            done();
+        });
+    });
+
+    after(function(done) {
+        db.close(done);
+    });
+});
@@ -0,0 +1,104 @@
+var sqlite3 = require('..');
+var assert = require('assert');
+var fs = require('fs');
+
+describe('openBlob', function() {
+    var db;
+    var elmo = fs.readFileSync(__dirname + '/support/elmo.png');
+
+    before(function(done) {
+        db = new sqlite3.Database(':memory:');
+        db.serialize(function() {
+            db.run("CREATE TABLE images (id INTEGER PRIMARY KEY, image BLOB)");
+            db.run("INSERT INTO images VALUES (1, zeroblob(?))", elmo.length);
+            db.run("INSERT INTO images VALUES (2, NULL)", done);
+        });
+    });
+
+    it('should write a blob through a stream', function(done) {
+        var stream = db.openBlob('images', 'image', 1, { writable: true });
+        var opened = false;
+        stream.on('open', function(length) {
+            assert.equal(length, elmo.length);
+            opened = true;
+        });
+        stream.on('close', function() {
+            assert.ok(opened);
+            done();
+        });
+        // Write in uneven pieces to exercise the offset bookkeeping.
+        for (var i = 0; i < elmo.length; i += 1000) {
+            stream.write(elmo.slice(i, i + 1000));
+        }
+        stream.end();
+    });
+
+    it('should match the written data', function(done) {
+        db.get("SELECT image FROM images WHERE id = 1", function(err, row) {
+            if (err) throw err;
+            assert.ok(row.image.equals(elmo));
+            done();
+        });
+    });
+
+    it('should read a blob through a stream', function(done) {
+        var chunks = [];
+        db.openBlob('images', 'image', 1, { chunkSize: 4096 })
+            .on('data', function(chunk) {
+                assert.ok(chunk.length <= 4096);
+                chunks.push(chunk);
+            })
+            .on('end', function() {
+                assert.ok(Buffer.concat(chunks).equals(elmo));
+            })
+            .on('close', done);
+    });
+
+    it('should close a paused read stream only after its end', function(done) {
+        var stream = db.openBlob('images', 'image', 1, { chunkSize: 4096 });
+        var chunks = [];
+        var ended = false;
+        stream.on('end', function() {
+            assert.ok(Buffer.concat(chunks).equals(elmo));
+            ended = true;
+        });
+        stream.on('close', function() {
+            assert.ok(ended);
+            done();
+        });
+        // Leaves the last chunks buffered for a while after the blob's end.
+        (function consume() {
+            var chunk;
+            while ((chunk = stream.read()) !== null) chunks.push(chunk);
+            if (!ended) setTimeout(consume, 20);
+        })();
+    });
+
+    it('should not write past the end of the blob', function(done) {
+        var stream = db.openBlob('images', 'image', 1, { writable: true, start: elmo.length - 1 });
+        stream.on('error', function(err) {
+            assert.equal(err.errno, sqlite3.ERROR);
+            done();
+        });
+        stream.end(new Buffer(2));
+    });
+
+    it('should fail to open a row without a blob', function(done) {
+        db.openBlob('images', 'image', 2, function(err) {
+            assert.ok(err);
+            assert.equal(err.code, 'SQLITE_ERROR');
+            done();
+        });
+    });
+
+    it('should fail to open a missing row', function(done) {
+        db.openBlob('images', 'image', 3).on('error', function(err) {
+            assert.equal(err.code, 'SQLITE_ERROR');
+            done();
+        });
+    });
+
+    after(function(done) {
+        db.close(done);
+    });
+});
@@ -0,0 +1,98 @@
+var sqlite3 = require('..');
+var assert = require('assert');
+var helper = require('./support/helper');
+
+describe('open options', function() {
+    before(function() {
+        helper.ensureExists('test/tmp');
+        helper.deleteFile('test/tmp/tuning.db');
+        helper.deleteFile('test/tmp/tuning.db-wal');
+        helper.deleteFile('test/tmp/tuning.db-shm');
+    });
+
+    var db;
+    it('should open the database with options', function(done) {
+        db = new sqlite3.Database('test/tmp/tuning.db', {
+            pageSize: 8192,
+            cacheSize: -4096,
+            mmapSize: 16 * 1024 * 1024,
+            journalMode: 'wal',
+            synchronous: 'normal',
+            walAutocheckpoint: 0,
+            busyTimeout: 5000
+        }, done);
+    });
+
+    it('should have applied the pragmas', function(done) {
+        db.serialize(function() {
+            db.get("PRAGMA page_size", function(err, row) {
+                if (err) throw err;
+                assert.equal(row.page_size, 8192);
+            });
+            db.get("PRAGMA cache_size", function(err, row) {
+                if (err) throw err;
+                assert.equal(row.cache_size, -4096);
+            });
+            db.get("PRAGMA journal_mode", function(err, row) {
+                if (err) throw err;
+                assert.equal(row.journal_mode, 'wal');
+            });
+            db.get("PRAGMA synchronous", function(err, row) {
+                if (err) throw err;
+                assert.equal(row.synchronous, 1);
+                done();
+            });
+        });
+    });
+
+    it('should checkpoint the WAL', function(done) {
+        db.serialize(function() {
+            db.run("CREATE TABLE foo (id INT, txt TEXT)");
+            db.run("INSERT INTO foo VALUES (1, 'one'), (2, 'two'), (3, 'three')");
+            db.checkpoint(sqlite3.CHECKPOINT_TRUNCATE, function(err, result) {
+                if (err) throw err;
+                assert.equal(result.log, 0);
+                assert.equal(result.checkpointed, 0);
+                done();
+            });
+        });
+    });
+
+    it('should report database counters', function(done) {
+        db.all("SELECT * FROM foo", function(err) {
+            if (err) throw err;
+            var stats = db.stats();
+            assert.ok(stats.cacheUsed > 0);
+            assert.ok(stats.schemaUsed > 0);
+            assert.equal(typeof stats.cacheHit, 'number');
+            assert.equal(typeof stats.cacheMiss, 'number');
+            done();
+        });
+    });
+
+    it('should report statement counters', function(done) {
+        var stmt = db.prepare("SELECT * FROM foo ORDER BY txt");
+        stmt.all(function(err, rows) {
+            if (err) throw err;
+            var stats = stmt.stats(true);
+            assert.equal(stats.sorts, 1);
+            assert.ok(stats.fullscanSteps > 0);
+            assert.ok(stats.vmSteps > 0);
+            assert.equal(stmt.stats().sorts, 0);
+            stmt.finalize(done);
+        });
+    });
+
+    it('should reject invalid options', function() {
+        assert.throws(function() {
+            new sqlite3.Database(':memory:', { journalMode: 'wal; DROP TABLE foo' });
+        }, /journalMode is not a valid value/);
+        assert.throws(function() {
+            new sqlite3.Database(':memory:', { cacheSize: 'big' });
+        }, /cacheSize must be an integer/);
+    });
+
+    after(function(done) {
+        db.close(done);
+    });
+});